@@ -0,0 +1,332 @@
+/* Minimal benchmark harness in the style of Google Benchmark.
+ *
+ * Benchmarks are functions taking a `state`, registered with
+ * `register_benchmark` for one or more argument lists.  The harness
+ * increases the number of iterations until a run takes at least the
+ * minimum time and reports the time per iteration.  It accepts the
+ * flags --benchmark_filter=<regex>, --benchmark_min_time=<seconds>,
+ * --benchmark_repetitions=<n>, --benchmark_list_tests, and
+ * --benchmark_out=<file> for JSON output in Google Benchmark's format,
+ * which existing tools can compare across commits. */
+
+#pragma once
+
+#include <json/json.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace copycat::benchmarks
+{
+
+class state
+{
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit state( uint64_t max_iterations, std::vector<int64_t> const& args )
+    : _max_iterations( max_iterations )
+    , _args( args )
+  {
+  }
+
+  /*! \brief Returns true while iterations remain; the timer runs between the first and the last call */
+  bool keep_running()
+  {
+    if ( _iterations == 0u && !_running )
+      resume_timing();
+
+    if ( _iterations == _max_iterations )
+    {
+      pause_timing();
+      return false;
+    }
+
+    ++_iterations;
+    return true;
+  }
+
+  /*! \brief Stops the timer, e.g., to exclude setup from the measurement */
+  void pause_timing()
+  {
+    if ( !_running )
+      return;
+    _real_time += clock::now() - _real_begin;
+    _cpu_time += std::clock() - _cpu_begin;
+    _running = false;
+  }
+
+  /*! \brief Restarts the timer */
+  void resume_timing()
+  {
+    if ( _running )
+      return;
+    _real_begin = clock::now();
+    _cpu_begin = std::clock();
+    _running = true;
+  }
+
+  /*! \brief Returns the i-th argument */
+  int64_t range( uint32_t i = 0u ) const
+  {
+    return _args.at( i );
+  }
+
+  uint64_t iterations() const
+  {
+    return _iterations;
+  }
+
+  /*! \brief Number of items processed in all iterations (reported per second) */
+  void set_items_processed( uint64_t items )
+  {
+    _items = items;
+  }
+
+  /*! \brief Number of bytes processed in all iterations (reported per second) */
+  void set_bytes_processed( uint64_t bytes )
+  {
+    _bytes = bytes;
+  }
+
+  /*! \brief Reports a user-defined value */
+  void set_counter( std::string const& name, double value )
+  {
+    _counters[name] = value;
+  }
+
+private:
+  friend class runner;
+
+  uint64_t _max_iterations;
+  std::vector<int64_t> _args;
+
+  uint64_t _iterations = 0u;
+  bool _running = false;
+  clock::time_point _real_begin;
+  clock::duration _real_time{0};
+  std::clock_t _cpu_begin = 0;
+  std::clock_t _cpu_time = 0;
+
+  uint64_t _items = 0u;
+  uint64_t _bytes = 0u;
+  std::map<std::string, double> _counters;
+}; /* state */
+
+struct benchmark
+{
+  std::string name;
+  std::function<void( state& )> fn;
+  std::vector<int64_t> args;
+}; /* benchmark */
+
+inline std::vector<benchmark>& registry()
+{
+  static std::vector<benchmark> benchmarks;
+  return benchmarks;
+}
+
+/*! \brief Registers a benchmark once for each argument list */
+inline bool register_benchmark( std::string const& name, std::function<void( state& )> fn,
+                                std::vector<std::vector<int64_t>> const& args = { {} } )
+{
+  for ( auto const& a : args )
+  {
+    auto full_name = name;
+    for ( auto const& v : a )
+      full_name += fmt::format( "/{}", v );
+    registry().emplace_back( benchmark{full_name, fn, a} );
+  }
+  return true;
+}
+
+class runner
+{
+public:
+  struct result
+  {
+    uint64_t iterations;
+    double real_time; /* ns per iteration */
+    double cpu_time;  /* ns per iteration */
+    double items_per_second;
+    double bytes_per_second;
+    std::map<std::string, double> counters;
+  };
+
+  explicit runner( double min_time )
+    : _min_time( min_time )
+  {
+  }
+
+  /* runs the benchmark with increasing iteration counts until it takes at least the minimum time */
+  result run( benchmark const& b ) const
+  {
+    /* benchmarked code may print; keep the report readable */
+    null_buffer null;
+    auto const old_buffer = std::cout.rdbuf( &null );
+
+    uint64_t iterations = 1u;
+    while ( true )
+    {
+      state s( iterations, b.args );
+      b.fn( s );
+      s.pause_timing();
+
+      auto const seconds = std::chrono::duration<double>( s._real_time ).count();
+      if ( seconds >= _min_time || iterations >= 1000000000u )
+      {
+        std::cout.rdbuf( old_buffer );
+
+        result r;
+        r.iterations = s._iterations;
+        r.real_time = seconds * 1e9 / r.iterations;
+        r.cpu_time = double( s._cpu_time ) / CLOCKS_PER_SEC * 1e9 / r.iterations;
+        r.items_per_second = s._items / std::max( seconds, 1e-12 );
+        r.bytes_per_second = s._bytes / std::max( seconds, 1e-12 );
+        r.counters = s._counters;
+        return r;
+      }
+
+      /* predict the number of iterations, at most ten times more than before */
+      auto const multiplier = seconds / _min_time > 0.1 ? 1.4 * _min_time / std::max( seconds, 1e-9 ) : 10.0;
+      iterations = std::max<uint64_t>( iterations + 1u, std::min( 10.0, multiplier ) * iterations );
+    }
+  }
+
+private:
+  struct null_buffer : public std::streambuf
+  {
+    int overflow( int c ) override
+    {
+      return c;
+    }
+  };
+
+  double _min_time;
+}; /* runner */
+
+/*! \brief Runs the registered benchmarks according to the command line */
+inline int run_benchmarks( int argc, char* argv[] )
+{
+  std::string filter = ".*";
+  std::string output;
+  double min_time = 0.5;
+  uint32_t repetitions = 1u;
+  bool list = false;
+
+  for ( auto i = 1; i < argc; ++i )
+  {
+    std::string const arg = argv[i];
+    auto const value = [&]( std::string const& flag ){ return arg.substr( flag.size() ); };
+    if ( arg.rfind( "--benchmark_filter=", 0u ) == 0u )
+      filter = value( "--benchmark_filter=" );
+    else if ( arg.rfind( "--benchmark_min_time=", 0u ) == 0u )
+      min_time = std::stod( value( "--benchmark_min_time=" ) );
+    else if ( arg.rfind( "--benchmark_repetitions=", 0u ) == 0u )
+      repetitions = std::stoul( value( "--benchmark_repetitions=" ) );
+    else if ( arg.rfind( "--benchmark_out=", 0u ) == 0u )
+      output = value( "--benchmark_out=" );
+    else if ( arg == "--benchmark_list_tests" )
+      list = true;
+    else
+    {
+      std::cerr << fmt::format( "[e] unknown argument `{}`\n", arg );
+      return -1;
+    }
+  }
+
+  std::regex const re( filter );
+  std::vector<benchmark const*> selected;
+  for ( auto const& b : registry() )
+    if ( std::regex_search( b.name, re ) )
+      selected.emplace_back( &b );
+
+  if ( list )
+  {
+    for ( auto const& b : selected )
+      fmt::print( "{}\n", b->name );
+    return 0;
+  }
+
+  auto const now = std::time( nullptr );
+  char date[32];
+  std::strftime( date, sizeof( date ), "%FT%T%z", std::localtime( &now ) );
+
+  auto json = nlohmann::json( {} );
+  json["context"]["date"] = date;
+  json["context"]["executable"] = argv[0];
+  json["context"]["num_cpus"] = std::thread::hardware_concurrency();
+#ifdef NDEBUG
+  json["context"]["library_build_type"] = "release";
+#else
+  json["context"]["library_build_type"] = "debug";
+#endif
+  json["benchmarks"] = nlohmann::json::array();
+
+#ifndef NDEBUG
+  fmt::print( "[w] benchmarks were built with assertions, timings may be affected\n" );
+#endif
+
+  fmt::print( "{:<48} {:>14} {:>14} {:>12} {:>14}\n", "Benchmark", "Time", "CPU", "Iterations", "Throughput" );
+  fmt::print( "{}\n", std::string( 106u, '-' ) );
+
+  runner r( min_time );
+  for ( auto const& b : selected )
+  {
+    for ( auto k = 0u; k < repetitions; ++k )
+    {
+      auto const res = r.run( *b );
+
+      std::string throughput;
+      if ( res.bytes_per_second > 0 )
+        throughput = fmt::format( "{:.1f} MiB/s", res.bytes_per_second / ( 1u << 20u ) );
+      else if ( res.items_per_second > 0 )
+        throughput = fmt::format( "{:.3g} items/s", res.items_per_second );
+      fmt::print( "{:<48} {:>11.0f} ns {:>11.0f} ns {:>12} {:>14}\n", b->name, res.real_time, res.cpu_time, res.iterations, throughput );
+      std::fflush( stdout );
+
+      auto entry = nlohmann::json( {} );
+      entry["name"] = b->name;
+      entry["run_name"] = b->name;
+      entry["run_type"] = "iteration";
+      entry["repetition_index"] = k;
+      entry["iterations"] = res.iterations;
+      entry["real_time"] = res.real_time;
+      entry["cpu_time"] = res.cpu_time;
+      entry["time_unit"] = "ns";
+      if ( res.items_per_second > 0 )
+        entry["items_per_second"] = res.items_per_second;
+      if ( res.bytes_per_second > 0 )
+        entry["bytes_per_second"] = res.bytes_per_second;
+      for ( auto const& c : res.counters )
+        entry[c.first] = c.second;
+      json["benchmarks"].emplace_back( entry );
+    }
+  }
+
+  if ( !output.empty() )
+  {
+    std::ofstream ofs( output );
+    if ( !ofs.good() )
+    {
+      std::cerr << fmt::format( "[e] could not open output file `{}`\n", output );
+      return -1;
+    }
+    ofs << json.dump( 2 ) << std::endl;
+  }
+
+  return 0;
+}
+
+} /* namespace copycat::benchmarks */
@@ -0,0 +1,332 @@
+#include "benchmark.hpp"
+#include "generators.hpp"
+#include <bill/sat/solver.hpp>
+#include <copycat/algorithms/exact_ltl_pdag_encoder.hpp>
+#include <copycat/algorithms/ltl_evaluator.hpp>
+#include <copycat/algorithms/ltl_learner.hpp>
+#include <copycat/algorithms/ltl_pdag_learner.hpp>
+#include <copycat/algorithms/sequential_simulation.hpp>
+#include <copycat/dag.hpp>
+#include <copycat/io/ltl.hpp>
+#include <copycat/io/ltl_formula_reader.hpp>
+#include <copycat/io/traces.hpp>
+#include <copycat/ltl.hpp>
+#include <copycat/trace.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <random>
+#include <sstream>
+
+using namespace copycat;
+using namespace copycat::benchmarks;
+
+using solver_t = bill::solver<bill::solvers::glucose_41>;
+
+/* formula hash-consing: random operators over a pool of existing formulas, such that many nodes already exist */
+void ltl_formula_store_create( state& s )
+{
+  auto const num_nodes = s.range( 0 );
+  uint64_t num_created = 0u;
+  while ( s.keep_running() )
+  {
+    std::default_random_engine engine( 0 );
+    std::uniform_int_distribution<uint32_t> op_dist( 0u, 7u );
+
+    ltl_formula_store ltl;
+    std::vector<ltl_formula_store::ltl_formula> fs;
+    for ( auto i = 0u; i < 16u; ++i )
+      fs.emplace_back( ltl.create_variable() );
+
+    for ( auto i = 0; i < num_nodes; ++i )
+    {
+      /* prefer recent formulas, such that the formulas grow */
+      auto const pick = [&](){ return fs[fs.size() - 1u - std::uniform_int_distribution<std::size_t>( 0u, std::min<std::size_t>( fs.size() - 1u, 64u ) )( engine )]; };
+      auto const a = pick();
+      auto const b = pick();
+      switch ( op_dist( engine ) )
+      {
+      case 0u: fs.emplace_back( !a ); break;
+      case 1u: fs.emplace_back( ltl.create_and( a, b ) ); break;
+      case 2u: fs.emplace_back( ltl.create_or( a, b ) ); break;
+      case 3u: fs.emplace_back( ltl.create_next( a ) ); break;
+      case 4u: fs.emplace_back( ltl.create_until( a, b ) ); break;
+      case 5u: fs.emplace_back( ltl.create_releases( a, b ) ); break;
+      case 6u: fs.emplace_back( ltl.create_eventually( a ) ); break;
+      default: fs.emplace_back( ltl.create_globally( a ) ); break;
+      }
+    }
+    num_created = ltl.num_nodes();
+  }
+  s.set_items_processed( s.iterations() * num_nodes );
+  s.set_counter( "#nodes", num_created );
+}
+static bool const bm_ltl_formula_store_create = register_benchmark( "ltl_formula_store/create", ltl_formula_store_create, { { 10000 }, { 100000 } } );
+
+/* random formulas over the operators of the finite-trace evaluator and random finite traces */
+struct evaluation_instance
+{
+  explicit evaluation_instance( uint32_t length )
+  {
+    std::default_random_engine engine( 0 );
+
+    std::vector<ltl_formula_store::ltl_formula> variables;
+    for ( auto i = 0u; i < 8u; ++i )
+      variables.emplace_back( ltl.create_variable() );
+    for ( auto i = 0u; i < 100u; ++i )
+      fs.emplace_back( random_formula( ltl, engine, 3u, variables ) );
+    for ( auto i = 0u; i < 16u; ++i )
+      traces.emplace_back( random_trace( engine, length, 8u ) );
+  }
+
+  ltl_formula_store ltl;
+  std::vector<ltl_formula_store::ltl_formula> fs;
+  std::vector<trace> traces;
+}; /* evaluation_instance */
+
+void ltl_finite_trace_evaluator_evaluate( state& s )
+{
+  evaluation_instance inst( s.range( 0 ) );
+  ltl_finite_trace_evaluator eval( inst.ltl );
+
+  uint64_t num_true = 0u;
+  while ( s.keep_running() )
+  {
+    for ( auto const& t : inst.traces )
+      for ( auto const& f : inst.fs )
+        num_true += eval.evaluate_formula( f, t, 0u ) == bool3( true );
+  }
+  s.set_items_processed( s.iterations() * inst.fs.size() * inst.traces.size() );
+  s.set_counter( "#true", num_true / s.iterations() );
+}
+static bool const bm_ltl_finite_trace_evaluator = register_benchmark( "ltl_finite_trace_evaluator/evaluate", ltl_finite_trace_evaluator_evaluate, { { 8 }, { 16 } } );
+
+void ltl_rv_evaluator_evaluate( state& s )
+{
+  evaluation_instance inst( s.range( 0 ) );
+
+  uint64_t num_true = 0u;
+  while ( s.keep_running() )
+  {
+    for ( auto const& t : inst.traces )
+    {
+      ltl_rv_evaluator eval( inst.ltl );
+      for ( auto const& f : inst.fs )
+        num_true += eval.evaluate_formula( f, t, 0u ) == bool5( true );
+    }
+  }
+  s.set_items_processed( s.iterations() * inst.fs.size() * inst.traces.size() );
+  s.set_counter( "#true", num_true / s.iterations() );
+}
+static bool const bm_ltl_rv_evaluator = register_benchmark( "ltl_rv_evaluator/evaluate", ltl_rv_evaluator_evaluate, { { 8 }, { 16 }, { 1024 } } );
+
+/* counts traces without materializing them */
+class counting_trace_reader : public trace_reader
+{
+public:
+  explicit counting_trace_reader( uint64_t& num_traces )
+    : num_traces( num_traces )
+  {
+  }
+
+  void on_good_trace( std::vector<std::vector<int>> const&, std::vector<std::vector<int>> const& ) const override
+  {
+    ++num_traces;
+  }
+
+  void on_bad_trace( std::vector<std::vector<int>> const&, std::vector<std::vector<int>> const& ) const override
+  {
+    ++num_traces;
+  }
+
+private:
+  uint64_t& num_traces;
+}; /* counting_trace_reader */
+
+/* trace parsing from an in-memory corpus of the given size in KiB */
+void read_traces_buffer( state& s )
+{
+  auto const corpus = random_corpus( s.range( 0 ) << 10u );
+  uint64_t num_traces = 0u;
+  while ( s.keep_running() )
+    read_traces_from_buffer( corpus, counting_trace_reader( num_traces ) );
+  s.set_bytes_processed( s.iterations() * corpus.size() );
+  s.set_counter( "#traces", num_traces / s.iterations() );
+}
+static bool const bm_read_traces = register_benchmark( "read_traces/buffer", read_traces_buffer, { { 1024 }, { 16384 } } );
+
+/* LTL parsing with the single-pass reader */
+void read_ltl_formulas_buffer( state& s )
+{
+  auto const text = random_formulas( s.range( 0 ) );
+  while ( s.keep_running() )
+  {
+    ltl_formula_store ltl;
+    std::map<std::string, ltl_formula_store::ltl_formula> names;
+    read_ltl_formulas( std::string_view( text ), ltl, names );
+  }
+  s.set_bytes_processed( s.iterations() * text.size() );
+  s.set_items_processed( s.iterations() * s.range( 0 ) );
+}
+static bool const bm_read_ltl_formulas = register_benchmark( "read_ltl_formulas/buffer", read_ltl_formulas_buffer, { { 10000 }, { 100000 } } );
+
+/* LTL parsing with the generic reader */
+void read_ltl_stream( state& s )
+{
+  auto const text = random_formulas( s.range( 0 ) );
+  while ( s.keep_running() )
+  {
+    ltl_formula_store ltl;
+    std::map<std::string, ltl_formula_store::ltl_formula> names;
+    std::istringstream in( text );
+    read_ltl( in, ltl_formula_reader( ltl, names ) );
+  }
+  s.set_bytes_processed( s.iterations() * text.size() );
+  s.set_items_processed( s.iterations() * s.range( 0 ) );
+}
+static bool const bm_read_ltl = register_benchmark( "read_ltl/stream", read_ltl_stream, { { 1000 }, { 10000 } } );
+
+/* clause generation of the SAT-based encoders for random examples */
+auto const examples = random_examples( 4u, 4u, 8u, 3u );
+
+void ltl_encoder_encode( state& s )
+{
+  ltl_encoder_parameter ps;
+  ps.num_propositions = 3u;
+  ps.num_nodes = s.range( 0 );
+  ps.ops = { operator_opcode::not_, operator_opcode::and_, operator_opcode::or_, operator_opcode::next_,
+             operator_opcode::until_, operator_opcode::eventually_, operator_opcode::globally_ };
+  ps.traces = examples;
+
+  uint64_t num_clauses = 0u;
+  while ( s.keep_running() )
+  {
+    solver_t solver;
+    ltl_encoder enc( solver );
+    enc.encode( ps );
+    num_clauses = solver.num_clauses();
+  }
+  s.set_items_processed( s.iterations() * num_clauses );
+  s.set_counter( "#clauses", num_clauses );
+}
+static bool const bm_ltl_encoder = register_benchmark( "ltl_encoder/encode", ltl_encoder_encode, { { 3 }, { 6 } } );
+
+void ltl_pdag_encoder_encode( state& s )
+{
+  /* this encoder supports unary operators only */
+  auto const pdags = percy::pd_generate_max( s.range( 0 ) );
+
+  ltl_pdag_encoder_parameter ps;
+  ps.num_propositions = 3u;
+  ps.ops = { operator_opcode::not_, operator_opcode::next_ };
+  ps.traces = examples;
+
+  uint64_t num_clauses = 0u;
+  while ( s.keep_running() )
+  {
+    num_clauses = 0u;
+    for ( auto const& pd : pdags )
+    {
+      ps.num_nodes = pd.nr_pi_fanins() + pd.nr_vertices();
+      ps.pdag = pd;
+
+      solver_t solver;
+      ltl_pdag_encoder enc( solver );
+      enc.encode( ps );
+      num_clauses += solver.num_clauses();
+    }
+  }
+  s.set_items_processed( s.iterations() * num_clauses );
+  s.set_counter( "#pdags", pdags.size() );
+  s.set_counter( "#clauses", num_clauses );
+}
+static bool const bm_ltl_pdag_encoder = register_benchmark( "ltl_pdag_encoder/encode", ltl_pdag_encoder_encode, { { 1 }, { 2 } } );
+
+void exact_ltl_pdag_encoder_encode( state& s )
+{
+  auto const pdags = copycat::pd_generate_filtered( s.range( 0 ), 3u );
+
+  exact_ltl_pdag_encoder_parameter ps;
+  ps.verbose = false;
+  ps.num_propositions = 3u;
+  ps.ops = { operator_opcode::not_, operator_opcode::and_, operator_opcode::or_, operator_opcode::next_,
+             operator_opcode::until_, operator_opcode::eventually_, operator_opcode::globally_ };
+  ps.traces = examples;
+
+  uint64_t num_clauses = 0u;
+  while ( s.keep_running() )
+  {
+    num_clauses = 0u;
+    for ( auto const& pd : pdags )
+    {
+      ps.pd = pd;
+
+      solver_t solver;
+      exact_ltl_pdag_encoder enc( solver );
+      enc.encode( ps );
+      num_clauses += solver.num_clauses();
+    }
+  }
+  s.set_items_processed( s.iterations() * num_clauses );
+  s.set_counter( "#pdags", pdags.size() );
+  s.set_counter( "#clauses", num_clauses );
+}
+static bool const bm_exact_ltl_pdag_encoder = register_benchmark( "exact_ltl_pdag_encoder/encode", exact_ltl_pdag_encoder_encode, { { 3 }, { 4 } } );
+
+void binary_dag_enumerate( state& s )
+{
+  uint64_t num_dags = 0u;
+  while ( s.keep_running() )
+  {
+    num_dags = 0u;
+    foreach_binary_dag( binary_dag( 3 ), s.range( 0 ), [&]( auto const& ){ ++num_dags; } );
+  }
+  s.set_items_processed( s.iterations() * num_dags );
+  s.set_counter( "#dags", num_dags );
+}
+static bool const bm_binary_dag_enumerate = register_benchmark( "binary_dag/enumerate", binary_dag_enumerate, { { 4 }, { 5 } } );
+
+void partial_dag_generate( state& s )
+{
+  uint64_t num_dags = 0u;
+  while ( s.keep_running() )
+    num_dags = copycat::pd_generate_filtered( s.range( 0 ), 3u ).size();
+  s.set_items_processed( s.iterations() * num_dags );
+  s.set_counter( "#pdags", num_dags );
+}
+static bool const bm_partial_dag_generate = register_benchmark( "partial_dag/generate", partial_dag_generate, { { 4 }, { 6 } } );
+
+/* counts the ones on the outputs */
+struct output_counter
+{
+  void on_time_frame_start( uint32_t ) {}
+  void on_time_frame_end( uint32_t ) {}
+  void on_pi( uint32_t, bool ) {}
+  void on_ro( uint32_t, bool ) {}
+  void on_ri( uint32_t, bool ) {}
+  void on_po( uint32_t, bool value ) { num_ones += value; }
+
+  uint64_t num_ones = 0u;
+}; /* output_counter */
+
+/* sequential AIG simulation with random stimuli over 64 time frames */
+void sequential_simulation_aig( state& s )
+{
+  auto aig = random_sequential_aig( 32u, 32u, s.range( 0 ) );
+
+  std::default_random_engine engine( 0 );
+  std::bernoulli_distribution dist( 0.5 );
+  auto coin = [&](){ return dist( engine ); };
+
+  output_counter counter;
+  while ( s.keep_running() )
+  {
+    random_simulator<mockturtle::aig_network, decltype( coin )> sim( aig, coin );
+    simulate( aig, sim, 64u, counter );
+  }
+  s.set_items_processed( s.iterations() * aig.num_gates() * 64u );
+}
+static bool const bm_sequential_simulation = register_benchmark( "sequential_simulation/aig", sequential_simulation_aig, { { 1000 }, { 10000 } } );
+
+int main( int argc, char* argv[] )
+{
+  return run_benchmarks( argc, argv );
+}
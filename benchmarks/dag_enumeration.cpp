@@ -0,0 +1,49 @@
+#include "generators.hpp"
+#include <copycat/dag.hpp>
+#include <copycat/utils/stopwatch.hpp>
+#include <fmt/format.h>
+#include <cstdlib>
+#include <vector>
+
+using namespace copycat;
+using namespace copycat::benchmarks;
+
+int main( int argc, char* argv[] )
+{
+  int const num_inputs = 3;
+  int const num_vertices = argc >= 2 ? std::atoi( argv[1] ) : 6;
+  int const num_large = argc >= 3 ? std::atoi( argv[2] ) : 10000000;
+
+  {
+    uint64_t count = 0u;
+    stopwatch<>::duration time{0};
+    call_with_stopwatch( time, [&](){
+        foreach_binary_dag( binary_dag( num_inputs ), num_vertices, [&]( auto const& ){ ++count; } );
+      });
+    fmt::print( "[i] {:<20} {:8.2f} s  #dags = {} #vertices = {}\n",
+                "enumerate (copy)", to_seconds( time ), count, num_vertices );
+  }
+
+  {
+    std::vector<binary_dag> dags;
+    stopwatch<>::duration time{0};
+    call_with_stopwatch( time, [&](){
+        foreach_binary_dag( binary_dag( num_inputs ), num_vertices, [&]( auto const& d ){ dags.emplace_back( d ); } );
+      });
+    fmt::print( "[i] {:<20} {:8.2f} s  #dags = {} #vertices = {}\n",
+                "enumerate (collect)", to_seconds( time ), dags.size(), num_vertices );
+  }
+
+  {
+    binary_dag d( num_inputs );
+    stopwatch<>::duration time{0};
+    call_with_stopwatch( time, [&](){
+        for ( int i = 0; i < num_large; ++i )
+          d.add_vertex( i % ( num_inputs + i ), num_inputs + i - 1 );
+      });
+    fmt::print( "[i] {:<20} {:8.2f} s  #vertices = {} capacity = {}\n",
+                "add_vertex", to_seconds( time ), d.num_vertices(), d.capacity() );
+  }
+
+  return 0;
+}
@@ -0,0 +1,226 @@
+/* Synthetic inputs for the benchmarks.  All generators are
+ * deterministic for a given random engine, such that the measured
+ * inputs are the same across commits. */
+
+#pragma once
+
+#include <copycat/dag.hpp>
+#include <copycat/ltl.hpp>
+#include <copycat/trace.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <fmt/format.h>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace copycat::benchmarks
+{
+
+/* appends a random formula of at most the given depth */
+template<typename RandomEngine>
+void random_formula( std::string& s, RandomEngine& engine, uint32_t depth, uint32_t num_propositions )
+{
+  static std::vector<std::string> const unary_ops = { "!", "X", "F", "G" };
+  static std::vector<std::string> const binary_ops = { "->", "*", "+", "U", "R" };
+
+  std::uniform_int_distribution<uint32_t> choice( 0u, 2u );
+  auto const c = depth == 0u ? 0u : choice( engine );
+  if ( c == 0u )
+  {
+    s += fmt::format( "x{}", std::uniform_int_distribution<uint32_t>( 0u, num_propositions - 1u )( engine ) );
+  }
+  else if ( c == 1u )
+  {
+    s += unary_ops[std::uniform_int_distribution<uint32_t>( 0u, unary_ops.size() - 1u )( engine )];
+    s += '(';
+    random_formula( s, engine, depth - 1u, num_propositions );
+    s += ')';
+  }
+  else
+  {
+    s += '(';
+    random_formula( s, engine, depth - 1u, num_propositions );
+    s += ") ";
+    s += binary_ops[std::uniform_int_distribution<uint32_t>( 0u, binary_ops.size() - 1u )( engine )];
+    s += " (";
+    random_formula( s, engine, depth - 1u, num_propositions );
+    s += ')';
+  }
+}
+
+/* returns a random formula of at most the given depth over !, |, X, and U */
+template<typename RandomEngine>
+ltl_formula_store::ltl_formula random_formula( ltl_formula_store& ltl, RandomEngine& engine, uint32_t depth,
+                                               std::vector<ltl_formula_store::ltl_formula> const& variables )
+{
+  auto const c = depth == 0u ? 0u : std::uniform_int_distribution<uint32_t>( 0u, 4u )( engine );
+  switch ( c )
+  {
+  case 0u:
+    return variables[std::uniform_int_distribution<std::size_t>( 0u, variables.size() - 1u )( engine )];
+  case 1u:
+    return !random_formula( ltl, engine, depth - 1u, variables );
+  case 2u:
+    return ltl.create_next( random_formula( ltl, engine, depth - 1u, variables ) );
+  default:
+    {
+      auto const a = random_formula( ltl, engine, depth - 1u, variables );
+      auto const b = random_formula( ltl, engine, depth - 1u, variables );
+      return c == 3u ? ltl.create_or( a, b ) : ltl.create_until( a, b );
+    }
+  }
+}
+
+/* returns `num_formulas` random formulas, one per line */
+inline std::string random_formulas( uint64_t num_formulas, uint32_t depth = 5u, uint32_t num_propositions = 16u )
+{
+  std::default_random_engine engine( 0 );
+  std::string s;
+  for ( auto i = 0u; i < num_formulas; ++i )
+  {
+    random_formula( s, engine, depth, num_propositions );
+    s += '\n';
+  }
+  return s;
+}
+
+/* returns a random trace corpus of roughly `size` bytes (half good, half bad traces) */
+inline std::string random_corpus( uint64_t size, uint32_t num_propositions = 8u )
+{
+  std::default_random_engine engine( 0 );
+  std::uniform_int_distribution<uint32_t> length_dist( 5u, 40u );
+  std::bernoulli_distribution value_dist( 0.5 );
+
+  std::string corpus;
+  corpus.reserve( size + 1024u );
+
+  std::string line;
+  bool separator = false;
+  while ( corpus.size() < size )
+  {
+    if ( !separator && corpus.size() >= size / 2u )
+    {
+      corpus += "---\n";
+      separator = true;
+    }
+
+    line.clear();
+    auto const length = length_dist( engine );
+    for ( auto i = 0u; i < length; ++i )
+    {
+      for ( auto j = 0u; j < num_propositions; ++j )
+      {
+        line += value_dist( engine ) ? '1' : '0';
+        line += j + 1u < num_propositions ? ',' : ';';
+      }
+    }
+    line.back() = ':';
+    line += fmt::format( ":{}\n", length / 2u );
+    corpus += line;
+  }
+  return corpus;
+}
+
+/* writes a random trace corpus of roughly `size` bytes */
+inline void write_corpus( std::string const& filename, uint64_t size, uint32_t num_propositions = 8u )
+{
+  std::ofstream ofs( filename, std::ios::out | std::ios::binary );
+  ofs << random_corpus( size, num_propositions );
+}
+
+/* returns a random trace; the time steps from `prefix_length` on form the loop (finite if `prefix_length` >= `length`) */
+template<typename RandomEngine>
+trace random_trace( RandomEngine& engine, uint32_t length, uint32_t num_propositions, uint32_t prefix_length = std::numeric_limits<uint32_t>::max() )
+{
+  std::bernoulli_distribution value_dist( 0.5 );
+
+  trace t;
+  std::vector<int> props;
+  for ( auto i = 0u; i < length; ++i )
+  {
+    props.clear();
+    for ( auto j = 1u; j <= num_propositions; ++j )
+      if ( value_dist( engine ) )
+        props.emplace_back( j );
+
+    if ( i < prefix_length )
+      t.emplace_prefix( props );
+    else
+      t.emplace_suffix( props );
+  }
+  return t;
+}
+
+/* returns `num_good` good and `num_bad` bad random lasso traces, whose second half is the loop */
+inline std::vector<std::pair<trace, bool>> random_examples( uint32_t num_good, uint32_t num_bad, uint32_t length, uint32_t num_propositions )
+{
+  std::default_random_engine engine( 0 );
+  std::vector<std::pair<trace, bool>> examples;
+  for ( auto i = 0u; i < num_good + num_bad; ++i )
+    examples.emplace_back( random_trace( engine, length, num_propositions, length / 2u ), i < num_good );
+  return examples;
+}
+
+/* returns a random sequential AIG whose gates read from inputs, registers, and earlier gates */
+inline mockturtle::aig_network random_sequential_aig( uint32_t num_pis, uint32_t num_registers, uint32_t num_gates, uint32_t num_pos = 8u )
+{
+  using signal = mockturtle::aig_network::signal;
+
+  std::default_random_engine engine( 0 );
+  std::bernoulli_distribution complement( 0.5 );
+
+  mockturtle::aig_network aig;
+  std::vector<signal> fs;
+  for ( auto i = 0u; i < num_pis; ++i )
+    fs.emplace_back( aig.create_pi() );
+  for ( auto i = 0u; i < num_registers; ++i )
+    fs.emplace_back( aig.create_ro() );
+
+  auto const pick = [&](){
+    auto const f = fs[std::uniform_int_distribution<std::size_t>( 0u, fs.size() - 1u )( engine )];
+    return complement( engine ) ? !f : f;
+  };
+
+  for ( auto i = 0u; i < num_gates; ++i )
+    fs.emplace_back( aig.create_and( pick(), pick() ) );
+
+  /* outputs and next-state functions read from the last gates */
+  for ( auto i = 0u; i < num_pos; ++i )
+    aig.create_po( fs[fs.size() - 1u - i % num_gates] );
+  for ( auto i = 0u; i < num_registers; ++i )
+    aig.create_ri( fs[fs.size() - 1u - ( num_pos + i ) % num_gates] );
+
+  return aig;
+}
+
+/* calls fn on all binary DAGs with ordered fanins that extend d to num_vertices vertices
+ *
+ * A synthetic workload for binary_dag: the exact synthesis engines
+ * enumerate percy::partial_dag topologies instead, so there is no
+ * binary_dag enumeration in the library. */
+template<typename Fn>
+void foreach_binary_dag( binary_dag const& d, int num_vertices, Fn&& fn )
+{
+  if ( d.num_vertices() == num_vertices )
+  {
+    fn( d );
+    return;
+  }
+
+  auto const num_nodes = d.num_inputs() + d.num_vertices();
+  for ( int k = 1; k < num_nodes; ++k )
+  {
+    for ( int j = 0; j < k; ++j )
+    {
+      binary_dag next( d );
+      next.add_vertex( j, k );
+      foreach_binary_dag( next, num_vertices, fn );
+    }
+  }
+}
+
+} /* namespace copycat::benchmarks */
@@ -0,0 +1,54 @@
+#include "generators.hpp"
+#include <copycat/io/ltl.hpp>
+#include <copycat/io/ltl_formula_reader.hpp>
+#include <copycat/utils/stopwatch.hpp>
+#include <fmt/format.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+using namespace copycat;
+
+int main( int argc, char* argv[] )
+{
+  uint64_t const num_formulas = argc >= 2 ? std::strtoull( argv[1], nullptr, 10 ) : 1000000u;
+  std::string const filename = "read_ltl_formulas.ltl";
+
+  {
+    std::ofstream ofs( filename );
+    ofs << benchmarks::random_formulas( num_formulas );
+  }
+  fmt::print( "[i] generated {} formulas\n", num_formulas );
+
+  {
+    ltl_formula_store ltl;
+    std::map<std::string, ltl_formula_store::ltl_formula> names;
+    stopwatch<>::duration time{0};
+    auto const result = call_with_stopwatch( time, [&](){ return read_ltl( filename, ltl_formula_reader( ltl, names ) ); } );
+    fmt::print( "[i] {:<20} {:8.2f} s  success = {} #formulas = {} #nodes = {}\n",
+                "read_ltl", to_seconds( time ), result == return_code::success, ltl.num_formulas(), ltl.num_nodes() );
+  }
+
+  {
+    ltl_formula_store ltl;
+    std::map<std::string, ltl_formula_store::ltl_formula> names;
+    stopwatch<>::duration time{0};
+    auto const result = call_with_stopwatch( time, [&](){ return read_ltl_formulas( filename, ltl, names ); } );
+    fmt::print( "[i] {:<20} {:8.2f} s  success = {} #formulas = {} #nodes = {}\n",
+                "read_ltl_formulas", to_seconds( time ), result == return_code::success, ltl.num_formulas(), ltl.num_nodes() );
+  }
+
+  {
+    ltl_formula_store ltl;
+    std::map<std::string, ltl_formula_store::ltl_formula> names;
+    stopwatch<>::duration time{0};
+    auto const result = call_with_stopwatch( time, [&](){ return read_ltl_formulas_parallel( filename, ltl, names ); } );
+    fmt::print( "[i] {:<20} {:8.2f} s  success = {} #formulas = {} #nodes = {} #threads = {}\n",
+                "parallel", to_seconds( time ), result == return_code::success, ltl.num_formulas(), ltl.num_nodes(),
+                std::thread::hardware_concurrency() );
+  }
+
+  std::remove( filename.c_str() );
+  return 0;
+}
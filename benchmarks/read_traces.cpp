@@ -0,0 +1,172 @@
+#include "generators.hpp"
+#include <copycat/io/ltl_synthesis_spec_reader.hpp>
+#include <copycat/io/trace_corpus.hpp>
+#include <copycat/io/traces.hpp>
+#include <copycat/utils/stopwatch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace copycat;
+
+/* counts traces and time steps without materializing them */
+class counting_trace_reader : public trace_reader
+{
+public:
+  explicit counting_trace_reader( uint64_t& num_traces, uint64_t& num_steps )
+    : num_traces( num_traces )
+    , num_steps( num_steps )
+  {
+  }
+
+  void on_good_trace( std::vector<std::vector<int>> const& prefix,
+                      std::vector<std::vector<int>> const& suffix ) const override
+  {
+    ++num_traces;
+    num_steps += prefix.size() + suffix.size();
+  }
+
+  void on_bad_trace( std::vector<std::vector<int>> const& prefix,
+                     std::vector<std::vector<int>> const& suffix ) const override
+  {
+    ++num_traces;
+    num_steps += prefix.size() + suffix.size();
+  }
+
+private:
+  uint64_t& num_traces;
+  uint64_t& num_steps;
+}; /* counting_trace_reader */
+
+std::vector<std::string> split_string( std::string const& input_string, std::string const& delimiter )
+{
+  std::vector<std::string> result;
+  std::size_t prev = 0u, curr = input_string.find( delimiter );
+  while ( curr != std::string::npos )
+  {
+    result.emplace_back( input_string.substr( prev, curr - prev ) );
+    prev = curr + delimiter.size();
+    curr = input_string.find( delimiter, prev );
+  }
+  result.emplace_back( input_string.substr( prev ) );
+  return result;
+}
+
+/* line-based reference parser (std::getline and std::string splitting) */
+void read_traces_reference( std::string const& filename, uint64_t& num_traces, uint64_t& num_steps )
+{
+  std::ifstream ifs( filename );
+  uint32_t num_propositions = 0u;
+  std::string line;
+  while ( std::getline( ifs, line ) )
+  {
+    if ( detail::is_separator_line( line ) )
+      continue;
+
+    auto const affixes = split_string( line, "::" );
+    std::vector<std::vector<int>> t;
+    for ( auto const& time_step : split_string( affixes[0u], ";" ) )
+    {
+      auto const signals = split_string( time_step, "," );
+      std::vector<int> signal_data;
+      for ( auto i = 0u; i < signals.size(); ++i )
+      {
+        if ( signals.at( i ) == "1" )
+        {
+          signal_data.emplace_back( i + 1 );
+          num_propositions = std::max( num_propositions, i + 1 );
+        }
+      }
+      t.emplace_back( signal_data );
+    }
+    ++num_traces;
+    num_steps += t.size();
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  std::string filename = "read_traces_corpus.trace";
+  bool generated = false;
+
+  if ( argc == 2 && std::ifstream( argv[1] ).good() )
+  {
+    filename = argv[1];
+  }
+  else
+  {
+    uint64_t const size_in_mib = argc == 2 ? std::strtoull( argv[1], nullptr, 10 ) : 64u;
+    fmt::print( "[i] generate corpus of {} MiB\n", size_in_mib );
+    benchmarks::write_corpus( filename, size_in_mib << 20u );
+    generated = true;
+  }
+
+  double const size_in_mib = memory_mapped_file( filename ).size() / double( 1u << 20u );
+  auto const report = [&]( std::string const& name, stopwatch<>::duration const& time, uint64_t num_traces, uint64_t num_steps ){
+    fmt::print( "[i] {:<24} {:8.2f} s {:10.2f} MiB/s  #traces = {} #steps = {}\n",
+                name, to_seconds( time ), size_in_mib / to_seconds( time ), num_traces, num_steps );
+  };
+
+  {
+    uint64_t num_traces = 0u, num_steps = 0u;
+    stopwatch<>::duration time{0};
+    call_with_stopwatch( time, [&](){ read_traces_reference( filename, num_traces, num_steps ); } );
+    report( "getline + split_string", time, num_traces, num_steps );
+  }
+
+  {
+    uint64_t num_traces = 0u, num_steps = 0u;
+    stopwatch<>::duration time{0};
+    call_with_stopwatch( time, [&](){ read_traces( filename, counting_trace_reader( num_traces, num_steps ) ); } );
+    report( "read_traces", time, num_traces, num_steps );
+  }
+
+  {
+    ltl_synthesis_spec spec;
+    stopwatch<>::duration time{0};
+    call_with_stopwatch( time, [&](){ read_ltl_synthesis_spec( filename, spec ); } );
+    report( "read_ltl_synthesis_spec", time, spec.good_traces.size() + spec.bad_traces.size(), 0u );
+  }
+
+  {
+    ltl_synthesis_spec spec;
+    stopwatch<>::duration time{0};
+    call_with_stopwatch( time, [&](){ read_ltl_synthesis_spec_parallel( filename, spec ); } );
+    report( fmt::format( "parallel ({} threads)", std::thread::hardware_concurrency() ), time, spec.good_traces.size() + spec.bad_traces.size(), 0u );
+  }
+
+  /* binary trace corpus */
+  std::string const corpus_filename = filename + ".bin";
+  convert_traces_to_corpus( filename, corpus_filename );
+
+  {
+    uint64_t num_traces = 0u, num_steps = 0u;
+    stopwatch<>::duration time{0};
+    call_with_stopwatch( time, [&](){
+        trace_corpus const corpus( corpus_filename );
+        num_traces = corpus.num_traces();
+        for ( auto i = 0u; i < num_traces; ++i )
+          num_steps += corpus.length( i );
+      });
+    report( "trace_corpus (index)", time, num_traces, num_steps );
+  }
+
+  {
+    ltl_synthesis_spec spec;
+    stopwatch<>::duration time{0};
+    call_with_stopwatch( time, [&](){ trace_corpus( corpus_filename ).load( spec ); } );
+    report( "trace_corpus (load)", time, spec.good_traces.size() + spec.bad_traces.size(), 0u );
+  }
+
+  std::remove( corpus_filename.c_str() );
+  if ( generated )
+  {
+    std::remove( filename.c_str() );
+  }
+
+  return 0;
+}
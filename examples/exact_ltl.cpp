@@ -1,16 +1,28 @@
 #include <bill/sat/solver.hpp>
 #include <copycat/algorithms/exact_ltl_pdag_encoder.hpp>
+#include <copycat/algorithms/ltl_batch_verifier.hpp>
+#include <copycat/algorithms/ltl_enumerative_learner.hpp>
+#include <copycat/algorithms/ltl_evaluator.hpp>
 #include <copycat/algorithms/ltl_learner.hpp>
 #include <copycat/chain/print.hpp>
+#include <copycat/io/ltl_formula_reader.hpp>
 #include <copycat/io/ltl_synthesis_spec_reader.hpp>
 #include <copycat/io/traces.hpp>
 #include <copycat/trace.hpp>
+#include <copycat/utils/json_lines_log.hpp>
+#include <copycat/utils/profiler.hpp>
 #include <copycat/utils/read_json.hpp>
 #include <copycat/utils/stopwatch.hpp>
 #include <copycat/utils/string_utils.hpp>
+#include <copycat/utils/subprocess_pool.hpp>
 #include <fmt/format.h>
+#include <fstream>
 #include <iostream>
-#include <iomanip>
+#include <limits>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace copycat::detail
 {
@@ -26,9 +38,12 @@ struct exact_ltl_parameters
   bool generate_constraints = true;
   bool solve_constraints = true;
 
-  /* name of log file */
+  /* name of log file (one JSON record per line) */
   std::string filename = "exact_ltl.log";
 
+  /* keep an existing log and skip the benchmarks logged in it */
+  bool resume = false;
+
   /* write statistics about the generated constraints into the log file */
   bool log_constraint_stats = false;
 
@@ -38,252 +53,37 @@ struct exact_ltl_parameters
   /* maximum number of nodes to try bounded synthesis */
   uint32_t max_num_nodes = 8u;
 
-  /* solver conflict limit */
-  int32_t conflict_limit = -1;
-
-  /* be verbose? */
-  bool verbose = false;
-}; /* exact_ltl_parameters */
-
-namespace copycat
-{
-
-class default_ltl_simulator
-{
-public:
-  explicit default_ltl_simulator() = default;
-
-  bool run( copycat::chain<std::string,std::vector<int>> const& chain, copycat::trace const& trace ) const
-  {
-    return eval_rec( chain, trace, chain.length(), 0u );
-  }
+  /* try enumeration of formulas before SAT-based synthesis; enumeration minimizes the
+     formula tree, not the number of DAG nodes, so its results are logged as non-exact */
+  bool enumeration = false;
 
-  bool eval_rec( copycat::chain<std::string,std::vector<int>> const& chain, copycat::trace const& trace, uint32_t chain_node, uint32_t trace_pos ) const
-  {
-    auto const label = chain.label_at( chain_node );
-    if ( label.size() >= 1u && label[0u] == 'x' )
-      return eval_proposition( chain, trace, chain_node, trace_pos );
-    else if ( label == "~" )
-      return eval_negation( chain, trace, chain_node, trace_pos );
-    else if ( label == "&" )
-      return eval_conjunction( chain, trace, chain_node, trace_pos );
-    else if ( label == "|" )
-      return eval_disjunction( chain, trace, chain_node, trace_pos );
-    else if ( label == "->" )
-      return eval_implies( chain, trace, chain_node, trace_pos );
-    else if ( label == "X" )
-      return eval_next( chain, trace, chain_node, trace_pos );
-    else if ( label == "G" )
-      return eval_globally( chain, trace, chain_node, trace_pos );
-    else if ( label == "F" )
-      return eval_eventually( chain, trace, chain_node, trace_pos );
-    else if ( label == "U" )
-      return eval_until( chain, trace, chain_node, trace_pos );
-    else
-    {
-      std::cout << "[e] unsupported label " << label << std::endl;
-      assert( false );
-    }
+  /* maximum formula size for enumeration */
+  uint32_t enumeration_max_size = copycat::ltl_enumerative_learner_parameters{}.max_size;
 
-    return false;
-  }
-
-  bool eval_proposition( copycat::chain<std::string,std::vector<int>> const& chain, copycat::trace const& trace, uint32_t chain_node, uint32_t trace_pos ) const
-  {
-    // std::cout << "eval_proposition: " << chain_node << ' ' << trace_pos << std::endl;
-    auto const label = chain.label_at( chain_node );
-    auto const prop_id = std::atoi( label.substr( 1u ).c_str() );
-    return trace.has( trace_pos, prop_id+1 );
-  }
-
-  bool eval_negation( copycat::chain<std::string,std::vector<int>> const& chain, copycat::trace const& trace, uint32_t chain_node, uint32_t trace_pos ) const
-  {
-    // std::cout << "eval_negation: " << chain_node << std::endl;
-    auto const step = chain.step_at( chain_node );
-    assert( step.size() == 1u );
-    return !eval_rec( chain, trace, step[0u], trace_pos );
-  }
-
-  bool eval_conjunction( copycat::chain<std::string,std::vector<int>> const& chain, copycat::trace const& trace, uint32_t chain_node, uint32_t trace_pos ) const
-  {
-    // std::cout << "eval_conjunction: " << chain_node << std::endl;
-    auto const step = chain.step_at( chain_node );
-    assert( step.size() == 2u );
-    return eval_rec( chain, trace, step[0u], trace_pos ) && eval_rec( chain, trace, step[1u], trace_pos );
-  }
-
-  bool eval_disjunction( copycat::chain<std::string,std::vector<int>> const& chain, copycat::trace const& trace, uint32_t chain_node, uint32_t trace_pos ) const
-  {
-    // std::cout << "eval_disjunction: " << chain_node << std::endl;
-    auto const step = chain.step_at( chain_node );
-    assert( step.size() == 2u );
-    return eval_rec( chain, trace, step[0u], trace_pos ) || eval_rec( chain, trace, step[1u], trace_pos );
-  }
-
-  bool eval_implies( copycat::chain<std::string,std::vector<int>> const& chain, copycat::trace const& trace, uint32_t chain_node, uint32_t trace_pos ) const
-  {
-    // std::cout << "eval_implies: " << chain_node << std::endl;
-    auto const step = chain.step_at( chain_node );
-    assert( step.size() == 2u );
-    return ( !eval_rec( chain, trace, step[0u], trace_pos ) ) || eval_rec( chain, trace, step[1u], trace_pos );
-  }
-
-  bool eval_globally( copycat::chain<std::string,std::vector<int>> const& chain, copycat::trace const& trace, uint32_t chain_node, uint32_t trace_pos ) const
-  {
-    // std::cout << "eval_globally: " << chain_node << std::endl;
-    auto const step = chain.step_at( chain_node );
-    assert( step.size() == 1u );
-
-    uint32_t start_pos = trace_pos < trace.prefix_length() ? trace_pos : trace.prefix_length();
-    for ( auto i = start_pos; i < trace.length(); ++i )
-    {
-      if ( !eval_rec( chain, trace, step[0u], i ) )
-      {
-        return false;
-      }
-    }
-
-    return true;
-  }
-
-  bool eval_eventually( copycat::chain<std::string,std::vector<int>> const& chain, copycat::trace const& trace, uint32_t chain_node, uint32_t trace_pos ) const
-  {
-    // std::cout << "eval_eventually: " << chain_node << std::endl;
-    auto const step = chain.step_at( chain_node );
-    assert( step.size() == 1u );
-
-    uint32_t start_pos = trace_pos < trace.prefix_length() ? trace_pos : trace.prefix_length();
-    for ( auto i = start_pos; i < trace.length(); ++i )
-    {
-      if ( eval_rec( chain, trace, step[0u], i ) )
-      {
-        return true;
-      }
-    }
+  /* discard enumerated formulas proven unsatisfiable or valid */
+  bool enumeration_filter = false;
 
-    return false;
-  }
-
-  bool eval_next( copycat::chain<std::string,std::vector<int>> const& chain, copycat::trace const& trace, uint32_t chain_node, uint32_t trace_pos ) const
-  {
-    // std::cout << "eval_next: " << chain_node << std::endl;
-    auto const step = chain.step_at( chain_node );
-    assert( step.size() == 1u );
-    if ( trace_pos == trace.length() - 1u )
-      return eval_rec( chain, trace, step[0u], trace.prefix_length() );
-    else
-      return eval_rec( chain, trace, step[0u], trace_pos + 1u );
-  }
-
-  bool eval_until( copycat::chain<std::string,std::vector<int>> const& chain, copycat::trace const& trace, uint32_t chain_node, uint32_t trace_pos ) const
-  {
-    // std::cout << "eval_until: " << chain_node << std::endl;
-    auto const step = chain.step_at( chain_node );
-    assert( step.size() == 2u );
-
-    auto start_pos = trace_pos;
-    int32_t pos;
-
-    while ( start_pos < trace.length() )
-    {
-      pos = -1;
-
-      /* find a position at which step[1u] is satisfied */
-      for ( int32_t i = start_pos; i < int32_t( trace.length() ); ++i )
-      {
-        if ( eval_rec( chain, trace, step[1u], i ) )
-        {
-          pos = int32_t( i );
-          break;
-        }
-      }
-
-      if ( pos == -1 )
-        break;
-
-      /* check if step[0u] is true before */
-      bool all_true = true;
-      for ( int32_t j = trace_pos; j < pos; ++j )
-      {
-        all_true &= eval_rec( chain, trace, step[0u], j );
-        if ( !all_true )
-          break;
-      }
-
-      if ( all_true )
-        return true;
-
-      start_pos = pos + 1;
-    }
-
-    /* if we cannot find a positions and we are already looking in the suffix, then
-       look in the suffix before the current position */
-    if ( pos == -1 && trace_pos >= trace.prefix_length() )
-    {
-      for ( uint32_t i = trace.prefix_length(); i < trace_pos; ++i )
-      {
-        if ( eval_rec( chain, trace, step[1u], i ) )
-        {
-          pos = int32_t( i );
-          break;
-        }
-      }
-    }
-
-    if ( pos == -1 )
-      return false;
-
-    /* check if step[0u] is true before */
-    bool all_true = true;
-    for ( uint32_t j = trace_pos; j < trace.length(); ++j )
-    {
-      all_true &= eval_rec( chain, trace, step[0u], j );
-      if ( !all_true )
-        return false;
-    }
-    for ( int32_t j = trace.prefix_length(); j < pos; ++j )
-    {
-      all_true &= eval_rec( chain, trace, step[0u], j );
-      if ( !all_true )
-        return false;
-    }
-
-    return true;
+  /* solver conflict limit */
+  int32_t conflict_limit = -1;
 
-    // return eval_rec( chain, trace, step[1u], trace_pos ) || ( eval_rec( chain, trace, step[0u], trace_pos ) && eval_rec( chain, trace, chain_node, trace_pos + 1 ) );
-  }
-}; /* ltl_default_simulator */
+  /* number of benchmarks run in parallel subprocesses (1 to run in-process) */
+  uint32_t num_workers = 1u;
 
-template<class Simulator = default_ltl_simulator>
-bool simulate( copycat::chain<std::string,std::vector<int>> const& c, copycat::trace const& trace, Simulator const& sim = Simulator() )
-{
-  return sim.run( c, trace );
-}
+  /* wall-clock time limit per benchmark in seconds (0 for no limit) */
+  double timeout = 0.0;
 
-bool simulate( copycat::chain<std::string,std::vector<int>> const& c, copycat::ltl_synthesis_spec const& spec )
-{
-  for ( const auto& g : spec.good_traces )
-  {
-    // std::cout << "good trace "; g.print();
-    if ( !simulate( c, g ) )
-    {
-      return false;
-    }
-  }
+  /* memory limit per benchmark in MB (0 for no limit) */
+  uint64_t memory_limit = 0u;
 
-  for ( const auto& b : spec.bad_traces )
-  {
-    // std::cout << "bad trace "; b.print();
-    if ( simulate( c, b ) )
-    {
-      return false;
-    }
-  }
+  /* write a nested breakdown of time and counters per phase into the log file */
+  bool profile = false;
 
-  return true;
-}
+  /* name of a file to append the profiles to in folded-stack format (empty to disable) */
+  std::string flamegraph;
 
-} /* namespace copycat */
+  /* be verbose? */
+  bool verbose = false;
+}; /* exact_ltl_parameters */
 
 template<
   typename Solver = bill::solver<bill::solvers::glucose_41>,
@@ -292,16 +92,17 @@ template<
 class exact_ltl_engine
 {
 public:
-  explicit exact_ltl_engine( exact_ltl_parameters const& ps, nlohmann::json& log )
+  explicit exact_ltl_engine( exact_ltl_parameters const& ps )
     : _ps( ps )
-    , _log( log )
   {
   }
 
-  void run( copycat::ltl_synthesis_spec const& spec )
+  nlohmann::json run( copycat::ltl_synthesis_spec const& spec )
   {
     auto entry = nlohmann::json( {} );
     entry["command"] = fmt::format( "exact_ltl {}", spec.name );
+    entry["benchmark"] = spec.name;
+    entry["status"] = "success";
 
     auto const parts = copycat::split_path( spec.name, { '/' } );
     entry["file"] = parts.at( parts.size() - 1u );
@@ -321,28 +122,176 @@ public:
     entry["has_verify_params"] = spec.formulas.size() > 0u ? true : false;
     entry["num_propositions"] = spec.num_propositions;
 
+    _profiler.clear();
+
+    /* check the formulas of the verification section against the traces */
+    if ( spec.formulas.size() > 0u )
+    {
+      copycat::scoped_timer t( profiler(), "verify_formulas" );
+      verify_formulas( spec, entry );
+    }
+
+    /* operator weights from the parameter section; minimize cost instead of size */
+    weights = copycat::read_operator_weights( spec );
+    best_cost = std::nullopt;
+    entry["cost_guided"] = !weights.empty();
+
     /* bounded synthesis loop */
     copycat::stopwatch<>::duration time_total{0};
     total_pdags_explored = 0u;
     {
       copycat::stopwatch watch( time_total );
 
+      /* shared by all candidate chains of this spec */
+      copycat::ltl_batch_verifier verifier( spec );
+
+      /* enumeration minimizes size, so it is only used without weights */
       auto instances = nlohmann::json::array();
-      for ( uint32_t num_nodes = 1u; num_nodes <= _ps.max_num_nodes; ++num_nodes )
-        if ( exact_synthesis( spec, num_nodes, instances ) )
-          break;
+      bool const enumerated = weights.empty() && enumerative_synthesis( spec, verifier, instances );
+      if ( !enumerated )
+      {
+        for ( uint32_t num_nodes = 1u; num_nodes <= _ps.max_num_nodes; ++num_nodes )
+          if ( exact_synthesis( spec, verifier, num_nodes, instances ) )
+            break;
+      }
 
       entry["instances"] = instances;
+      entry["exact"] = !enumerated;
     }
     entry["#total_pdags_explored"] = total_pdags_explored;
+    if ( best_cost )
+      entry["best_cost"] = *best_cost;
     entry["total_time"] = fmt::format( "{:8.2f}", copycat::to_seconds( time_total ) );
     std::cout << fmt::format( "[i] total time: {:8.2f}s\n", copycat::to_seconds( time_total ) );
 
-    _log.emplace_back( entry );
+    if ( profiler() )
+      entry["profile"] = _profiler.to_json();
+
+    return entry;
   }
 
-  bool exact_synthesis( copycat::ltl_synthesis_spec const& spec, uint32_t num_nodes, nlohmann::json& json )
+  void verify_formulas( copycat::ltl_synthesis_spec const& spec, nlohmann::json& entry )
   {
+    copycat::stopwatch<>::duration time_verification{0};
+    auto results = nlohmann::json::array();
+    {
+      copycat::stopwatch watch( time_verification );
+
+      /* proposition k of the traces is named x{k-1} */
+      copycat::ltl_formula_store ltl;
+      std::map<std::string, copycat::ltl_formula_store::ltl_formula> names;
+      for ( auto i = 0u; i < spec.num_propositions; ++i )
+        names.emplace( fmt::format( "x{}", i ), ltl.create_variable() );
+
+      copycat::ltl_lasso_evaluator const eval( ltl );
+      for ( const auto& formula : spec.formulas )
+      {
+        auto result = nlohmann::json( {} );
+        result["formula"] = formula;
+
+        copycat::stopwatch<>::duration time_formula{0};
+        {
+          copycat::stopwatch watch_formula( time_formula );
+
+          auto const num_formulas = ltl.num_formulas();
+          if ( copycat::read_ltl_formulas( std::string_view( formula ), ltl, names ) != copycat::return_code::success ||
+               ltl.num_formulas() != num_formulas + 1u )
+          {
+            std::cout << fmt::format( "[w] could not parse formula `{}`\n", formula );
+            result["error"] = "parse error";
+            results.emplace_back( result );
+            continue;
+          }
+
+          copycat::ltl_formula_store::ltl_formula f;
+          ltl.foreach_formula( [&]( auto const& g ){ f = g; return true; } );
+
+          std::vector<bool> good, bad;
+          for ( const auto& t : spec.good_traces )
+            good.emplace_back( copycat::evaluate( f, t, eval ) );
+          for ( const auto& t : spec.bad_traces )
+            bad.emplace_back( copycat::evaluate( f, t, eval ) );
+
+          result["good"] = good;
+          result["bad"] = bad;
+          result["holds"] = std::all_of( good.begin(), good.end(), []( bool b ){ return b; } ) &&
+                            std::none_of( bad.begin(), bad.end(), []( bool b ){ return b; } );
+        }
+        result["time"] = fmt::format( "{:8.2f}", copycat::to_seconds( time_formula ) );
+
+        std::cout << fmt::format( "[i] verify `{}`: {}\n", formula, result["holds"].get<bool>() ? "PASS" : "FAIL" );
+        results.emplace_back( result );
+      }
+    }
+
+    entry["verification"] = results;
+    entry["time_verification"] = fmt::format( "{:8.2f}", copycat::to_seconds( time_verification ) );
+  }
+
+  bool enumerative_synthesis( copycat::ltl_synthesis_spec const& spec, copycat::ltl_batch_verifier& verifier, nlohmann::json& json )
+  {
+    if ( !_ps.enumeration )
+      return false;
+
+    std::cout << "[i] enumerative synthesis up to size " << _ps.enumeration_max_size << std::endl;
+
+    copycat::scoped_timer t( profiler(), "enumeration" );
+
+    auto instance = nlohmann::json( {} );
+    instance["method"] = "enumeration";
+    instance["exact"] = false;
+
+    copycat::ltl_enumerative_learner_parameters learner_ps;
+    learner_ps.max_size = _ps.enumeration_max_size;
+    learner_ps.filter_trivial_candidates = _ps.enumeration_filter;
+    learner_ps.verbose = _ps.verbose;
+
+    copycat::ltl_formula_store ltl;
+    copycat::ltl_enumerative_learner learner( ltl, spec, learner_ps );
+
+    bool found;
+    copycat::stopwatch<>::duration time_enumeration{0};
+    {
+      copycat::stopwatch watch( time_enumeration );
+      found = learner.run().has_value();
+    }
+    std::cout << fmt::format( "[i] enumeration: {} in {:8.2f}s\n",
+                              found ? "FOUND" : "NOT FOUND",
+                              copycat::to_seconds( time_enumeration ) );
+
+    instance["time_enumeration"] = fmt::format( "{:8.2f}", copycat::to_seconds( time_enumeration ) );
+    instance["#candidates"] = learner.statistics().num_candidates;
+    instance["#pruned"] = learner.statistics().num_pruned;
+    if ( _ps.enumeration_filter )
+    {
+      instance["#filtered"] = learner.statistics().num_filtered;
+      instance["filter_hit_rate"] = learner.filter_statistics().hit_rate();
+    }
+
+    if ( found )
+    {
+      std::stringstream chain_as_string;
+      auto const c = learner.get_chain();
+      copycat::write_chain( c, chain_as_string );
+      instance["chain"] = chain_as_string.str();
+      instance["#nodes"] = c.length();
+
+      copycat::write_chain( c );
+
+      copycat::scoped_timer t2( profiler(), "verify" );
+      auto const sim_result = verifier.verify( c );
+      std::cout << "[i] simulate: " << ( sim_result ? "verified" : "failed" ) << std::endl;
+      instance["verified"] = sim_result;
+    }
+
+    json.emplace_back( instance );
+    return found;
+  }
+
+  bool exact_synthesis( copycat::ltl_synthesis_spec const& spec, copycat::ltl_batch_verifier& verifier, uint32_t num_nodes, nlohmann::json& json )
+  {
+    copycat::scoped_timer t( profiler(), "exact_synthesis" );
+
     auto instance = nlohmann::json( {} );
 
     std::cout << "[i] bounded synthesis with " << num_nodes << " node" << std::endl;
@@ -375,6 +324,7 @@ public:
       bill::result::states result;
       copycat::stopwatch<>::duration time_solving{0};
       {
+        copycat::scoped_timer t2( profiler(), "solve" );
         copycat::stopwatch watch( time_solving );
         result = _ps.conflict_limit < 0 ? solver.solve() : solver.solve( /* no assumptions */{}, _ps.conflict_limit );
       }
@@ -394,7 +344,8 @@ public:
 
         copycat::write_chain( c );
 
-        auto const sim_result = simulate( c, spec );
+        copycat::scoped_timer t2( profiler(), "verify" );
+        auto const sim_result = verifier.verify( c );
         std::cout << "[i] simulate: " << ( sim_result ? "verified" : "failed" ) << std::endl;
         instance["verified"] = sim_result;
 
@@ -407,13 +358,19 @@ public:
       std::cout << "Encoder: exact_ltl_pdag_encoder" << std::endl;
 
       /* pre-compute partial DAGs to guide synthesis */
-      auto const pdags = copycat::pd_generate_filtered( num_nodes, spec.num_propositions );
+      std::vector<percy::partial_dag> pdags;
+      {
+        copycat::scoped_timer t2( profiler(), "generate_pdags" );
+        pdags = copycat::pd_generate_filtered( num_nodes, spec.num_propositions );
+      }
       std::cout << "[i] #pdags: " << pdags.size() << std::endl;
 
       copycat::exact_ltl_pdag_encoder_parameter enc_ps;
       enc_ps.verbose = _ps.verbose;
       enc_ps.num_propositions = spec.num_propositions;
       enc_ps.ops = spec.operators;
+      enc_ps.weights = weights;
+      enc_ps.profile = profiler();
 
       for ( const auto& t : spec.good_traces )
         enc_ps.traces.emplace_back( t, true );
@@ -452,8 +409,17 @@ public:
         instance["#clauses"] = total_num_clauses / num_considered_instances;
         instance["#pdags_explored"] = ( i + 1 );
 
+        /* with weights, only look for chains cheaper than the best one so far */
+        if ( best_cost )
+        {
+          if ( *best_cost == 0u )
+            break;
+          enc.add_cost_bound( *best_cost - 1u );
+        }
+
         bill::result::states result;
         {
+          copycat::scoped_timer t2( profiler(), "solve" );
           copycat::stopwatch watch( time_solving );
           result = _ps.conflict_limit < 0 ? solver.solve() : solver.solve( /* no assumptions */{}, _ps.conflict_limit );
         }
@@ -464,39 +430,121 @@ public:
 
         instance["time_solving"] = fmt::format( "{:8.2f}", copycat::to_seconds( time_solving ) );
 
-        if ( result == bill::result::states::satisfiable )
+        if ( weights.empty() )
         {
-          std::stringstream chain_as_string;
-          auto const& c = enc.extract_chain();
-          copycat::write_chain( c, chain_as_string );
-          instance["chain"] = chain_as_string.str();
+          if ( result == bill::result::states::satisfiable )
+          {
+            report_chain( enc.extract_chain(), verifier, instance );
+            return_value = true; /* terminate loop */
+            break;
+          }
+          continue;
+        }
 
-          copycat::write_chain( c );
+        /* tighten the cost bound on the same solver until no cheaper chain exists */
+        while ( result == bill::result::states::satisfiable )
+        {
+          auto const cost = enc.extract_cost();
+          std::cout << fmt::format( "[i] found chain with cost {}\n", cost );
+          best_cost = cost;
+          instance["cost"] = cost;
+          report_chain( enc.extract_chain(), verifier, instance );
 
-          auto const sim_result = simulate( c, spec );
-          std::cout << "[i] simulate: " << ( sim_result ? "verified" : "failed" ) << std::endl;
-          instance["verified"] = sim_result;
+          if ( cost == 0u )
+            break;
+          enc.add_cost_bound( cost - 1u );
 
-          return_value = true; /* terminate loop */
-          break;
+          copycat::scoped_timer t2( profiler(), "solve" );
+          copycat::stopwatch watch( time_solving );
+          result = _ps.conflict_limit < 0 ? solver.solve() : solver.solve( /* no assumptions */{}, _ps.conflict_limit );
         }
       }
+
+      /* chains with more nodes cost at least ( num_nodes + 1 ) * minimum weight */
+      if ( best_cost )
+      {
+        uint32_t min_weight = std::numeric_limits<uint32_t>::max();
+        for ( const auto& op : spec.operators )
+        {
+          auto const it = weights.find( op );
+          min_weight = std::min( min_weight, it != weights.end() ? it->second : 1u );
+        }
+
+        /* the bound is void for zero weights or without operators */
+        if ( min_weight > 0u && min_weight != std::numeric_limits<uint32_t>::max() )
+          return_value = uint64_t( num_nodes + 1u ) * min_weight >= *best_cost;
+      }
     }
 
     json.emplace_back( instance );
     return return_value;
   }
 
+  void report_chain( copycat::chain<std::string, std::vector<int>> const& c, copycat::ltl_batch_verifier& verifier, nlohmann::json& instance )
+  {
+    std::stringstream chain_as_string;
+    copycat::write_chain( c, chain_as_string );
+    instance["chain"] = chain_as_string.str();
+
+    copycat::write_chain( c );
+
+    copycat::scoped_timer t( profiler(), "verify" );
+    auto const sim_result = verifier.verify( c );
+    std::cout << "[i] simulate: " << ( sim_result ? "verified" : "failed" ) << std::endl;
+    instance["verified"] = sim_result;
+  }
+
+protected:
+  /* registry for the phases of the current spec (nullptr if profiling is disabled) */
+  copycat::profiler* profiler()
+  {
+    return _ps.profile || !_ps.flamegraph.empty() ? &_profiler : nullptr;
+  }
+
 protected:
   exact_ltl_parameters const& _ps;
-  nlohmann::json& _log;
 
   /* solver */
   Solver solver;
 
   uint32_t total_pdags_explored = 0u;
+
+  /* operator weights of the current spec and cost of the cheapest chain found */
+  std::unordered_map<copycat::operator_opcode, uint32_t> weights;
+  std::optional<uint32_t> best_cost;
+
+  copycat::profiler _profiler;
 }; /* exact_ltl_engine */
 
+/* runs a single benchmark and returns its log record */
+nlohmann::json run_benchmark( exact_ltl_parameters const& ps, std::string const& filename )
+{
+  auto const unsolved = [&]( std::string const& status, std::string const& reason ){
+    auto entry = nlohmann::json( {} );
+    entry["command"] = fmt::format( "exact_ltl {}", filename );
+    entry["benchmark"] = filename;
+    entry["status"] = status;
+    entry["reason"] = reason;
+    return entry;
+  };
+
+  copycat::ltl_synthesis_spec spec;
+  if ( !read_ltl_synthesis_spec( filename, spec ) )
+    return unsolved( "failed", "could not read benchmark" );
+
+  spec.name = filename;
+
+  /* let's focus on simple benchmarks only */
+  if ( spec.good_traces.size() == 0u && spec.bad_traces.size() == 0u )
+    return unsolved( "skipped", "no traces" );
+
+  if ( spec.good_traces.size() > 5u || spec.bad_traces.size() > 5u ) // 105
+    return unsolved( "skipped", "more than 5 good or bad traces" );
+
+  exact_ltl_engine engine( ps );
+  return engine.run( spec );
+}
+
 int main( int argc, char* argv[] )
 {
   if ( argc != 2 )
@@ -527,43 +575,130 @@ int main( int argc, char* argv[] )
     ps.verbose = config["verbose"].get<bool>();
   if ( config.count( "max_num_nodes" ) )
     ps.max_num_nodes = config["max_num_nodes"].get<uint32_t>();
+  if ( config.count( "enumeration" ) )
+    ps.enumeration = config["enumeration"].get<bool>();
+  if ( config.count( "enumeration_max_size" ) )
+    ps.enumeration_max_size = config["enumeration_max_size"].get<uint32_t>();
+  if ( config.count( "enumeration_filter" ) )
+    ps.enumeration_filter = config["enumeration_filter"].get<bool>();
+  if ( config.count( "filename" ) )
+    ps.filename = config["filename"].get<std::string>();
+  if ( config.count( "resume" ) )
+    ps.resume = config["resume"].get<bool>();
+  if ( config.count( "num_workers" ) )
+    ps.num_workers = config["num_workers"].get<uint32_t>();
+  if ( config.count( "timeout" ) )
+    ps.timeout = config["timeout"].get<double>();
+  if ( config.count( "memory_limit" ) )
+    ps.memory_limit = config["memory_limit"].get<uint64_t>();
+  if ( config.count( "profile" ) )
+    ps.profile = config["profile"].get<bool>();
+  if ( config.count( "flamegraph" ) )
+    ps.flamegraph = config["flamegraph"].get<std::string>();
 
   if ( config.count( "benchmarks" ) )
   {
     auto const benchmarks = config["benchmarks"];
 
-    nlohmann::json log = nlohmann::json::array();
-
-    auto progress_counter = 0u;
-    for ( const auto& value : benchmarks )
+    copycat::json_lines_log_parameters log_ps;
+    log_ps.resume = ps.resume;
+    copycat::json_lines_log log( ps.filename, log_ps );
+    if ( !log.good() )
     {
-      /* print progress */
-      std::cout << fmt::format( "[i] benchmarks = {} / {} ({:6.2f}%)\r",
-                                progress_counter, benchmarks.size(),
-                                ( 100.00*progress_counter )/double(benchmarks.size()) );
-      ++progress_counter;
-      std::cout.flush();
-
-      exact_ltl_engine engine( ps, log );
+      std::cout << fmt::format( "[e] could not open log file `{}`\n", ps.filename );
+      return -1;
+    }
+    if ( ps.resume )
+      std::cout << fmt::format( "[i] resume with {} logged records\n", log.num_records() );
 
-      copycat::ltl_synthesis_spec spec;
-      if ( read_ltl_synthesis_spec( value["file"].get<std::string>(), spec ) )
+    /* profiles in folded-stack format, one root frame per benchmark */
+    std::ofstream flamegraph;
+    if ( !ps.flamegraph.empty() )
+    {
+      flamegraph.open( ps.flamegraph, ps.resume ? std::ios::app : std::ios::trunc );
+      if ( !flamegraph.good() )
       {
-        spec.name = value["file"].get<std::string>();
+        std::cout << fmt::format( "[e] could not open flamegraph file `{}`\n", ps.flamegraph );
+        return -1;
+      }
+    }
 
-        /* let's focus on simple benchmarks only */
-        if ( spec.good_traces.size() == 0u && spec.bad_traces.size() == 0u )
-          continue;
+    /* benchmarks that failed, timed out, or crashed are run again when resuming */
+    auto const is_done = [&]( std::string const& benchmark ){
+      auto const status = log.status( benchmark );
+      return status && ( status->empty() || *status == "success" || *status == "skipped" );
+    };
+
+    auto const append = [&]( nlohmann::json const& entry ){
+      if ( flamegraph.is_open() && entry.count( "profile" ) )
+        copycat::profiler::write_folded( entry["profile"], flamegraph, entry["file"].get<std::string>() );
+      log.append( entry );
+    };
 
-        if ( spec.good_traces.size() > 5u || spec.bad_traces.size() > 5u ) // 105
+    if ( ps.num_workers <= 1u && ps.timeout == 0.0 && ps.memory_limit == 0u )
+    {
+      auto progress_counter = 0u;
+      for ( const auto& value : benchmarks )
+      {
+        /* print progress */
+        std::cout << fmt::format( "[i] benchmarks = {} / {} ({:6.2f}%)\r",
+                                  progress_counter, benchmarks.size(),
+                                  ( 100.00*progress_counter )/double(benchmarks.size()) );
+        ++progress_counter;
+        std::cout.flush();
+
+        if ( is_done( value["file"].get<std::string>() ) )
           continue;
 
-        engine.run( spec );
+        append( run_benchmark( ps, value["file"].get<std::string>() ) );
       }
-
-      std::ofstream ofs( ps.filename );
-      ofs << std::setw( 4 ) << log << std::endl;
-      ofs.close();
+    }
+    else
+    {
+      std::vector<std::string> pending;
+      for ( const auto& value : benchmarks )
+        if ( !is_done( value["file"].get<std::string>() ) )
+          pending.emplace_back( value["file"].get<std::string>() );
+
+      std::cout << fmt::format( "[i] run {} benchmarks on {} workers\n", pending.size(), std::max( 1u, ps.num_workers ) );
+
+      copycat::subprocess_pool_parameters pool_ps;
+      pool_ps.num_workers = std::max( 1u, ps.num_workers );
+      pool_ps.timeout = ps.timeout;
+      pool_ps.memory_limit = ps.memory_limit * 1024u * 1024u;
+      pool_ps.quiet_workers = !ps.verbose;
+
+      /* records are appended in benchmark order, independent of the order in which workers finish */
+      copycat::subprocess_pool pool( pool_ps );
+      pool.run( pending.size(),
+                [&]( uint32_t index ){
+                  return run_benchmark( ps, pending.at( index ) ).dump();
+                },
+                [&]( copycat::job_result const& result ){
+                  auto status = result.status;
+                  if ( status == copycat::job_status::success )
+                  {
+                    if ( result.output.empty() )
+                      return;
+
+                    auto const output = nlohmann::json::parse( result.output, nullptr, /* allow_exceptions = */false );
+                    if ( !output.is_discarded() )
+                    {
+                      append( output );
+                      return;
+                    }
+
+                    std::cout << fmt::format( "[e] malformed output of benchmark `{}`\n", pending.at( result.index ) );
+                    status = copycat::job_status::failed;
+                  }
+
+                  auto entry = nlohmann::json( {} );
+                  entry["command"] = fmt::format( "exact_ltl {}", pending.at( result.index ) );
+                  entry["benchmark"] = pending.at( result.index );
+                  entry["status"] = copycat::job_status_to_string( status );
+                  entry["total_time"] = fmt::format( "{:8.2f}", result.time );
+                  log.append( entry );
+                } );
     }
   }
 
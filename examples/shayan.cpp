@@ -1,6 +1,7 @@
 #include <copycat/algorithms/ltl_evaluator.hpp>
 #include <copycat/algorithms/ltl_evaluator.hpp>
 #include <copycat/algorithms/sequential_simulation.hpp>
+#include <copycat/generators/trace_generator.hpp>
 #include <copycat/generators/waveform_generator.hpp>
 #include <copycat/io/ltl.hpp>
 #include <copycat/io/ltl_formula_reader.hpp>
@@ -10,71 +11,6 @@
 #include <lorina/aiger.hpp>
 #include <fmt/format.h>
 
-template<typename Ntk>
-class trace_generator
-{
-public:
-  explicit trace_generator( Ntk const& ntk, copycat::trace& tr )
-    : ntk( ntk )
-    , tr( tr )
-  {
-  }
-
-  void on_time_frame_start( uint32_t time_frame )
-  {
-    (void)time_frame;
-    data.clear();
-  }
-
-  void on_pi( uint32_t index, bool value )
-  {
-    assert( index < ntk.num_cis() + ntk.num_cos() );
-    int32_t const id = index + 1;
-    // data.emplace_back( value ? id : -id );
-    if ( value )
-      data.emplace_back( id );
-  }
-
-  void on_ri( uint32_t index, bool value )
-  {
-    assert( ntk.num_pis() + index < ntk.num_cis() + ntk.num_cos() );
-    int32_t const id = ntk.num_pis() + index + 1;
-    // data.emplace_back( value ? id : -id );
-    if ( value )
-      data.emplace_back( id );
-  }
-
-  void on_ro( uint32_t index, bool value )
-  {
-    assert( ntk.num_cis() + index < ntk.num_cis() + ntk.num_cos() );
-    int32_t const id = ntk.num_cis() + index + 1;
-    // data.emplace_back( value ? id : -id );
-    if ( value )
-      data.emplace_back( id );
-  }
-
-  void on_po( uint32_t index, bool value )
-  {
-    assert( ntk.num_cis() + ntk.num_registers() + index < ntk.num_cis() + ntk.num_cos() );
-    int32_t const id = ntk.num_cis() + ntk.num_registers() + index + 1;
-    // data.emplace_back( value ? id : -id );
-    if ( value )
-      data.emplace_back( id );
-  }
-
-  void on_time_frame_end( uint32_t time_frame )
-  {
-    (void)time_frame;
-    tr.emplace_prefix( data );
-  }
-
-protected:
-  Ntk const& ntk;
-  copycat::trace& tr;
-
-  std::vector<int32_t> data;
-}; /* trace_generator */
-
 std::vector<std::vector<bool>> load_stimuli( std::string const& filename )
 {
   std::vector<std::vector<bool>> stimuli;
@@ -212,8 +148,7 @@ int main( int argc, char* argv[] )
   names.emplace( "o3_Sport", ltl.create_variable() ); // 72
   names.emplace( "o4_Lport", ltl.create_variable() ); // 73
 
-  copycat::ltl_formula_reader reader( ltl, names );
-  if ( copycat::read_ltl( "LBDR.ltl", reader ) != copycat::return_code::success )
+  if ( copycat::read_ltl_formulas( std::string( "LBDR.ltl" ), ltl, names ) != copycat::return_code::success )
   {
     std::cout << "[e] could not parse LTL formulas\n";
     return -1;
@@ -224,7 +159,7 @@ int main( int argc, char* argv[] )
   /* simulate */
   copycat::stimuli_simulator sim( aig, stimuli );
   copycat::trace tr;
-  trace_generator printer( aig, tr );
+  copycat::trace_generator printer( aig, tr );
   simulate( aig, sim, stimuli.size(), printer );
   // tr.print();
 
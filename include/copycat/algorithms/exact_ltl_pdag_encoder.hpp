@@ -37,8 +37,12 @@
 #include <copycat/algorithms/exact_ltl_traits.hpp>
 #include <percy/partial_dag.hpp>
 #include <copycat/chain/chain.hpp>
+#include <copycat/utils/profiler.hpp>
 #include <bill/sat/types.hpp>
 #include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
@@ -309,6 +313,12 @@ struct exact_ltl_pdag_encoder_parameter
   /* traces */
   std::vector<std::pair<trace, bool>> traces;
 
+  /* operator weights (if non-empty, the cost of the chain is encoded) */
+  std::unordered_map<operator_opcode, uint32_t> weights;
+
+  /* records time and #variables/#clauses per phase (nullptr to disable) */
+  profiler* profile = nullptr;
+
   /* be verbose? */
   bool verbose = true;
 }; /* exact_ltl_pdag_encoder_paramter */
@@ -352,6 +362,12 @@ public:
     /* update internal parameters */
     _ps = ps;
     _num_nodes = ps.pd.nr_vertices();
+
+    if ( _ps.profile )
+    {
+      num_variables_counter = _ps.profile->counter( "#variables" );
+      num_clauses_counter = _ps.profile->counter( "#clauses" );
+    }
     _num_vertices = _ps.pd.nr_pi_fanins() + _num_nodes;
 
     if ( _ps.verbose )
@@ -361,22 +377,116 @@ public:
     assert( uint32_t( _ps.pd.nr_vertices() ) > 0u && "PD parameter required" );
     assert( _ps.num_propositions > 0u && "No atomic propositions specified" );
 
+    scoped_timer t( _ps.profile, "encode" );
+
     // print_partial_dag(); /* debug */
-    allocate_variables();
+    {
+      scoped_timer t2( _ps.profile, "allocate_variables" );
+      allocate_variables();
+    }
     // print_variables(); /* debug */
     create_clauses();
+
+    cost_lits.clear();
+    if ( !_ps.weights.empty() )
+    {
+      scoped_timer t2( _ps.profile, "cost" );
+      create_cost_clauses();
+    }
   }
 
-  chain<std::string, std::vector<int>> extract_chain()
+  /*! \brief Literal that is implied if the cost of the chain is at least `cost`
+   *
+   * The cost of a chain is the sum of the weights of its operators.
+   * Returns `std::nullopt` if no labeling reaches the cost; requires
+   * operator weights and `cost > 0`.
+   */
+  std::optional<bill::lit_type> cost_at_least( uint32_t cost ) const
+  {
+    assert( !_ps.weights.empty() && cost > 0u );
+    if ( cost > cost_lits.size() )
+      return std::nullopt;
+    return cost_lits[cost - 1u];
+  }
+
+  /*! \brief Restricts the cost of the chain to at most `max_cost`
+   *
+   * The bound is added as clause rather than as assumption: bounds
+   * only get tighter, and bill's solvers only solve again after the
+   * clauses changed.  Learned clauses are kept between tightenings.
+   */
+  void add_cost_bound( uint32_t max_cost )
+  {
+    if ( auto const l = cost_at_least( max_cost + 1u ) )
+      add_clause( std::vector{~*l} );
+  }
+
+  /*! \brief Returns the cost of the chain in the current model */
+  uint32_t extract_cost()
   {
-    /* get model */
     auto const model = _solver.get_model().model();
 
-    /* chain */
+    uint32_t cost = 0u;
+    for ( auto vertex_index = uint32_t( _ps.pd.nr_pi_fanins() ); vertex_index < _num_vertices; ++vertex_index )
+    {
+      auto const& ops = get_vertex_type( vertex_index ) == vertex_type::mixed ? mixed_operators : binary_operators;
+      for ( auto label_index = 0u; label_index < num_labels( vertex_index ); ++label_index )
+      {
+        if ( model.at( label( vertex_index, label_index ).variable() ) == bill::lbool_type::true_ )
+        {
+          cost += operator_weight( ops.at( label_index ) );
+          break;
+        }
+      }
+    }
+    return cost;
+  }
+
+  chain<std::string, std::vector<int>> extract_chain()
+  {
     chain<std::string, std::vector<int>> c;
+    extract_chain( c );
+    return c;
+  }
+
+  /*! \brief Extracts the chain of the current model into `c`
+   *
+   * The steps of `c` are replaced; its memory and the encoder's lookup
+   * tables are reused, so extracting many candidates into the same
+   * chain does not allocate per candidate.
+   */
+  void extract_chain( chain<std::string, std::vector<int>>& c )
+  {
+    scoped_timer t( _ps.profile, "extract_chain" );
+
+    /* get model */
+    auto const& model = _solver.get_model().model();
+
+    c.clear();
+    pi_to_step.clear();
+    node_to_step.assign( _ps.pd.nr_vertices(), -1 );
+
+    /* step of a pi, created on first use */
+    auto const pi_step = [&]( uint32_t vertex_index ){
+      /* get the label for this pi */
+      auto pi_index = 0u;
+      for ( auto label_index = 0u; label_index < num_labels( vertex_index ); ++label_index )
+      {
+        if ( model.at( label( vertex_index, label_index ).variable() ) == bill::lbool_type::true_ )
+        {
+          pi_index = label_index;
+          break;
+        }
+      }
+
+      if ( pi_index >= pi_to_step.size() )
+        pi_to_step.resize( pi_index + 1u, -1 );
 
-    std::unordered_map<uint32_t, uint32_t> pi_to_step;
-    std::unordered_map<uint32_t, uint32_t> node_to_step;
+      /* otherwise create a new step for the pi */
+      if ( pi_to_step[pi_index] < 0 )
+        pi_to_step[pi_index] = c.add_step( fmt::format( "x{}", pi_index ), {} );
+      return pi_to_step[pi_index];
+    };
 
     for ( auto i = 0; i < _ps.pd.nr_vertices(); ++i )
     {
@@ -386,108 +496,57 @@ public:
       auto const vertex_index = i + _ps.pd.nr_pi_fanins();
 
       /* get the label for this vertex_index */
-      std::string s = "";
+      operator_opcode op = operator_opcode::not_;
       for ( auto label_index = 0u; label_index < num_labels( vertex_index ); ++label_index )
       {
-        assert( get_vertex_type( vertex_index ) == vertex_type::mixed || get_vertex_type( vertex_index ) == vertex_type::binary );               
+        assert( get_vertex_type( vertex_index ) == vertex_type::mixed || get_vertex_type( vertex_index ) == vertex_type::binary );
         if ( model.at( label( vertex_index, label_index ).variable() ) == bill::lbool_type::true_ )
         {
           if ( get_vertex_type( vertex_index ) == vertex_type::mixed )
           {
-            s = operator_opcode_to_string( mixed_operators.at( label_index ) );
+            op = mixed_operators.at( label_index );
             break;
           }
           else if ( get_vertex_type( vertex_index ) == vertex_type::binary )
           {
-            s = operator_opcode_to_string( binary_operators.at( label_index ) );
+            op = binary_operators.at( label_index );
             break;
           }
         }
       }
 
-      std::vector<int> children;
+      std::array<int, 2u> children;
 
       /* left child */
       if ( pd_vertex[0u] == 0u )
       {
         /* map pi to vertex id in synthesis problem */
-        auto const vertex_index = zeroes[i];
-
-        /* get the label for this pi */
-        auto pi_index = 0u;
-        for ( auto label_index = 0u; label_index < num_labels( vertex_index ); ++label_index )
-        {
-          if ( model.at( label( vertex_index, label_index ).variable() ) == bill::lbool_type::true_ )
-          {
-            pi_index = label_index;
-            break;
-          }
-        }
-
-        /* pi_index has already a step then use it */
-        auto const it = pi_to_step.find( pi_index );
-        if ( it != pi_to_step.end() )
-        {
-          children.emplace_back( it->second );
-        }
-        else
-        {
-          /* otherwise create a new step for the pi */
-          auto const step_index = c.add_step( fmt::format( "x{}", pi_index ), {} );
-          children.emplace_back( step_index );
-          pi_to_step.emplace( pi_index, step_index );
-        }
+        children[0u] = pi_step( zeroes[i] );
       }
       else
       {
-        assert( node_to_step.find( pd_vertex[0u] - 1u ) != node_to_step.end() );
-        children.emplace_back( node_to_step.at( pd_vertex[0u] - 1u ) );
+        assert( node_to_step.at( pd_vertex[0u] - 1u ) >= 0 );
+        children[0u] = node_to_step.at( pd_vertex[0u] - 1u );
       }
 
       /* right child */
-      if ( s == "|" || s == "&" || s == "U" || s == "->" )
+      auto const num_children = operator_opcode_arity( op );
+      if ( num_children == 2u )
       {
         if ( pd_vertex[1u] == 0u )
         {
           /* map pi to vertex id in synthesis problem */
-          auto const vertex_index = zeroes[i] + ( pd_vertex[0u] == 0 );
-
-          /* get the label for this pi */
-          auto pi_index = 0u;
-          for ( auto label_index = 0u; label_index < num_labels( vertex_index ); ++label_index )
-          {
-            if ( model.at( label( vertex_index, label_index ).variable() ) == bill::lbool_type::true_ )
-            {
-              pi_index = label_index;
-              break;
-            }
-          }
-
-          /* pi_index has already a step then use it */
-          auto const it = pi_to_step.find( pi_index );
-          if ( it != pi_to_step.end() )
-          {
-            children.emplace_back( it->second );
-          }
-          else
-          {
-            /* otherwise create a new step for the pi */
-            auto const step_index = c.add_step( fmt::format( "x{}", pi_index ), {} );
-            children.emplace_back( step_index );
-            pi_to_step.emplace( pi_index, step_index );
-          }
+          children[1u] = pi_step( zeroes[i] + ( pd_vertex[0u] == 0 ) );
         }
         else
         {
-          assert( node_to_step.find( pd_vertex[1u] - 1u ) != node_to_step.end() );
-          children.emplace_back( node_to_step.at( pd_vertex[1u] - 1u ) );
+          assert( node_to_step.at( pd_vertex[1u] - 1u ) >= 0 );
+          children[1u] = node_to_step.at( pd_vertex[1u] - 1u );
         }
       }
 
-      auto const step_index = c.add_step( s, children );
-      node_to_step.emplace( i, step_index );
+      node_to_step[i] = c.add_step( operator_opcode_to_string( op ), children.begin(), children.begin() + num_children );
     }
-    return c;
   }
 
 private:
@@ -553,6 +612,8 @@ private:
 
     /* pre-allocate variables in solver */
     _solver.add_variables( tseytin_vars_begin );
+    if ( _ps.profile )
+      _ps.profile->count( num_variables_counter, tseytin_vars_begin );
   }
 
   /*! \brief Print variable layout (for debugging purpose only) */
@@ -616,6 +677,8 @@ private:
   /*! \brief Create clauses */
   void create_clauses()
   {
+    scoped_timer t( _ps.profile, "labels" );
+
     /* each node has to be labeled with exactly one label */
     for ( uint32_t vertex_index = 0u; vertex_index < _num_vertices; ++vertex_index )
     {
@@ -640,6 +703,7 @@ private:
     }
 
     /* propositions */
+    t.next( "propositions" );
     for ( auto trace_index = 0u; trace_index < _ps.traces.size(); ++trace_index )
     {
       for ( auto vertex_index = 0u; vertex_index < uint32_t(  _ps.pd.nr_pi_fanins() ); ++vertex_index )
@@ -673,6 +737,7 @@ private:
     }
 
     /* Boolean operators: NOT, AND, OR, IMPLIES */
+    t.next( "boolean_operators" );
     if ( std::find( std::begin( _ps.ops ), std::end( _ps.ops ), operator_opcode::not_ ) != std::end( _ps.ops ) )
     {
       for ( uint32_t trace_index = 0u; trace_index < _ps.traces.size(); ++trace_index )
@@ -885,6 +950,7 @@ private:
     }
 
     /* temporal operators: X, U, G, F */
+    t.next( "next" );
     if ( std::find( std::begin( _ps.ops ), std::end( _ps.ops ), operator_opcode::next_ ) != std::end( _ps.ops ) )
     {
       for ( uint32_t trace_index = 0u; trace_index < _ps.traces.size(); ++trace_index )
@@ -931,6 +997,7 @@ private:
     }
 
     /* eventually */
+    t.next( "eventually" );
     if ( std::find( std::begin( _ps.ops ), std::end( _ps.ops ), operator_opcode::eventually_ ) != std::end( _ps.ops ) )
     {
       for ( uint32_t trace_index = 0u; trace_index < _ps.traces.size(); ++trace_index )
@@ -985,6 +1052,7 @@ private:
     }
 
     /* globally */
+    t.next( "globally" );
     if ( std::find( std::begin( _ps.ops ), std::end( _ps.ops ), operator_opcode::globally_ ) != std::end( _ps.ops ) )
     {
       for ( uint32_t trace_index = 0u; trace_index < _ps.traces.size(); ++trace_index )
@@ -1039,6 +1107,7 @@ private:
     }
 
     /* operator: until */
+    t.next( "until" );
     if ( std::find( std::begin( _ps.ops ), std::end( _ps.ops ), operator_opcode::until_ ) != std::end( _ps.ops ) )
     {
       for ( uint32_t trace_index = 0u; trace_index < _ps.traces.size(); ++trace_index )
@@ -1121,6 +1190,7 @@ private:
     }
 
     /* traces */
+    t.next( "traces" );
     for ( auto trace_index = 0u; trace_index < _ps.traces.size(); ++trace_index )
     {
       if ( _ps.traces.at( trace_index ).second )
@@ -1134,6 +1204,81 @@ private:
     }
   }
 
+  /*! \brief Encode the cost of the chain as unary counter
+   *
+   * For each vertex, a unary vector holds the weight of its label; the
+   * vectors are merged pairwise by a totalizer whose i-th output is
+   * implied if the total cost is at least i + 1.
+   */
+  void create_cost_clauses()
+  {
+    std::vector<std::vector<bill::lit_type>> sums;
+    for ( auto vertex_index = uint32_t( _ps.pd.nr_pi_fanins() ); vertex_index < _num_vertices; ++vertex_index )
+    {
+      auto const& ops = get_vertex_type( vertex_index ) == vertex_type::mixed ? mixed_operators : binary_operators;
+
+      uint32_t max_weight = 0u;
+      for ( const auto& op : ops )
+        max_weight = std::max( max_weight, operator_weight( op ) );
+
+      std::vector<bill::lit_type> unary;
+      for ( auto k = 0u; k < max_weight; ++k )
+        unary.emplace_back( add_variable() );
+
+      for ( auto label_index = 0u; label_index < num_labels( vertex_index ); ++label_index )
+        for ( auto k = 0u; k < operator_weight( ops.at( label_index ) ); ++k )
+          add_clause( std::vector{~label( vertex_index, label_index ), unary[k]} );
+
+      if ( !unary.empty() )
+        sums.emplace_back( unary );
+    }
+
+    while ( sums.size() > 1u )
+    {
+      std::vector<std::vector<bill::lit_type>> merged;
+      for ( auto i = 0u; i + 1u < sums.size(); i += 2u )
+        merged.emplace_back( add_totalizer( sums[i], sums[i + 1u] ) );
+      if ( sums.size() % 2u == 1u )
+        merged.emplace_back( sums.back() );
+      sums = merged;
+    }
+
+    if ( !sums.empty() )
+      cost_lits = sums[0u];
+  }
+
+  /* merges two unary counters (only the direction sum >= k => r[k-1] is needed for upper bounds) */
+  std::vector<bill::lit_type> add_totalizer( std::vector<bill::lit_type> const& a, std::vector<bill::lit_type> const& b )
+  {
+    std::vector<bill::lit_type> r;
+    for ( auto k = 0u; k < a.size() + b.size(); ++k )
+      r.emplace_back( add_variable() );
+
+    for ( auto i = 0u; i <= a.size(); ++i )
+    {
+      for ( auto j = 0u; j <= b.size(); ++j )
+      {
+        if ( i + j == 0u )
+          continue;
+
+        std::vector<bill::lit_type> cl;
+        if ( i > 0u )
+          cl.emplace_back( ~a[i - 1u] );
+        if ( j > 0u )
+          cl.emplace_back( ~b[j - 1u] );
+        cl.emplace_back( r[i + j - 1u] );
+        add_clause( cl );
+      }
+    }
+    return r;
+  }
+
+  uint32_t operator_weight( operator_opcode op ) const
+  {
+    auto const it = _ps.weights.find( op );
+    return it != _ps.weights.end() ? it->second : 1u;
+  }
+
   /*! \brief Print the partial DAG (for debugging purpose only) */
   void print_partial_dag() const
   {
@@ -1298,6 +1443,8 @@ private:
 
   bill::lit_type add_variable( bill::lit_type::polarities pol = bill::lit_type::polarities::positive )
   {
+    if ( _ps.profile )
+      _ps.profile->count( num_variables_counter );
     return bill::lit_type( _solver.add_variable(), pol );
   }
 
@@ -1307,6 +1454,8 @@ private:
     //   std::cout << fmt::format("{}{} ", l.is_complemented() ? "~" : "", l.variable() );
     // std::cout << std::endl;
 
+    if ( _ps.profile )
+      _ps.profile->count( num_clauses_counter );
     _solver.add_clause( cl );
   }
 
@@ -1329,6 +1478,17 @@ private:
   std::vector<uint32_t> trace_offset;
   uint32_t trace_vars_begin = 0u;
   uint32_t tseytin_vars_begin = 0u;
+
+  /* cost_lits[k] is implied if the cost of the chain is at least k + 1 */
+  std::vector<bill::lit_type> cost_lits;
+
+  /* steps of pis and vertices during chain extraction */
+  std::vector<int32_t> pi_to_step;
+  std::vector<int32_t> node_to_step;
+
+  /* interned profiler counters */
+  profiler::counter_id num_variables_counter{0u};
+  profiler::counter_id num_clauses_counter{0u};
 }; /* exact_ltl_pdag_encoder */
 
 } /* namespace copycat */
@@ -32,6 +32,9 @@
 
 #pragma once
 
+#include <functional>
+#include <string>
+
 namespace copycat
 {
 
@@ -59,7 +62,7 @@ enum class operator_opcode : int32_t
   globally_   = 7u,
 }; /* operator_opcodes */
 
-std::string operator_opcode_to_string( operator_opcode const& opcode )
+inline std::string operator_opcode_to_string( operator_opcode const& opcode )
 {
   switch ( opcode )
   {
@@ -85,7 +88,7 @@ std::string operator_opcode_to_string( operator_opcode const& opcode )
   return "?";
 }
 
-uint32_t operator_opcode_arity( operator_opcode const& opcode )
+inline uint32_t operator_opcode_arity( operator_opcode const& opcode )
 {
   switch ( opcode )
   {
@@ -0,0 +1,318 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file ltl_batch_verifier.hpp
+  \brief Verify many LTL chains against a synthesis spec
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include "exact_ltl_traits.hpp"
+#include "ltl_chain_evaluator.hpp"
+#include "../io/ltl_synthesis_spec_reader.hpp"
+#include "../trace.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace copycat
+{
+
+struct ltl_batch_verifier_statistics
+{
+  /*! \brief Number of verified chains */
+  uint64_t num_chains{0u};
+
+  /*! \brief Number of chains that satisfy the spec */
+  uint64_t num_verified{0u};
+
+  /*! \brief Number of trace checks (a failing chain stops at the first failing trace) */
+  uint64_t num_trace_checks{0u};
+
+  /*! \brief Number of (subformula, trace) truth vectors computed */
+  uint64_t num_evaluations{0u};
+
+  /*! \brief Number of (subformula, trace) truth vectors reused */
+  uint64_t num_cache_hits{0u};
+}; /* ltl_batch_verifier_statistics */
+
+/*! \brief Verifies LTL chains against the traces of a synthesis spec
+ *
+ * A chain satisfies a spec if it holds on all good traces and on none
+ * of the bad traces.  The verifier is meant for checking many
+ * candidate chains against the same spec:
+ *
+ * - the values of all propositions are stored once as columns over
+ *   the positions of all traces,
+ * - the steps of all chains are hash-consed by structure (opcode and
+ *   canonical fanins), such that a subformula shared by several chains
+ *   has a single truth vector, and
+ * - truth vectors are computed lazily one trace at a time; a chain is
+ *   rejected at the first trace it fails on, and that trace is checked
+ *   first for the next chain.
+ *
+ * The truth vectors are kept until `clear_cache` is called.
+ */
+class ltl_batch_verifier
+{
+public:
+  using chain_type = ltl_chain_evaluator::chain_type;
+  using opcode = ltl_chain_evaluator::opcode;
+
+protected:
+  struct node_key
+  {
+    opcode op;
+    uint32_t fanin0;
+    uint32_t fanin1;
+    int32_t proposition;
+
+    bool operator==( node_key const& other ) const
+    {
+      return op == other.op && fanin0 == other.fanin0 && fanin1 == other.fanin1 && proposition == other.proposition;
+    }
+  }; /* node_key */
+
+  struct node_key_hash
+  {
+    std::size_t operator()( node_key const& key ) const
+    {
+      uint64_t seed = 0u;
+      detail::hash_combine( seed, uint32_t( key.op ) );
+      detail::hash_combine( seed, key.fanin0 );
+      detail::hash_combine( seed, key.fanin1 );
+      detail::hash_combine( seed, key.proposition );
+      return seed;
+    }
+  }; /* node_key_hash */
+
+  struct node
+  {
+    node_key key;
+    std::vector<uint8_t> values;
+    std::vector<bool> computed;
+  }; /* node */
+
+  struct trace_info
+  {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t loop_start;
+    bool is_lasso;
+    bool is_good;
+  }; /* trace_info */
+
+public:
+  explicit ltl_batch_verifier( ltl_synthesis_spec const& spec )
+  {
+    for ( const auto& t : spec.good_traces )
+      add_trace( t, true );
+    for ( const auto& t : spec.bad_traces )
+      add_trace( t, false );
+
+    /* proposition columns */
+    uint32_t num_propositions = spec.num_propositions;
+    for ( const auto& t : spec.good_traces )
+      num_propositions = std::max( num_propositions, t.count_propositions() );
+    for ( const auto& t : spec.bad_traces )
+      num_propositions = std::max( num_propositions, t.count_propositions() );
+
+    columns.assign( ( num_propositions + 1u ) * total_length, 0u );
+    auto fill = [&]( trace const& t, trace_info const& info ){
+      for ( auto i = 0u; i < info.length; ++i )
+      {
+        for ( const auto& p : t._data[i] )
+        {
+          if ( p > 0 )
+            columns[p * total_length + info.offset + i] = 1u;
+        }
+      }
+    };
+    for ( auto i = 0u; i < spec.good_traces.size(); ++i )
+      fill( spec.good_traces[i], traces[i] );
+    for ( auto i = 0u; i < spec.bad_traces.size(); ++i )
+      fill( spec.bad_traces[i], traces[spec.good_traces.size() + i] );
+    this->num_propositions = num_propositions;
+  }
+
+  /*! \brief Returns true if and only if the chain satisfies the spec */
+  bool verify( chain_type const& c )
+  {
+    ++st.num_chains;
+
+    /* map chain steps to canonical nodes */
+    steps.clear();
+    c.foreach_input( [&]( uint32_t index ){
+        steps.emplace_back( get_or_create( {opcode::proposition, 0u, 0u, int32_t( index )} ) );
+      });
+    c.foreach_step( [&]( auto const& step, uint32_t index ){
+        node_key key;
+        key.op = ltl_chain_evaluator::label_to_opcode( c.label_at( index ), key.proposition );
+        key.fanin0 = step.size() > 0u ? steps[step[0u] - 1] : 0u;
+        key.fanin1 = step.size() > 1u ? steps[step[1u] - 1] : 0u;
+        if ( ( key.op == opcode::and_ || key.op == opcode::or_ ) && key.fanin0 > key.fanin1 )
+          std::swap( key.fanin0, key.fanin1 );
+        steps.emplace_back( get_or_create( key ) );
+      });
+
+    if ( steps.empty() )
+      return false;
+
+    /* check the last failing trace first */
+    if ( !check_trace( last_failing_trace ) )
+      return false;
+
+    for ( auto k = 0u; k < traces.size(); ++k )
+    {
+      if ( k != last_failing_trace && !check_trace( k ) )
+      {
+        last_failing_trace = k;
+        return false;
+      }
+    }
+
+    ++st.num_verified;
+    return true;
+  }
+
+  /*! \brief Verifies a sequence of chains */
+  std::vector<bool> verify( std::vector<chain_type> const& chains )
+  {
+    std::vector<bool> result;
+    result.reserve( chains.size() );
+    for ( const auto& c : chains )
+      result.emplace_back( verify( c ) );
+    return result;
+  }
+
+  /*! \brief Releases all memoized truth vectors */
+  void clear_cache()
+  {
+    nodes.clear();
+    node_index.clear();
+  }
+
+  /*! \brief Returns the number of distinct subformulas seen so far */
+  uint32_t num_nodes() const
+  {
+    return nodes.size();
+  }
+
+  ltl_batch_verifier_statistics const& statistics() const
+  {
+    return st;
+  }
+
+protected:
+  void add_trace( trace const& t, bool is_good )
+  {
+    trace_info info;
+    info.offset = total_length;
+    info.length = t.length();
+    info.loop_start = t.prefix_length();
+    info.is_lasso = !t.is_finite();
+    info.is_good = is_good;
+    traces.emplace_back( info );
+    total_length += info.length;
+  }
+
+  uint32_t get_or_create( node_key const& key )
+  {
+    auto const it = node_index.find( key );
+    if ( it != node_index.end() )
+      return it->second;
+
+    auto const index = uint32_t( nodes.size() );
+    nodes.emplace_back( node{key, std::vector<uint8_t>( total_length, 0u ), std::vector<bool>( traces.size(), false )} );
+    node_index.emplace( key, index );
+    return index;
+  }
+
+  /* returns true if and only if the chain's output value on trace k matches its polarity */
+  bool check_trace( uint32_t k )
+  {
+    if ( k >= traces.size() )
+      return true;
+
+    ++st.num_trace_checks;
+    auto const& info = traces[k];
+    if ( info.length == 0u )
+      return !info.is_good;
+
+    for ( const auto& s : steps )
+      compute( s, info, k );
+
+    return bool( nodes[steps.back()].values[info.offset] ) == info.is_good;
+  }
+
+  void compute( uint32_t index, trace_info const& info, uint32_t k )
+  {
+    auto& n = nodes[index];
+    if ( n.computed[k] )
+    {
+      ++st.num_cache_hits;
+      return;
+    }
+    ++st.num_evaluations;
+
+    auto* v = &n.values[info.offset];
+    if ( n.key.op == opcode::proposition )
+    {
+      if ( uint32_t( n.key.proposition ) <= num_propositions )
+        std::memcpy( v, &columns[n.key.proposition * total_length + info.offset], info.length );
+    }
+    else
+    {
+      auto const* a = &nodes[n.key.fanin0].values[info.offset];
+      auto const* b = &nodes[n.key.fanin1].values[info.offset];
+      ltl_chain_evaluator::compute_operator( n.key.op, v, a, b, info.length, info.loop_start, info.is_lasso );
+    }
+    n.computed[k] = true;
+  }
+
+protected:
+  std::vector<trace_info> traces;
+  uint32_t total_length{0u};
+  uint32_t num_propositions{0u};
+
+  /* value of proposition p in position i at p * total_length + i */
+  std::vector<uint8_t> columns;
+
+  std::vector<node> nodes;
+  std::unordered_map<node_key, uint32_t, node_key_hash> node_index;
+
+  /* canonical nodes of the steps of the current chain */
+  std::vector<uint32_t> steps;
+  uint32_t last_failing_trace{0u};
+
+  ltl_batch_verifier_statistics st;
+}; /* ltl_batch_verifier */
+
+} /* namespace copycat */
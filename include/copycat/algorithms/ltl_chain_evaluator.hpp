@@ -0,0 +1,275 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file ltl_chain_evaluator.hpp
+  \brief Evaluate LTL chains on lasso traces
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include "ltl_lasso_kernels.hpp"
+#include "../chain/chain.hpp"
+#include "../trace.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace copycat
+{
+
+/*! \brief Evaluates an LTL chain on traces
+ *
+ * Translates the labels of a chain (`x<k>` for proposition k+1, `~`,
+ * `&`, `|`, `->`, `X`, `F`, `G`, and `U`) once into opcodes and then
+ * evaluates the chain bottom-up: for each step, a truth vector over all
+ * positions of the trace is computed from the truth vectors of its
+ * fanins.  The temporal operators are computed by backward passes over
+ * the trace; on the loop of a lasso, the fixpoints of `F`, `G`, and `U`
+ * are obtained with at most two passes.  Thus, the evaluation of a
+ * chain with n steps on a trace of length l takes O(n * l) time.
+ *
+ * A trace with an empty suffix is interpreted as a finite trace, on
+ * which `X` is false in the last position.
+ */
+class ltl_chain_evaluator
+{
+public:
+  using chain_type = chain<std::string, std::vector<int>>;
+
+  enum class opcode : uint8_t
+  {
+    proposition,
+    not_,
+    and_,
+    or_,
+    implies_,
+    next_,
+    eventually_,
+    globally_,
+    until_,
+  }; /* opcode */
+
+  struct instruction
+  {
+    opcode op;
+    uint32_t fanin0;
+    uint32_t fanin1;
+    int32_t proposition;
+  }; /* instruction */
+
+public:
+  explicit ltl_chain_evaluator( chain_type const& c )
+  {
+    /* node 0 is unused; inputs are propositions 1, ..., #inputs */
+    program.resize( c.length() + 1u );
+    c.foreach_input( [&]( uint32_t index ){
+        program[index] = {opcode::proposition, 0u, 0u, int32_t( index )};
+      });
+
+    c.foreach_step( [&]( auto const& step, uint32_t index ){
+        auto& ins = program[index];
+        auto const& label = c.label_at( index );
+        ins.fanin0 = step.size() > 0u ? step[0u] : 0u;
+        ins.fanin1 = step.size() > 1u ? step[1u] : 0u;
+
+        ins.op = label_to_opcode( label, ins.proposition );
+      });
+  }
+
+  /*! \brief Returns the truth value of the chain in the first position of the trace */
+  bool evaluate( trace const& t ) const
+  {
+    return evaluate( t, program.size() - 1u );
+  }
+
+  /*! \brief Returns the truth value of a step in the first position of the trace */
+  bool evaluate( trace const& t, uint32_t node ) const
+  {
+    if ( t.length() == 0u || node == 0u )
+      return false;
+
+    compute( t );
+    return values[node * length + 0u];
+  }
+
+  /*! \brief Returns the truth values of a step in all positions of the last evaluated trace */
+  std::vector<bool> truth_vector( uint32_t node ) const
+  {
+    return std::vector<bool>( values.begin() + node * length, values.begin() + ( node + 1u ) * length );
+  }
+
+  uint32_t num_nodes() const
+  {
+    return program.size();
+  }
+
+  /*! \brief Maps a chain label to an opcode
+   *
+   * For propositions, `proposition` is set to the proposition id.
+   */
+  static opcode label_to_opcode( std::string const& label, int32_t& proposition )
+  {
+    proposition = 0;
+    if ( label.size() >= 1u && label[0u] == 'x' )
+    {
+      proposition = std::atoi( label.c_str() + 1u ) + 1;
+      return opcode::proposition;
+    }
+    else if ( label == "~" || label == "!" )
+      return opcode::not_;
+    else if ( label == "&" )
+      return opcode::and_;
+    else if ( label == "|" )
+      return opcode::or_;
+    else if ( label == "->" )
+      return opcode::implies_;
+    else if ( label == "X" )
+      return opcode::next_;
+    else if ( label == "F" )
+      return opcode::eventually_;
+    else if ( label == "G" )
+      return opcode::globally_;
+    else if ( label == "U" )
+      return opcode::until_;
+
+    std::cerr << "[e] unsupported label " << label << std::endl;
+    assert( false );
+    return opcode::proposition;
+  }
+
+  /*! \brief Computes the truth vector of an operator from the truth vectors of its operands
+   *
+   * `v`, `a`, and `b` point to truth vectors of length `length` of a
+   * trace whose loop starts at `loop_start` (if `is_lasso`).
+   */
+  static void compute_operator( opcode op, uint8_t* v, uint8_t const* a, uint8_t const* b,
+                                uint32_t length, uint32_t loop_start, bool is_lasso )
+  {
+    switch ( op )
+    {
+    case opcode::proposition:
+      assert( false && "propositions are not operators" );
+      break;
+
+    case opcode::not_:
+      for ( auto i = 0u; i < length; ++i )
+        v[i] = !a[i];
+      break;
+
+    case opcode::and_:
+      for ( auto i = 0u; i < length; ++i )
+        v[i] = a[i] & b[i];
+      break;
+
+    case opcode::or_:
+      for ( auto i = 0u; i < length; ++i )
+        v[i] = a[i] | b[i];
+      break;
+
+    case opcode::implies_:
+      for ( auto i = 0u; i < length; ++i )
+        v[i] = uint8_t( !a[i] ) | b[i];
+      break;
+
+    case opcode::next_:
+      lasso_next( length, loop_start, is_lasso,
+                  [&]( uint32_t i ){ return a[i] != 0u; },
+                  [&]( uint32_t i, bool value ){ v[i] = value; } );
+      break;
+
+    case opcode::eventually_:
+      /* F a = true U a */
+      until( v, nullptr, a, length, loop_start, is_lasso );
+      break;
+
+    case opcode::globally_:
+      /* G a = !F !a */
+      for ( auto i = 0u; i < length; ++i )
+        v[i] = !a[i];
+      until( v, nullptr, v, length, loop_start, is_lasso );
+      for ( auto i = 0u; i < length; ++i )
+        v[i] = !v[i];
+      break;
+
+    case opcode::until_:
+      until( v, a, b, length, loop_start, is_lasso );
+      break;
+    }
+  }
+
+protected:
+  void compute( trace const& t ) const
+  {
+    length = t.length();
+    auto const loop_start = uint32_t( t.prefix_length() );
+    bool const is_lasso = !t.is_finite();
+
+    values.assign( program.size() * length, 0u );
+    for ( auto n = 1u; n < program.size(); ++n )
+    {
+      auto const& ins = program[n];
+      auto* v = &values[n * length];
+      auto const* a = &values[ins.fanin0 * length];
+      auto const* b = &values[ins.fanin1 * length];
+
+      if ( ins.op == opcode::proposition )
+      {
+        for ( auto i = 0u; i < length; ++i )
+        {
+          auto const& props = t._data[i];
+          v[i] = std::find( props.begin(), props.end(), ins.proposition ) != props.end();
+        }
+      }
+      else
+      {
+        compute_operator( ins.op, v, a, b, length, loop_start, is_lasso );
+      }
+    }
+  }
+
+  /* computes v = a U b (a == nullptr means true); v may alias b */
+  static void until( uint8_t* v, uint8_t const* a, uint8_t const* b, uint32_t length, uint32_t loop_start, bool is_lasso )
+  {
+    lasso_until( length, loop_start, is_lasso,
+                 [&]( uint32_t i ){ return !a || a[i] != 0u; },
+                 [&]( uint32_t i ){ return b[i] != 0u; },
+                 [&]( uint32_t i, bool value ){ v[i] = value; } );
+  }
+
+protected:
+  std::vector<instruction> program;
+
+  /* truth values of all nodes in all positions of the last evaluated trace */
+  mutable std::vector<uint8_t> values;
+  mutable uint32_t length{0u};
+}; /* ltl_chain_evaluator */
+
+} /* namespace copycat */
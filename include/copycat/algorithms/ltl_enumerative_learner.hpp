@@ -0,0 +1,379 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file ltl_enumerative_learner.hpp
+  \brief Bottom-up enumerative LTL learner
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include "exact_ltl_traits.hpp"
+#include "ltl_satisfiability_filter.hpp"
+#include "ltl_signature_index.hpp"
+#include "trace_signature.hpp"
+#include "../chain/chain.hpp"
+#include "../io/ltl_synthesis_spec_reader.hpp"
+#include "../ltl.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace copycat
+{
+
+struct ltl_enumerative_learner_parameters
+{
+  /*! \brief Maximum formula size (number of propositions and operators) */
+  uint32_t max_size = 6u;
+
+  /*! \brief Maximum number of distinct candidates kept */
+  uint64_t max_candidates = 1000000u;
+
+  /*! \brief Discard candidates proven unsatisfiable or valid
+   *
+   * Such candidates cannot separate good from bad traces, but they
+   * may be useful subformulas if the operators cannot express the
+   * constants otherwise.
+   *
+   * The verdicts assume infinite traces, so the filter is only used if
+   * all traces of the spec are lassos.
+   */
+  bool filter_trivial_candidates = false;
+
+  bool verbose = false;
+}; /* ltl_enumerative_learner_parameters */
+
+struct ltl_enumerative_learner_statistics
+{
+  /*! \brief Number of enumerated candidates */
+  uint64_t num_candidates{0u};
+
+  /*! \brief Number of candidates pruned as equivalent on the traces */
+  uint64_t num_pruned{0u};
+
+  /*! \brief Number of candidates discarded as unsatisfiable or valid */
+  uint64_t num_filtered{0u};
+
+  /*! \brief Largest size whose candidates have been enumerated completely */
+  uint32_t max_size_explored{0u};
+}; /* ltl_enumerative_learner_statistics */
+
+/*! \brief Learns a smallest LTL formula separating good from bad traces
+ *
+ * Enumerates formulas bottom-up by increasing size, where the size is
+ * the number of propositions and operators of the formula tree.  Each
+ * candidate is hash-consed in an `ltl_formula_store` and looked up in
+ * an `ltl_signature_index`; a candidate whose signature has been seen
+ * before is observationally equivalent on the spec and is pruned.  The
+ * first candidate true on all good and false on all bad traces is
+ * returned.
+ *
+ * Only the operators of the spec are used.  Proposition `p` of the
+ * traces is the variable with index `p - 1` of the store.
+ */
+class ltl_enumerative_learner
+{
+public:
+  using ltl_formula = ltl_formula_store::ltl_formula;
+  using chain_type = chain<std::string, std::vector<int>>;
+
+protected:
+  struct candidate
+  {
+    ltl_formula formula;
+    operator_opcode op;
+    int32_t proposition; /* > 0 for propositions */
+    uint32_t fanin0;
+    uint32_t fanin1;
+    uint32_t size;
+  }; /* candidate */
+
+public:
+  explicit ltl_enumerative_learner( ltl_formula_store& ltl, ltl_synthesis_spec const& spec,
+                                    ltl_enumerative_learner_parameters const& ps = {} )
+    : ltl( ltl )
+    , ps( ps )
+    , index( ltl, spec )
+    , filter( ltl )
+    , use_filter( ps.filter_trivial_candidates && !spec.good_traces.empty() && !spec.bad_traces.empty() &&
+                  all_infinite( spec.good_traces ) && all_infinite( spec.bad_traces ) )
+  {
+    ops = spec.operators;
+    if ( ops.empty() )
+    {
+      ltl_synthesis_spec defaults;
+      ensure_default_operators( defaults );
+      ops = defaults.operators;
+    }
+
+    while ( ltl.num_variables() < index.layout().num_propositions() )
+      ltl.create_variable();
+  }
+
+  /*! \brief Returns a separating formula of at most `max_size` if one exists */
+  std::optional<ltl_formula> run()
+  {
+    candidates.clear();
+    signatures.clear();
+    index.clear();
+    by_size.assign( ps.max_size + 1u, {} );
+    result = std::nullopt;
+
+    for ( auto size = 1u; size <= ps.max_size; ++size )
+    {
+      if ( ps.verbose )
+        std::cout << fmt::format( "[i] enumerate formulas of size {}\n", size );
+
+      if ( enumerate( size ) )
+        return candidates[*result].formula;
+
+      if ( candidates.size() >= ps.max_candidates )
+        break;
+
+      st.max_size_explored = size;
+    }
+    return std::nullopt;
+  }
+
+  /*! \brief Returns the size of the formula found by the last run */
+  uint32_t size() const
+  {
+    return result ? candidates[*result].size : 0u;
+  }
+
+  /*! \brief Returns the formula found by the last run as a chain
+   *
+   * Identical subformulas are shared, so the chain may have fewer
+   * steps than the size of the formula.
+   */
+  chain_type get_chain() const
+  {
+    assert( result );
+    chain_type c;
+    std::unordered_map<uint32_t, int> steps;
+    add_steps( c, *result, steps );
+    return c;
+  }
+
+  ltl_enumerative_learner_statistics const& statistics() const
+  {
+    return st;
+  }
+
+  ltl_satisfiability_filter_statistics const& filter_statistics() const
+  {
+    return filter.statistics();
+  }
+
+protected:
+  static bool all_infinite( std::vector<trace> const& traces )
+  {
+    return std::all_of( std::begin( traces ), std::end( traces ),
+                        []( trace const& t ){ return !t.is_finite(); } );
+  }
+
+  bool enumerate( uint32_t size )
+  {
+    if ( size == 1u )
+    {
+      for ( auto p = 1u; p <= index.layout().num_propositions(); ++p )
+      {
+        if ( add_candidate( {ltl.variable_at( p - 1u ), operator_opcode::not_, int32_t( p ), 0u, 0u, 1u},
+                            index.layout().proposition( p ) ) )
+          return true;
+      }
+      return false;
+    }
+
+    for ( const auto& op : ops )
+    {
+      if ( operator_opcode_arity( op ) == 1u )
+      {
+        auto const& children = by_size[size - 1u];
+        for ( auto k = 0u; k < children.size(); ++k )
+        {
+          auto const a = children[k];
+          if ( try_operator( op, a, 0u, size ) )
+            return true;
+          if ( candidates.size() >= ps.max_candidates )
+            return false;
+        }
+      }
+      else
+      {
+        bool const commutative = op == operator_opcode::and_ || op == operator_opcode::or_;
+        for ( auto i = 1u; i + 1u < size; ++i )
+        {
+          auto const j = size - 1u - i;
+          if ( commutative && i > j )
+            break;
+
+          for ( auto ka = 0u; ka < by_size[i].size(); ++ka )
+          {
+            for ( auto kb = ( commutative && i == j ) ? ka + 1u : 0u; kb < by_size[j].size(); ++kb )
+            {
+              if ( try_operator( op, by_size[i][ka], by_size[j][kb], size ) )
+                return true;
+              if ( candidates.size() >= ps.max_candidates )
+                return false;
+            }
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  bool try_operator( operator_opcode op, uint32_t a, uint32_t b, uint32_t size )
+  {
+    auto sig = index.layout().compute( op, signatures[a], signatures[b] );
+    if ( index.find( sig ) )
+    {
+      ++st.num_candidates;
+      ++st.num_pruned;
+      return false;
+    }
+
+    auto const fa = candidates[a].formula;
+    auto const fb = candidates[b].formula;
+
+    ltl_formula f;
+    switch ( op )
+    {
+    case operator_opcode::not_:
+      f = !fa;
+      break;
+    case operator_opcode::and_:
+      f = ltl.create_and( fa, fb );
+      break;
+    case operator_opcode::or_:
+      f = ltl.create_or( fa, fb );
+      break;
+    case operator_opcode::implies_:
+      f = ltl.create_or( !fa, fb );
+      break;
+    case operator_opcode::next_:
+      f = ltl.create_next( fa );
+      break;
+    case operator_opcode::eventually_:
+      f = ltl.create_eventually( fa );
+      break;
+    case operator_opcode::globally_:
+      f = ltl.create_globally( fa );
+      break;
+    case operator_opcode::until_:
+      f = ltl.create_until( fa, fb );
+      break;
+    }
+
+    return add_candidate( {f, op, 0, a, b, size}, std::move( sig ) );
+  }
+
+  bool add_candidate( candidate const& c, trace_signature sig )
+  {
+    ++st.num_candidates;
+
+    /* trivial formulas separate nothing unless there are only good or only bad traces */
+    if ( use_filter && filter.is_trivial( c.formula ) )
+    {
+      ++st.num_filtered;
+      return false;
+    }
+
+    if ( !index.insert( sig, c.formula, c.size ) )
+    {
+      ++st.num_pruned;
+      return false;
+    }
+
+    auto const id = uint32_t( candidates.size() );
+    candidates.emplace_back( c );
+    by_size[c.size].emplace_back( id );
+
+    bool const found = index.layout().separates( sig );
+    signatures.emplace_back( std::move( sig ) );
+    if ( found )
+    {
+      result = id;
+      if ( ps.verbose )
+        std::cout << fmt::format( "[i] found separating formula of size {} after {} candidates\n",
+                                  c.size, st.num_candidates );
+    }
+    return found;
+  }
+
+  int add_steps( chain_type& c, uint32_t id, std::unordered_map<uint32_t, int>& steps ) const
+  {
+    auto const it = steps.find( id );
+    if ( it != steps.end() )
+      return it->second;
+
+    auto const& cand = candidates[id];
+    int step;
+    if ( cand.proposition > 0 )
+    {
+      step = c.add_step( fmt::format( "x{}", cand.proposition - 1 ), {} );
+    }
+    else if ( operator_opcode_arity( cand.op ) == 1u )
+    {
+      auto const a = add_steps( c, cand.fanin0, steps );
+      step = c.add_step( operator_opcode_to_string( cand.op ), { a } );
+    }
+    else
+    {
+      auto const a = add_steps( c, cand.fanin0, steps );
+      auto const b = add_steps( c, cand.fanin1, steps );
+      step = c.add_step( operator_opcode_to_string( cand.op ), { a, b } );
+    }
+
+    steps.emplace( id, step );
+    return step;
+  }
+
+protected:
+  ltl_formula_store& ltl;
+  ltl_enumerative_learner_parameters const ps;
+  ltl_signature_index index;
+  ltl_satisfiability_filter filter;
+  bool const use_filter;
+  std::vector<operator_opcode> ops;
+
+  std::vector<candidate> candidates;
+  std::vector<trace_signature> signatures;
+
+  /* candidates by size */
+  std::vector<std::vector<uint32_t>> by_size;
+
+  std::optional<uint32_t> result;
+  ltl_enumerative_learner_statistics st;
+}; /* ltl_enumerative_learner */
+
+} /* namespace copycat */
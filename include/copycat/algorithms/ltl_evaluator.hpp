@@ -32,11 +32,15 @@
 
 #pragma once
 
+#include "ltl_chain_evaluator.hpp"
 #include "../ltl.hpp"
 #include "../trace.hpp"
-#include "../logic/bool3.hpp"
+#include "../logic/bool3_vector.hpp"
+#include "../logic/bool5_vector.hpp"
 #include "../utils/extended_inttype.hpp"
 #include <iostream>
+#include <unordered_map>
+#include <vector>
 
 namespace copycat
 {
@@ -51,7 +55,17 @@ public:
   explicit default_ltl_evaluator() = delete;
 }; /* default_ltl_evaluator */
 
-/*! \brief LTL evaluator for finite traces using three-valued logic */
+/*! \brief LTL evaluator for finite traces using three-valued logic
+ *
+ * A temporal operator that looks beyond the end of the trace is
+ * inconclusive, i.e., X, F, U, and R are inconclusive in the last
+ * position of the trace.  The values of all subformulas in all
+ * positions are computed bottom-up over the formula DAG as packed
+ * `bool3_vector`s, such that the Boolean operators are word-parallel
+ * meets and joins and each temporal operator is one backward pass over
+ * the words of the trace.  Variable `k` of the store is proposition
+ * `k + 1` of the trace.
+ */
 class ltl_finite_trace_evaluator
 {
 public:
@@ -61,7 +75,7 @@ public:
   using result_type = bool3;
 
 public:
-  explicit ltl_finite_trace_evaluator( ltl_formula_store& ltl )
+  explicit ltl_finite_trace_evaluator( ltl_formula_store const& ltl )
     : ltl( ltl )
   {
   }
@@ -69,107 +83,383 @@ public:
   bool3 evaluate_formula( formula const& f, trace const& t, uint32_t pos ) const
   {
     assert( t.is_finite() && "finite trace evaluator only looks at the prefix of the trace" );
+    if ( pos >= t.length() )
+      return inconclusive3;
 
-    /* negation */
-    if ( ltl.is_complemented( f ) )
-    {
-      return !evaluate_formula( !f, t, pos );
-    }
+    auto const& v = evaluate_all( ltl.get_node( f ), t );
+    return ltl.is_complemented( f ) ? !v[pos] : v[pos];
+  }
 
-    assert( !ltl.is_complemented( f ) );
-    auto const n = ltl.get_node( f );
+  /*! \brief Returns the values of node `n` in all positions of `t` */
+  bool3_vector const& evaluate_all( node const& n, trace const& t ) const
+  {
+    compute( n, t );
+    return values.at( n );
+  }
 
-    /* constant */
-    if ( ltl.is_constant( n ) )
-    {
-      return evaluate_constant( n );
-    }
-    /* variable */
-    else if ( ltl.is_variable( n ) )
-    {
-      return evaluate_variable( n, t, pos );
-    }
-    /* or */
-    else if ( ltl.is_or( n ) )
-    {
-      return evaluate_or( n, t, pos );
-    }
-    /* next */
-    else if ( ltl.is_next( n ) )
-    {
-      return evaluate_next( n, t, pos );
-    }
-    /* until */
-    else if ( ltl.is_until( n ) )
-    {
-      return evaluate_until( n, t, pos );
-    }
-    else if ( ltl.is_eventually( n ) )
+protected:
+  bool3_vector fanin_values( formula const& fi ) const
+  {
+    auto const& v = values.at( ltl.get_node( fi ) );
+    return ltl.is_complemented( fi ) ? !v : v;
+  }
+
+  /* a U b, inconclusive in the last position */
+  static bool3_vector until( bool3_vector a, bool3_vector b )
+  {
+    /* ? U ? is inconclusive, independent of the value after the end */
+    if ( a.size() > 0u )
     {
-      assert( false && "not implemented" );
+      a.set( a.size() - 1u, inconclusive3 );
+      b.set( b.size() - 1u, inconclusive3 );
     }
-    else
+    return bool3_vector::until( a, b, inconclusive3 );
+  }
+
+  void compute( node root, trace const& t ) const
+  {
+    values.clear();
+
+    uint32_t const length = t.length();
+
+    std::unordered_map<node, int32_t> variable_to_proposition;
+    for ( auto k = 0u; k < ltl.num_variables(); ++k )
+      variable_to_proposition.emplace( ltl.get_node( ltl.variable_at( k ) ), int32_t( k + 1u ) );
+
+    /* post-order traversal of the cone of root */
+    std::vector<std::pair<node, bool>> stack = { { root, false } };
+    while ( !stack.empty() )
     {
-      std::cerr << "[e] unknown operator" << std::endl;
-      return inconclusive3;
+      auto const [n, expanded] = stack.back();
+      stack.pop_back();
+      if ( values.find( n ) != values.end() )
+        continue;
+
+      std::array<formula, 2u> fanins;
+      bool const is_leaf = ltl.is_constant( n ) || ltl.is_variable( n );
+      if ( !is_leaf )
+        ltl.foreach_fanin( n, [&]( auto const& fi, auto i ){ fanins[i] = fi; } );
+
+      if ( !expanded && !is_leaf )
+      {
+        stack.emplace_back( n, true );
+        stack.emplace_back( ltl.get_node( fanins[0u] ), false );
+        stack.emplace_back( ltl.get_node( fanins[1u] ), false );
+        continue;
+      }
+
+      bool3_vector v( length );
+      if ( ltl.is_variable( n ) )
+      {
+        auto const p = variable_to_proposition.at( n );
+        for ( auto i = 0u; i < length; ++i )
+          v.set( i, t.is_true( i, p ) );
+      }
+      else if ( !ltl.is_constant( n ) )
+      {
+        auto const a = fanin_values( fanins[0u] );
+        auto const b = fanin_values( fanins[1u] );
+        if ( ltl.is_and( n ) )
+          v = a & b;
+        else if ( ltl.is_or( n ) )
+          v = a | b;
+        else if ( ltl.is_next( n ) )
+          v = a.shift_down( inconclusive3 );
+        else if ( ltl.is_eventually( n ) )
+          v = until( bool3_vector( length, true ), a );
+        else if ( ltl.is_until( n ) )
+          v = until( a, b );
+        else
+        {
+          /* a R b = !( !a U !b ) */
+          assert( ltl.is_releases( n ) );
+          v = !until( !a, !b );
+        }
+      }
+      values.emplace( n, std::move( v ) );
     }
   }
 
 protected:
-  bool3 evaluate_constant( node const& n ) const
+  ltl_formula_store const& ltl;
+
+  /* value vectors of the uncomplemented nodes of the last evaluated cone */
+  mutable std::unordered_map<node, bool3_vector> values;
+}; /* ltl_finite_trace_evaluator */
+
+/*! \brief LTL evaluator for finite traces using five-valued RV-LTL semantics
+ *
+ * After the end of the trace, X, F, and U are presumably false and G
+ * and R are presumably true, such that truncated traces still yield a
+ * useful verdict.  A value is definite if the trace already determines
+ * it (e.g., `F a` once `a` has been observed, `G a` once `!a` has been
+ * observed); otherwise the presumable value at the end of the trace
+ * propagates backwards (e.g., `F a` is presumably false in every
+ * position if `a` is never observed).
+ *
+ * The values of all subformulas in all positions are computed
+ * bottom-up over the formula DAG as packed `bool5_vector`s; each
+ * temporal operator is one word-parallel backward pass over the trace.
+ * Variable `k` of the store is proposition `k + 1` of the trace.
+ *
+ * The time steps of a lasso (prefix followed by one copy of the
+ * suffix) are evaluated as one finite trace, i.e., the loop is not
+ * unrolled.  In particular, trace files store traces without `::` as
+ * lassos whose suffix is the whole trace; these are evaluated as the
+ * finite traces they denote.  Use `ltl_lasso_evaluator` for the
+ * infinite semantics of lassos.
+ */
+class ltl_rv_evaluator
+{
+public:
+  using formula = ltl_formula_store::ltl_formula;
+  using node = ltl_formula_store::node;
+
+  using result_type = bool5;
+
+public:
+  explicit ltl_rv_evaluator( ltl_formula_store const& ltl )
+    : ltl( ltl )
   {
-    assert( ltl.is_constant( n ) && n == 0 );
-    return false;
   }
 
-  bool3 evaluate_variable( node const& n, trace const& t, uint32_t pos ) const
+  bool5 evaluate_formula( formula const& f, trace const& t, uint32_t pos ) const
   {
     if ( pos >= t.length() )
-      return inconclusive3;
+      return inconclusive5;
 
-    return t.has( pos, n );
+    auto const& v = evaluate_all( ltl.get_node( f ), t );
+    return ltl.is_complemented( f ) ? !v[pos] : v[pos];
   }
 
-  bool3 evaluate_or( node const& n, trace const& t, uint32_t pos ) const
+  /*! \brief Returns the values of node `n` in all positions of `t` */
+  bool5_vector const& evaluate_all( node const& n, trace const& t ) const
   {
-    std::array<formula,2> subformulas;
-    ltl.foreach_fanin( n, [&]( const auto& formula, uint32_t index ) {
-        subformulas[index] = formula;
-      });
+    compute( n, t );
+    return values.at( n );
+  }
 
-    return evaluate_formula( subformulas[0], t, pos ) || evaluate_formula( subformulas[1], t, pos );
+protected:
+  bool5_vector fanin_values( formula const& fi ) const
+  {
+    auto const& v = values.at( ltl.get_node( fi ) );
+    return ltl.is_complemented( fi ) ? !v : v;
   }
 
-  bool3 evaluate_next( node const& n, trace const& t, uint32_t pos ) const
+  void compute( node root, trace const& t ) const
   {
-    if ( pos+1 >= t.length() )
-      return inconclusive3;
+    values.clear();
 
-    std::array<formula,2> subformulas;
-    ltl.foreach_fanin( n, [&]( const auto& formula, uint32_t index ) {
-        subformulas[index] = formula;
-      });
+    uint32_t const length = t.length();
+
+    std::unordered_map<node, int32_t> variable_to_proposition;
+    for ( auto k = 0u; k < ltl.num_variables(); ++k )
+      variable_to_proposition.emplace( ltl.get_node( ltl.variable_at( k ) ), int32_t( k + 1u ) );
+
+    /* post-order traversal of the cone of root */
+    std::vector<std::pair<node, bool>> stack = { { root, false } };
+    while ( !stack.empty() )
+    {
+      auto const [n, expanded] = stack.back();
+      stack.pop_back();
+      if ( values.find( n ) != values.end() )
+        continue;
 
-    return evaluate_formula( subformulas[0], t, pos+1 );
+      std::array<formula, 2u> fanins;
+      bool const is_leaf = ltl.is_constant( n ) || ltl.is_variable( n );
+      if ( !is_leaf )
+        ltl.foreach_fanin( n, [&]( auto const& fi, auto i ){ fanins[i] = fi; } );
+
+      if ( !expanded && !is_leaf )
+      {
+        stack.emplace_back( n, true );
+        stack.emplace_back( ltl.get_node( fanins[0u] ), false );
+        stack.emplace_back( ltl.get_node( fanins[1u] ), false );
+        continue;
+      }
+
+      bool5_vector v( length );
+      if ( ltl.is_variable( n ) )
+      {
+        auto const p = variable_to_proposition.at( n );
+        for ( auto i = 0u; i < length; ++i )
+          v.set( i, t.is_true( i, p ) );
+      }
+      else if ( !ltl.is_constant( n ) )
+      {
+        auto const a = fanin_values( fanins[0u] );
+        auto const b = fanin_values( fanins[1u] );
+        if ( ltl.is_and( n ) )
+          v = a & b;
+        else if ( ltl.is_or( n ) )
+          v = a | b;
+        else if ( ltl.is_next( n ) )
+          v = a.shift_down( presumably_false );
+        else if ( ltl.is_eventually( n ) )
+          v = bool5_vector::until( bool5_vector( length, true ), a, presumably_false );
+        else if ( ltl.is_until( n ) )
+          v = bool5_vector::until( a, b, presumably_false );
+        else
+        {
+          /* a R b = !( !a U !b ) */
+          assert( ltl.is_releases( n ) );
+          v = !bool5_vector::until( !a, !b, presumably_false );
+        }
+      }
+      values.emplace( n, std::move( v ) );
+    }
   }
 
-  bool3 evaluate_until( node const& n, trace const& t, uint32_t pos ) const
+protected:
+  ltl_formula_store const& ltl;
+
+  /* value vectors of the uncomplemented nodes of the last evaluated cone */
+  mutable std::unordered_map<node, bool5_vector> values;
+}; /* ltl_rv_evaluator */
+
+/*! \brief LTL evaluator for finite and lasso traces
+ *
+ * Computes the truth values of all subformulas in all positions of the
+ * trace bottom-up, i.e., in time linear in the product of formula size
+ * and trace length.  A finite trace is interpreted with strong next,
+ * as in `ltl_chain_evaluator`.  Variable `k` of the store is
+ * proposition `k + 1` of the trace.
+ */
+class ltl_lasso_evaluator
+{
+public:
+  using formula = ltl_formula_store::ltl_formula;
+  using node = ltl_formula_store::node;
+
+  using result_type = bool;
+
+public:
+  explicit ltl_lasso_evaluator( ltl_formula_store const& ltl )
+    : ltl( ltl )
   {
-    if ( pos+1 >= t.length() )
-      return inconclusive3;
+  }
 
-    std::array<formula,2> subformulas;
-    ltl.foreach_fanin( n, [&]( const auto& formula, uint32_t index ) {
-        subformulas[index] = formula;
-      });
+  bool evaluate_formula( formula const& f, trace const& t, uint32_t pos ) const
+  {
+    if ( pos >= t.length() )
+      return false;
+
+    compute( ltl.get_node( f ), t );
+    return bool( values.at( ltl.get_node( f ) )[pos] ) != ltl.is_complemented( f );
+  }
 
-    return evaluate_formula( subformulas[1], t, pos ) ||
-      ( evaluate_formula( subformulas[0], t, pos ) && evaluate_until( n, t, pos+1 ) );
+  /*! \brief Returns the truth values of `f` in all positions of `t`
+   *
+   * Evaluates the cone of `f` once; use this instead of querying the
+   * positions one by one with `evaluate_formula`.
+   */
+  std::vector<bool> evaluate_all( formula const& f, trace const& t ) const
+  {
+    compute( ltl.get_node( f ), t );
+    auto const& v = values.at( ltl.get_node( f ) );
+    std::vector<bool> result( v.size() );
+    for ( auto i = 0u; i < v.size(); ++i )
+      result[i] = bool( v[i] ) != ltl.is_complemented( f );
+    return result;
   }
 
 protected:
-  ltl_formula_store& ltl;
-}; /* ltl_finite_trace_evaluator */
+  using opcode = ltl_chain_evaluator::opcode;
+
+  /* truth vector of a fanin, complemented into `tmp` if necessary */
+  uint8_t const* fanin_values( formula const& fi, std::vector<uint8_t>& tmp ) const
+  {
+    auto const& v = values.at( ltl.get_node( fi ) );
+    if ( !ltl.is_complemented( fi ) )
+      return v.data();
+
+    tmp.resize( v.size() );
+    for ( auto i = 0u; i < v.size(); ++i )
+      tmp[i] = !v[i];
+    return tmp.data();
+  }
+
+  void compute( node root, trace const& t ) const
+  {
+    values.clear();
+
+    uint32_t const length = t.length();
+    uint32_t const loop_start = t.prefix_length();
+    bool const is_lasso = !t.is_finite();
+
+    std::unordered_map<node, int32_t> variable_to_proposition;
+    for ( auto k = 0u; k < ltl.num_variables(); ++k )
+      variable_to_proposition.emplace( ltl.get_node( ltl.variable_at( k ) ), int32_t( k + 1u ) );
+
+    /* post-order traversal of the cone of root */
+    std::vector<std::pair<node, bool>> stack = { { root, false } };
+    std::vector<uint8_t> tmp_a, tmp_b;
+    while ( !stack.empty() )
+    {
+      auto const [n, expanded] = stack.back();
+      stack.pop_back();
+      if ( values.find( n ) != values.end() )
+        continue;
+
+      std::array<formula, 2u> fanins;
+      bool const is_leaf = ltl.is_constant( n ) || ltl.is_variable( n );
+      if ( !is_leaf )
+        ltl.foreach_fanin( n, [&]( auto const& fi, auto i ){ fanins[i] = fi; } );
+
+      if ( !expanded && !is_leaf )
+      {
+        stack.emplace_back( n, true );
+        stack.emplace_back( ltl.get_node( fanins[0u] ), false );
+        stack.emplace_back( ltl.get_node( fanins[1u] ), false );
+        continue;
+      }
+
+      std::vector<uint8_t> v( length, 0u );
+      if ( ltl.is_variable( n ) )
+      {
+        auto const p = variable_to_proposition.at( n );
+        for ( auto i = 0u; i < length; ++i )
+          v[i] = t.is_true( i, p );
+      }
+      else if ( !ltl.is_constant( n ) )
+      {
+        auto const* a = fanin_values( fanins[0u], tmp_a );
+        auto const* b = fanin_values( fanins[1u], tmp_b );
+        if ( ltl.is_and( n ) )
+          ltl_chain_evaluator::compute_operator( opcode::and_, v.data(), a, b, length, loop_start, is_lasso );
+        else if ( ltl.is_or( n ) )
+          ltl_chain_evaluator::compute_operator( opcode::or_, v.data(), a, b, length, loop_start, is_lasso );
+        else if ( ltl.is_next( n ) )
+          ltl_chain_evaluator::compute_operator( opcode::next_, v.data(), a, b, length, loop_start, is_lasso );
+        else if ( ltl.is_eventually( n ) )
+          ltl_chain_evaluator::compute_operator( opcode::eventually_, v.data(), a, b, length, loop_start, is_lasso );
+        else if ( ltl.is_until( n ) )
+          ltl_chain_evaluator::compute_operator( opcode::until_, v.data(), a, b, length, loop_start, is_lasso );
+        else
+        {
+          /* a R b = !( !a U !b ) */
+          assert( ltl.is_releases( n ) );
+          std::vector<uint8_t> not_a( length ), not_b( length );
+          for ( auto i = 0u; i < length; ++i )
+          {
+            not_a[i] = !a[i];
+            not_b[i] = !b[i];
+          }
+          ltl_chain_evaluator::compute_operator( opcode::until_, v.data(), not_a.data(), not_b.data(), length, loop_start, is_lasso );
+          for ( auto i = 0u; i < length; ++i )
+            v[i] = !v[i];
+        }
+      }
+      values.emplace( n, std::move( v ) );
+    }
+  }
+
+protected:
+  ltl_formula_store const& ltl;
+
+  /* truth vectors of the uncomplemented nodes of the last evaluated cone */
+  mutable std::unordered_map<node, std::vector<uint8_t>> values;
+}; /* ltl_lasso_evaluator */
 
 template<class Evaluator = default_ltl_evaluator>
 typename Evaluator::result_type evaluate( ltl_formula_store::ltl_formula const& f, trace const& t, Evaluator const& eval = Evaluator() )
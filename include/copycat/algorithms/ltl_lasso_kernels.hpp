@@ -0,0 +1,99 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file ltl_lasso_kernels.hpp
+  \brief Temporal operators on the positions of a finite or lasso trace
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace copycat
+{
+
+/*! \brief Computes X a in all positions of a trace
+ *
+ * The trace has `length` positions; if `is_lasso`, the position after
+ * the last one is `loop_start`, otherwise X is strong, i.e., false in
+ * the last position.  `a( i )` returns the value of the operand in
+ * position `i` and `set( i, value )` stores the result; `set` may
+ * overwrite the operand in a position that has already been read.
+ */
+template<typename A, typename Set>
+void lasso_next( uint32_t length, uint32_t loop_start, bool is_lasso, A&& a, Set&& set )
+{
+  if ( length == 0u )
+    return;
+
+  for ( auto i = 0u; i + 1u < length; ++i )
+    set( i, a( i + 1u ) );
+  set( length - 1u, is_lasso && a( loop_start ) );
+}
+
+/*! \brief Computes a U b in all positions of a trace
+ *
+ * Traverses the trace backwards; on a lasso, the loop is traversed
+ * twice such that witnesses after wrapping around are found.  The
+ * arguments are as for `lasso_next`; `set( i, value )` is called after
+ * `a( i )` and `b( i )` have been read, so the result may alias `b`.
+ */
+template<typename A, typename B, typename Set>
+void lasso_until( uint32_t length, uint32_t loop_start, bool is_lasso, A&& a, B&& b, Set&& set )
+{
+  auto const step = [&]( uint32_t i, bool next ){
+    return b( i ) || ( a( i ) && next );
+  };
+
+  bool next = false;
+  if ( is_lasso )
+  {
+    /* first pass: witnesses in the remainder of the loop */
+    for ( auto i = length; i-- > loop_start; )
+      next = step( i, next );
+
+    /* second pass: witnesses after wrapping around */
+    for ( auto i = length; i-- > loop_start; )
+    {
+      next = step( i, next );
+      set( i, next );
+    }
+  }
+  else
+  {
+    loop_start = length;
+  }
+
+  for ( auto i = loop_start; i-- > 0u; )
+  {
+    next = step( i, next );
+    set( i, next );
+  }
+}
+
+} /* namespace copycat */
@@ -0,0 +1,330 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file ltl_monitor.hpp
+  \brief Online LTL monitor based on formula progression
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include "../ltl.hpp"
+#include "../logic/bool3.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <unordered_map>
+#include <vector>
+
+namespace copycat
+{
+
+/*! \brief Incremental LTL monitor
+ *
+ * Monitors a set of LTL formulas over a sequence of letters by
+ * formula progression: after reading a letter, each formula is
+ * rewritten into the obligation that the remaining suffix has to
+ * satisfy.  The rewritten formulas are constructed in the same
+ * `ltl_formula_store` and are simplified by its structural hashing
+ * and constant propagation.  A formula obtains a definite verdict as
+ * soon as its obligation becomes constant.
+ *
+ * Letters are given as a vector of Boolean values indexed by
+ * proposition id, where the k-th variable of the store (`variable_at(
+ * k )`) is proposition k+1, as in the trace evaluators.  Index 0 of a
+ * letter is unused.  Progressing a formula visits every node of its
+ * obligation at most once per letter.
+ *
+ * Note that progression adds the obligations as new nodes to the
+ * store passed to the constructor, i.e., the store grows with every
+ * letter read by the monitor.
+ */
+class ltl_progression_monitor
+{
+public:
+  using formula = ltl_formula_store::ltl_formula;
+  using node = ltl_formula_store::node;
+
+public:
+  explicit ltl_progression_monitor( ltl_formula_store& ltl, std::vector<formula> const& formulas )
+    : ltl( ltl )
+    , obligations( formulas )
+    , verdicts( formulas.size(), inconclusive3 )
+  {
+    update_propositions();
+    for ( auto i = 0u; i < obligations.size(); ++i )
+    {
+      update_verdict( i );
+    }
+  }
+
+  /*! \brief Monitors all formulas of the store */
+  explicit ltl_progression_monitor( ltl_formula_store& ltl )
+    : ltl_progression_monitor( ltl, formulas_of( ltl ) )
+  {
+  }
+
+  /*! \brief Reads the next letter
+   *
+   * Returns true if and only if at least one formula is still
+   * inconclusive after reading the letter.
+   */
+  bool step( std::vector<bool> const& letter )
+  {
+    update_propositions();
+    cache.clear();
+    for ( auto i = 0u; i < obligations.size(); ++i )
+    {
+      if ( verdicts[i] != inconclusive3 )
+        continue;
+
+      obligations[i] = progress( obligations[i], letter );
+      update_verdict( i );
+    }
+    ++num_steps;
+    return !all_decided();
+  }
+
+  /*! \brief Returns the verdict of the i-th formula */
+  bool3 verdict( uint32_t index ) const
+  {
+    return verdicts.at( index );
+  }
+
+  /*! \brief Returns the verdicts of all formulas */
+  std::vector<bool3> const& get_verdicts() const
+  {
+    return verdicts;
+  }
+
+  /*! \brief Returns the current obligation of the i-th formula */
+  formula obligation( uint32_t index ) const
+  {
+    return obligations.at( index );
+  }
+
+  /*! \brief Returns true if and only if all formulas have a definite verdict */
+  bool all_decided() const
+  {
+    return std::none_of( std::begin( verdicts ), std::end( verdicts ),
+                         []( bool3 const& v ){ return v == inconclusive3; } );
+  }
+
+  /*! \brief Returns the number of letters read so far */
+  uint32_t num_letters() const
+  {
+    return num_steps;
+  }
+
+protected:
+  static std::vector<formula> formulas_of( ltl_formula_store const& ltl )
+  {
+    std::vector<formula> fs;
+    ltl.foreach_formula( [&]( formula const& f ){
+        fs.emplace_back( f );
+        return true;
+      });
+    return fs;
+  }
+
+  /* maps the variable nodes to their proposition ids */
+  void update_propositions()
+  {
+    for ( auto k = uint32_t( variable_to_proposition.size() ); k < ltl.num_variables(); ++k )
+    {
+      variable_to_proposition.emplace( ltl.get_node( ltl.variable_at( k ) ), k + 1u );
+    }
+  }
+
+  void update_verdict( uint32_t index )
+  {
+    auto const& f = obligations[index];
+    if ( ltl.is_constant( ltl.get_node( f ) ) )
+    {
+      verdicts[index] = bool3( ltl.is_complemented( f ) );
+    }
+  }
+
+  formula progress( formula const& f, std::vector<bool> const& letter )
+  {
+    /* negation */
+    if ( ltl.is_complemented( f ) )
+    {
+      return !progress( !f, letter );
+    }
+
+    auto const n = ltl.get_node( f );
+    if ( ltl.is_constant( n ) )
+    {
+      return f;
+    }
+
+    auto const it = cache.find( f );
+    if ( it != std::end( cache ) )
+    {
+      return it->second;
+    }
+
+    std::array<formula,2> subformulas;
+    ltl.foreach_fanin( n, [&]( const auto& formula, uint32_t index ) {
+        subformulas[index] = formula;
+      });
+
+    formula result;
+    if ( ltl.is_variable( n ) )
+    {
+      auto const p = variable_to_proposition.at( n );
+      result = ltl.get_constant( p < letter.size() && letter[p] );
+    }
+    else if ( ltl.is_or( n ) )
+    {
+      result = ltl.create_or( progress( subformulas[0], letter ), progress( subformulas[1], letter ) );
+    }
+    else if ( ltl.is_and( n ) )
+    {
+      result = ltl.create_and( progress( subformulas[0], letter ), progress( subformulas[1], letter ) );
+    }
+    else if ( ltl.is_next( n ) )
+    {
+      /* X a => a */
+      result = subformulas[0];
+    }
+    else if ( ltl.is_eventually( n ) )
+    {
+      /* F a => a' | F a */
+      result = ltl.create_or( progress( subformulas[0], letter ), f );
+    }
+    else if ( ltl.is_until( n ) )
+    {
+      /* a U b => b' | ( a' & ( a U b ) ) */
+      result = ltl.create_or( progress( subformulas[1], letter ),
+                              ltl.create_and( progress( subformulas[0], letter ), f ) );
+    }
+    else if ( ltl.is_releases( n ) )
+    {
+      /* a R b => b' & ( a' | ( a R b ) ) */
+      result = ltl.create_and( progress( subformulas[1], letter ),
+                               ltl.create_or( progress( subformulas[0], letter ), f ) );
+    }
+    else
+    {
+      assert( false && "unknown operator" );
+      result = f;
+    }
+
+    cache.emplace( f, result );
+    return result;
+  }
+
+protected:
+  ltl_formula_store& ltl;
+
+  std::vector<formula> obligations;
+  std::vector<bool3> verdicts;
+  uint32_t num_steps{0};
+
+  std::unordered_map<node, uint32_t> variable_to_proposition;
+
+  /* progression of each node w.r.t. the current letter */
+  std::unordered_map<formula, formula> cache;
+}; /* ltl_progression_monitor */
+
+/*! \brief Simulation callback that monitors LTL formulas
+ *
+ * Feeds the signal values of each time frame of `simulate` into an
+ * `ltl_progression_monitor`.  Signals are mapped to propositions in
+ * the same way as by `trace_generator` (PIs, register inputs, register
+ * outputs, POs), such that the k-th variable of the store denotes the
+ * k-th signal.  Simulation stops as soon as every formula has a
+ * definite verdict.
+ */
+template<typename Ntk>
+class ltl_simulation_monitor
+{
+public:
+  using formula = ltl_formula_store::ltl_formula;
+
+public:
+  explicit ltl_simulation_monitor( Ntk const& ntk, ltl_formula_store& ltl, std::vector<formula> const& formulas )
+    : ntk( ntk )
+    , monitor( ltl, formulas )
+    , letter( ntk.num_cis() + ntk.num_cos() + 1u )
+  {
+  }
+
+  explicit ltl_simulation_monitor( Ntk const& ntk, ltl_formula_store& ltl )
+    : ntk( ntk )
+    , monitor( ltl )
+    , letter( ntk.num_cis() + ntk.num_cos() + 1u )
+  {
+  }
+
+  void on_time_frame_start( uint32_t time_frame )
+  {
+    (void)time_frame;
+    std::fill( std::begin( letter ), std::end( letter ), false );
+  }
+
+  void on_pi( uint32_t index, bool value )
+  {
+    letter[index + 1] = value;
+  }
+
+  void on_ri( uint32_t index, bool value )
+  {
+    letter[ntk.num_pis() + index + 1] = value;
+  }
+
+  void on_ro( uint32_t index, bool value )
+  {
+    letter[ntk.num_cis() + index + 1] = value;
+  }
+
+  void on_po( uint32_t index, bool value )
+  {
+    letter[ntk.num_cis() + ntk.num_registers() + index + 1] = value;
+  }
+
+  /*! \brief Returns false to stop the simulation */
+  bool on_time_frame_end( uint32_t time_frame )
+  {
+    (void)time_frame;
+    return monitor.step( letter );
+  }
+
+  ltl_progression_monitor const& get_monitor() const
+  {
+    return monitor;
+  }
+
+protected:
+  Ntk const& ntk;
+  ltl_progression_monitor monitor;
+  std::vector<bool> letter;
+}; /* ltl_simulation_monitor */
+
+} /* namespace copycat */
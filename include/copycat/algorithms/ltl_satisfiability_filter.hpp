@@ -0,0 +1,343 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file ltl_satisfiability_filter.hpp
+  \brief Fast sufficient satisfiability and validity checks for LTL formulas
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include "../logic/bool3.hpp"
+#include "../ltl.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+namespace copycat
+{
+
+struct ltl_satisfiability_filter_parameters
+{
+  /*! \brief Maximum number of obligations kept per node */
+  uint32_t max_obligations = 256u;
+}; /* ltl_satisfiability_filter_parameters */
+
+struct ltl_satisfiability_filter_statistics
+{
+  /*! \brief Number of satisfiability queries */
+  uint64_t num_queries{0u};
+
+  /*! \brief Number of queries answered from the verdict cache */
+  uint64_t num_cache_hits{0u};
+
+  /*! \brief Number of queries proven satisfiable */
+  uint64_t num_satisfiable{0u};
+
+  /*! \brief Number of queries proven unsatisfiable */
+  uint64_t num_unsatisfiable{0u};
+
+  /*! \brief Fraction of queries with a definite answer */
+  double hit_rate() const
+  {
+    return num_queries == 0u ? 0.0 : double( num_satisfiable + num_unsatisfiable ) / double( num_queries );
+  }
+}; /* ltl_satisfiability_filter_statistics */
+
+/*! \brief Obligation-based satisfiability filter
+ *
+ * Decides satisfiability of LTL formulas in the cheap cases using
+ * obligation sets (Li et al., "LTL satisfiability checking
+ * revisited").  An obligation is a conjunction of literals; the
+ * obligations of a formula are computed as in `compute_obligations`,
+ * but for the negation normal form of the formula, i.e., negations are
+ * pushed to the literals by tracking the polarity of each node, and
+ * without creating nodes in the store.
+ *
+ * - If some obligation is consistent, the formula is satisfiable
+ *   (on the trace repeating the obligation forever).
+ * - Each literal is additionally tagged with the position it refers
+ *   to, counted in nested X operators, or as floating below U and F.
+ *   If every obligation contains a literal and its negation at the same
+ *   position, the formula is unsatisfiable.
+ *
+ * Otherwise the answer is inconclusive.  Obligations are cached per
+ * node and polarity, and verdicts per formula.
+ *
+ * The verdicts refer to infinite traces.  They do not carry over to
+ * finite traces, on which, e.g., `X a | X !a` is false at the last
+ * position.
+ */
+class ltl_satisfiability_filter
+{
+public:
+  using formula = ltl_formula_store::ltl_formula;
+  using node = ltl_formula_store::node;
+
+protected:
+  /* position (upper 32 bits), variable node, and complement */
+  using literal = uint64_t;
+  using obligation = std::vector<literal>;
+
+  static constexpr uint64_t floating = 0xffffffffu;
+
+  struct obligations
+  {
+    std::vector<obligation> sets;
+
+    /* false if obligations have been dropped due to the size limit */
+    bool complete = true;
+  }; /* obligations */
+
+public:
+  explicit ltl_satisfiability_filter( ltl_formula_store const& ltl, ltl_satisfiability_filter_parameters const& ps = {} )
+    : ltl( ltl )
+    , ps( ps )
+  {
+  }
+
+  /*! \brief Returns true if `f` is satisfiable, false if it is unsatisfiable, and inconclusive otherwise */
+  bool3 is_satisfiable( formula const& f )
+  {
+    ++st.num_queries;
+
+    auto const it = verdicts.find( f.data );
+    if ( it != verdicts.end() )
+    {
+      ++st.num_cache_hits;
+      count( it->second );
+      return it->second;
+    }
+
+    auto const& olg = compute( ltl.get_node( f ), ltl.is_complemented( f ) );
+
+    bool3 verdict = inconclusive3;
+    if ( olg.complete && olg.sets.empty() )
+      verdict = false;
+    else if ( std::any_of( olg.sets.begin(), olg.sets.end(), []( auto const& o ){ return is_consistent( o ); } ) )
+      verdict = true;
+
+    verdicts.emplace( f.data, verdict );
+    count( verdict );
+    return verdict;
+  }
+
+  /*! \brief Returns true if `f` is valid, false if it is falsifiable, and inconclusive otherwise */
+  bool3 is_valid( formula const& f )
+  {
+    return !is_satisfiable( !f );
+  }
+
+  /*! \brief Returns true if `f` is proven unsatisfiable or valid */
+  bool is_trivial( formula const& f )
+  {
+    return is_satisfiable( f ).is_false() || is_valid( f ).is_true();
+  }
+
+  void clear()
+  {
+    cache.clear();
+    verdicts.clear();
+  }
+
+  ltl_satisfiability_filter_statistics const& statistics() const
+  {
+    return st;
+  }
+
+protected:
+  void count( bool3 const& verdict )
+  {
+    if ( verdict.is_true() )
+      ++st.num_satisfiable;
+    else if ( verdict.is_false() )
+      ++st.num_unsatisfiable;
+  }
+
+  /* consistent if no variable occurs in both polarities, independent of positions */
+  static bool is_consistent( obligation const& o )
+  {
+    std::vector<uint32_t> lits( o.size() );
+    std::transform( o.begin(), o.end(), lits.begin(), []( literal l ){ return uint32_t( l ); } );
+    std::sort( lits.begin(), lits.end() );
+    for ( auto i = 1u; i < lits.size(); ++i )
+      if ( ( lits[i - 1u] ^ 1u ) == lits[i] )
+        return false;
+    return true;
+  }
+
+  /* inconsistent if a variable occurs in both polarities at the same fixed position */
+  static bool has_timed_conflict( obligation const& o )
+  {
+    for ( auto i = 1u; i < o.size(); ++i )
+      if ( ( o[i - 1u] ^ 1u ) == o[i] && ( o[i] >> 32u ) != floating )
+        return true;
+    return false;
+  }
+
+  obligations const& compute( node n, bool negated )
+  {
+    auto const key = ( uint64_t( n ) << 1u ) | ( negated ? 1u : 0u );
+    auto const it = cache.find( key );
+    if ( it != cache.end() )
+      return it->second;
+
+    obligations result;
+    if ( ltl.is_constant( n ) )
+    {
+      /* true has the empty obligation, false has none */
+      if ( negated )
+        result.sets.emplace_back();
+    }
+    else if ( ltl.is_variable( n ) )
+    {
+      result.sets.push_back( { ( uint64_t( n ) << 1u ) | ( negated ? 1u : 0u ) } );
+    }
+    else
+    {
+      std::array<formula, 2u> fanins;
+      ltl.foreach_fanin( n, [&]( auto const& fi, auto i ){ fanins[i] = fi; } );
+
+      /* obligations of a fanin in the polarity of this node */
+      auto const fanin = [&]( uint32_t i ) -> obligations const& {
+        return compute( ltl.get_node( fanins[i] ), ltl.is_complemented( fanins[i] ) != negated );
+      };
+
+      if ( ltl.is_and( n ) || ltl.is_or( n ) )
+      {
+        /* after pushing the negation, !( a | b ) = !a & !b and !( a & b ) = !a | !b */
+        auto const& a = fanin( 0u );
+        auto const& b = fanin( 1u );
+        result = ( ltl.is_and( n ) != negated ) ? product( a, b ) : set_union( a, b );
+      }
+      else if ( ltl.is_next( n ) )
+      {
+        /* !X a = X !a */
+        result = shift( fanin( 0u ), false );
+      }
+      else if ( ltl.is_eventually( n ) )
+      {
+        /* F a: a holds somewhere; !F a = G !a: !a holds now */
+        result = negated ? fanin( 0u ) : shift( fanin( 0u ), true );
+      }
+      else if ( ltl.is_until( n ) )
+      {
+        /* a U b: b holds somewhere; !( a U b ) = !a R !b: !b holds now */
+        result = negated ? fanin( 1u ) : shift( fanin( 1u ), true );
+      }
+      else
+      {
+        /* a R b: b holds now; !( a R b ) = !a U !b: !b holds somewhere */
+        assert( ltl.is_releases( n ) );
+        result = negated ? shift( fanin( 1u ), true ) : fanin( 1u );
+      }
+    }
+
+    return cache.emplace( key, std::move( result ) ).first->second;
+  }
+
+  /* moves all literals one position later, or makes them floating */
+  obligations shift( obligations const& olg, bool make_floating ) const
+  {
+    obligations result;
+    result.complete = olg.complete;
+    result.sets.reserve( olg.sets.size() );
+    for ( auto const& o : olg.sets )
+    {
+      obligation shifted( o.size() );
+      std::transform( o.begin(), o.end(), shifted.begin(), [&]( literal l ){
+          auto const position = l >> 32u;
+          auto const new_position = ( make_floating || position == floating ) ? floating : position + 1u;
+          return ( new_position << 32u ) | ( l & 0xffffffffu );
+        } );
+      std::sort( shifted.begin(), shifted.end() );
+      result.sets.emplace_back( std::move( shifted ) );
+    }
+    normalize( result );
+    return result;
+  }
+
+  obligations set_union( obligations const& a, obligations const& b ) const
+  {
+    obligations result;
+    result.complete = a.complete && b.complete;
+    result.sets = a.sets;
+    result.sets.insert( result.sets.end(), b.sets.begin(), b.sets.end() );
+    normalize( result );
+    return result;
+  }
+
+  obligations product( obligations const& a, obligations const& b ) const
+  {
+    obligations result;
+    result.complete = a.complete && b.complete;
+    for ( auto const& oa : a.sets )
+    {
+      for ( auto const& ob : b.sets )
+      {
+        obligation o;
+        o.reserve( oa.size() + ob.size() );
+        std::set_union( oa.begin(), oa.end(), ob.begin(), ob.end(), std::back_inserter( o ) );
+
+        /* an obligation that is inconsistent at a fixed position witnesses nothing */
+        if ( !has_timed_conflict( o ) )
+          result.sets.emplace_back( std::move( o ) );
+      }
+    }
+    normalize( result );
+    return result;
+  }
+
+  /* removes duplicates and applies the size limit */
+  void normalize( obligations& olg ) const
+  {
+    std::sort( olg.sets.begin(), olg.sets.end() );
+    olg.sets.erase( std::unique( olg.sets.begin(), olg.sets.end() ), olg.sets.end() );
+    if ( olg.sets.size() > ps.max_obligations )
+    {
+      /* keep the smallest obligations, which are the most likely to be consistent */
+      std::stable_sort( olg.sets.begin(), olg.sets.end(), []( auto const& x, auto const& y ){ return x.size() < y.size(); } );
+      olg.sets.resize( ps.max_obligations );
+      olg.complete = false;
+    }
+  }
+
+protected:
+  ltl_formula_store const& ltl;
+  ltl_satisfiability_filter_parameters const ps;
+
+  /* obligations per (node, polarity) and verdicts per formula */
+  std::unordered_map<uint64_t, obligations> cache;
+  std::unordered_map<uint32_t, bool3> verdicts;
+
+  ltl_satisfiability_filter_statistics st;
+}; /* ltl_satisfiability_filter */
+
+} /* namespace copycat */
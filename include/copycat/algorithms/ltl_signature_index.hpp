@@ -0,0 +1,248 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file ltl_signature_index.hpp
+  \brief Observational-equivalence classes of LTL formulas on a spec
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include "trace_signature.hpp"
+#include "../io/ltl_synthesis_spec_reader.hpp"
+#include "../ltl.hpp"
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace copycat
+{
+
+/*! \brief Maps trace signatures to smallest representatives
+ *
+ * Two formulas are observationally equivalent on a spec if they have
+ * the same truth value in every position of every trace of the spec,
+ * i.e., if they have the same `trace_signature`.  The index keeps one
+ * representative of smallest size per signature.  Sizes are given by
+ * the caller: the size of a formula depends on the operators it is
+ * built from (e.g., `ltl_enumerative_learner` counts G a as two,
+ * whereas the store represents it as !F!a), which the store does not
+ * record.
+ *
+ * Signatures of formulas in an `ltl_formula_store` are computed
+ * bottom-up and memoized per node.  Variable `k` of the store is
+ * proposition `k + 1` of the traces.
+ */
+class ltl_signature_index
+{
+public:
+  using ltl_formula = ltl_formula_store::ltl_formula;
+
+  struct entry
+  {
+    ltl_formula formula;
+    uint32_t size;
+  }; /* entry */
+
+public:
+  explicit ltl_signature_index( ltl_formula_store const& ltl, ltl_synthesis_spec const& spec )
+    : ltl( ltl )
+    , _layout( spec )
+  {
+  }
+
+  trace_signature_layout const& layout() const
+  {
+    return _layout;
+  }
+
+  /*! \brief Returns the number of equivalence classes */
+  uint32_t size() const
+  {
+    return classes.size();
+  }
+
+  /*! \brief Removes all classes and memoized signatures */
+  void clear()
+  {
+    classes.clear();
+    node_signatures.clear();
+  }
+
+  /*! \brief Returns the representative of a signature if there is one */
+  std::optional<entry> find( trace_signature const& sig ) const
+  {
+    auto const it = classes.find( sig );
+    if ( it == classes.end() )
+      return std::nullopt;
+    return it->second;
+  }
+
+  /*! \brief Adds a formula with a known signature
+   *
+   * Returns true if the formula became the representative of its
+   * class, i.e., if the class is new or the formula is smaller than
+   * the previous representative.
+   */
+  bool insert( trace_signature const& sig, ltl_formula const& f, uint32_t size )
+  {
+    cache_signature( f, sig );
+
+    auto const it = classes.find( sig );
+    if ( it == classes.end() )
+    {
+      classes.emplace( sig, entry{f, size} );
+      return true;
+    }
+    if ( size < it->second.size )
+    {
+      it->second = {f, size};
+      return true;
+    }
+    return false;
+  }
+
+  /*! \brief Returns the signature of a formula and the representative of its class
+   *
+   * The formula is added to the index with the given size; it becomes
+   * the representative if its class is new or if it is smaller than
+   * the previous representative.
+   */
+  std::pair<trace_signature, ltl_formula> lookup( ltl_formula const& f, uint32_t size )
+  {
+    auto sig = signature( f );
+    insert( sig, f, size );
+    return {sig, classes.at( sig ).formula};
+  }
+
+  /*! \brief Computes the signature of a formula */
+  trace_signature signature( ltl_formula const& f )
+  {
+    compute( ltl.get_node( f ) );
+    auto const& sig = *node_signatures[ltl.get_node( f )];
+    return ltl.is_complemented( f ) ? _layout.compute( operator_opcode::not_, sig ) : sig;
+  }
+
+protected:
+  void cache_signature( ltl_formula const& f, trace_signature const& sig )
+  {
+    auto const n = ltl.get_node( f );
+    if ( node_signatures.size() <= n )
+      node_signatures.resize( ltl.num_nodes() );
+    if ( !node_signatures[n] )
+      node_signatures[n] = ltl.is_complemented( f ) ? _layout.compute( operator_opcode::not_, sig ) : sig;
+  }
+
+  trace_signature fanin_signature( ltl_formula const& fi ) const
+  {
+    auto const& sig = *node_signatures[ltl.get_node( fi )];
+    return ltl.is_complemented( fi ) ? _layout.compute( operator_opcode::not_, sig ) : sig;
+  }
+
+  /* computes the signatures of a node and its transitive fanin in post-order */
+  void compute( uint32_t root )
+  {
+    if ( node_signatures.size() < ltl.num_nodes() )
+      node_signatures.resize( ltl.num_nodes() );
+    if ( node_signatures[root] )
+      return;
+
+    if ( variable_to_proposition.size() < ltl.num_variables() )
+    {
+      for ( auto k = uint32_t( variable_to_proposition.size() ); k < ltl.num_variables(); ++k )
+        variable_to_proposition.emplace( ltl.get_node( ltl.variable_at( k ) ), k + 1u );
+    }
+
+    std::vector<std::pair<uint32_t, bool>> stack = { { root, false } };
+    while ( !stack.empty() )
+    {
+      auto const [n, expanded] = stack.back();
+      stack.pop_back();
+      if ( node_signatures[n] )
+        continue;
+
+      std::array<ltl_formula, 2u> fanins;
+      if ( !ltl.is_constant( n ) && !ltl.is_variable( n ) )
+        ltl.foreach_fanin( n, [&]( auto const& fi, auto i ){ fanins[i] = fi; } );
+
+      if ( !expanded && !ltl.is_constant( n ) && !ltl.is_variable( n ) )
+      {
+        stack.emplace_back( n, true );
+        stack.emplace_back( ltl.get_node( fanins[0u] ), false );
+        stack.emplace_back( ltl.get_node( fanins[1u] ), false );
+        continue;
+      }
+
+      if ( ltl.is_constant( n ) )
+      {
+        node_signatures[n] = _layout.constant( false );
+      }
+      else if ( ltl.is_variable( n ) )
+      {
+        auto const p = variable_to_proposition.at( n );
+        node_signatures[n] = p <= _layout.num_propositions() ? _layout.proposition( int32_t( p ) ) : _layout.constant( false );
+      }
+      else
+      {
+        auto const a = fanin_signature( fanins[0u] );
+        auto const b = fanin_signature( fanins[1u] );
+        if ( ltl.is_and( n ) )
+          node_signatures[n] = _layout.compute( operator_opcode::and_, a, b );
+        else if ( ltl.is_or( n ) )
+          node_signatures[n] = _layout.compute( operator_opcode::or_, a, b );
+        else if ( ltl.is_next( n ) )
+          node_signatures[n] = _layout.compute( operator_opcode::next_, a );
+        else if ( ltl.is_eventually( n ) )
+          node_signatures[n] = _layout.compute( operator_opcode::eventually_, a );
+        else if ( ltl.is_until( n ) )
+          node_signatures[n] = _layout.compute( operator_opcode::until_, a, b );
+        else
+        {
+          /* a R b = !( !a U !b ) */
+          assert( ltl.is_releases( n ) );
+          auto const u = _layout.compute( operator_opcode::until_,
+                                          _layout.compute( operator_opcode::not_, a ),
+                                          _layout.compute( operator_opcode::not_, b ) );
+          node_signatures[n] = _layout.compute( operator_opcode::not_, u );
+        }
+      }
+    }
+  }
+
+protected:
+  ltl_formula_store const& ltl;
+  trace_signature_layout const _layout;
+
+  /* signature of the uncomplemented node */
+  std::vector<std::optional<trace_signature>> node_signatures;
+  std::unordered_map<uint32_t, uint32_t> variable_to_proposition;
+
+  std::unordered_map<trace_signature, entry, trace_signature_hash> classes;
+}; /* ltl_signature_index */
+
+} /* namespace copycat */
@@ -34,6 +34,7 @@
 #include <mockturtle/algorithms/simulation.hpp>
 #include <inttypes.h>
 #include <cassert>
+#include <type_traits>
 #include <vector>
 
 namespace copycat
@@ -104,6 +105,12 @@ protected:
   std::vector<std::vector<bool>> const& stimuli;
 }; /* stimuli_simulator */
 
+/*! \brief Simulates a sequential network for a number of time frames
+ *
+ * The callback is notified about the values of all signals in each
+ * time frame.  If `on_time_frame_end` returns a Boolean, simulation
+ * stops as soon as it returns false.
+ */
 template<typename Ntk, typename Simulator, typename Callback>
 void simulate( Ntk const& ntk, Simulator& sim, uint32_t num_time_steps, Callback& callback )
 {
@@ -119,7 +126,7 @@ void simulate( Ntk const& ntk, Simulator& sim, uint32_t num_time_steps, Callback
   using combinational_simulator_t = default_simulator<bool>;
   combinational_simulator_t comb_sim( assignments );
 
-  for ( auto k = 0u; k < num_time_steps - 1u; ++k )
+  for ( auto k = 0u; k < num_time_steps; ++k )
   {
     callback.on_time_frame_start( k );
 
@@ -143,19 +150,31 @@ void simulate( Ntk const& ntk, Simulator& sim, uint32_t num_time_steps, Callback
       });
 
     /* prepare inputs for next iteration */
-    uint32_t index = 0u;
-    ntk.foreach_pi( [&]( const auto& node ){
-        (void)node;
-        assignments[index] = sim.compute_pi( index, k+1 );
-        ++index;
-      });
-    ntk.foreach_ri( [&]( const auto& f ){
-        bool const value = v[ ntk.get_node( f )];
-        assignments[index] = ntk.is_complemented( f ) ? !value : value;
-        ++index;
-      });
-
-    callback.on_time_frame_end( k );
+    if ( k + 1u < num_time_steps )
+    {
+      uint32_t index = 0u;
+      ntk.foreach_pi( [&]( const auto& node ){
+          (void)node;
+          assignments[index] = sim.compute_pi( index, k+1 );
+          ++index;
+        });
+      ntk.foreach_ri( [&]( const auto& f ){
+          bool const value = v[ ntk.get_node( f )];
+          assignments[index] = ntk.is_complemented( f ) ? !value : value;
+          ++index;
+        });
+    }
+
+    /* stop early if the callback asks for it */
+    if constexpr ( std::is_same_v<decltype( callback.on_time_frame_end( k ) ), bool> )
+    {
+      if ( !callback.on_time_frame_end( k ) )
+        return;
+    }
+    else
+    {
+      callback.on_time_frame_end( k );
+    }
   }
 }
 
@@ -0,0 +1,312 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file trace_signature.hpp
+  \brief Packed truth values of LTL formulas over the traces of a spec
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include "exact_ltl_traits.hpp"
+#include "ltl_lasso_kernels.hpp"
+#include "../io/ltl_synthesis_spec_reader.hpp"
+#include "../trace.hpp"
+#include <cassert>
+#include <vector>
+
+namespace copycat
+{
+
+/*! \brief Truth values of a formula in all positions of all traces of a spec
+ *
+ * One bit per position, packed into 64-bit words.  Bits beyond the
+ * last position are always zero.
+ */
+struct trace_signature
+{
+  std::vector<uint64_t> words;
+
+  bool get( uint32_t pos ) const
+  {
+    return ( words[pos >> 6u] >> ( pos & 63u ) ) & 1u;
+  }
+
+  void set( uint32_t pos, bool value )
+  {
+    auto const mask = uint64_t( 1u ) << ( pos & 63u );
+    if ( value )
+      words[pos >> 6u] |= mask;
+    else
+      words[pos >> 6u] &= ~mask;
+  }
+
+  bool operator==( trace_signature const& other ) const
+  {
+    return words == other.words;
+  }
+
+  bool operator!=( trace_signature const& other ) const
+  {
+    return words != other.words;
+  }
+}; /* trace_signature */
+
+struct trace_signature_hash
+{
+  std::size_t operator()( trace_signature const& sig ) const
+  {
+    uint64_t seed = sig.words.size();
+    for ( const auto& w : sig.words )
+      detail::hash_combine( seed, w );
+    return seed;
+  }
+}; /* trace_signature_hash */
+
+/*! \brief Position layout of the traces of a spec
+ *
+ * The good traces are followed by the bad traces; each trace occupies
+ * a consecutive range of positions.  The layout computes signatures
+ * of propositions and of operators applied to signatures, with the
+ * same lasso semantics as `ltl_chain_evaluator`.
+ */
+class trace_signature_layout
+{
+public:
+  struct segment
+  {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t loop_start;
+    bool is_lasso;
+  }; /* segment */
+
+public:
+  explicit trace_signature_layout( ltl_synthesis_spec const& spec )
+  {
+    for ( const auto& t : spec.good_traces )
+      add_trace( t );
+    for ( const auto& t : spec.bad_traces )
+      add_trace( t );
+
+    _num_words = ( _num_positions + 63u ) >> 6u;
+    _last_word_mask = ( _num_positions & 63u ) ? ( uint64_t( 1u ) << ( _num_positions & 63u ) ) - 1u : ~uint64_t( 0u );
+
+    /* a formula separates the traces iff it is true in the first position of exactly the good traces */
+    _first_positions = constant( false );
+    _good_first_positions = constant( false );
+    for ( auto i = 0u; i < _segments.size(); ++i )
+    {
+      auto const& s = _segments[i];
+      bool const is_good = i < spec.good_traces.size();
+      if ( s.length == 0u )
+      {
+        /* empty traces satisfy no formula */
+        _unseparable = _unseparable || is_good;
+        continue;
+      }
+
+      _first_positions.set( s.offset, true );
+      if ( is_good )
+        _good_first_positions.set( s.offset, true );
+    }
+
+    /* signatures of the propositions */
+    uint32_t num_propositions = spec.num_propositions;
+    for ( const auto& t : spec.good_traces )
+      num_propositions = std::max( num_propositions, t.count_propositions() );
+    for ( const auto& t : spec.bad_traces )
+      num_propositions = std::max( num_propositions, t.count_propositions() );
+
+    _propositions.resize( num_propositions + 1u, constant( false ) );
+    auto fill = [&]( trace const& t, segment const& s ){
+      for ( auto i = 0u; i < s.length; ++i )
+        for ( const auto& p : t._data[i] )
+          if ( p > 0 )
+            _propositions[p].set( s.offset + i, true );
+    };
+    for ( auto i = 0u; i < spec.good_traces.size(); ++i )
+      fill( spec.good_traces[i], _segments[i] );
+    for ( auto i = 0u; i < spec.bad_traces.size(); ++i )
+      fill( spec.bad_traces[i], _segments[spec.good_traces.size() + i] );
+  }
+
+  uint32_t num_positions() const
+  {
+    return _num_positions;
+  }
+
+  uint32_t num_words() const
+  {
+    return _num_words;
+  }
+
+  std::vector<segment> const& segments() const
+  {
+    return _segments;
+  }
+
+  /*! \brief Returns the signature of a constant */
+  trace_signature constant( bool value ) const
+  {
+    trace_signature sig{std::vector<uint64_t>( _num_words, value ? ~uint64_t( 0u ) : 0u )};
+    if ( value && _num_words > 0u )
+      sig.words.back() &= _last_word_mask;
+    return sig;
+  }
+
+  /*! \brief Returns the signature of proposition `p` (1, ..., #propositions) */
+  trace_signature const& proposition( int32_t p ) const
+  {
+    assert( p > 0 && uint32_t( p ) < _propositions.size() );
+    return _propositions[p];
+  }
+
+  uint32_t num_propositions() const
+  {
+    return _propositions.size() - 1u;
+  }
+
+  /*! \brief Returns true iff the formula holds on all good and on no bad trace */
+  bool separates( trace_signature const& sig ) const
+  {
+    if ( _unseparable )
+      return false;
+
+    for ( auto i = 0u; i < _num_words; ++i )
+      if ( ( sig.words[i] & _first_positions.words[i] ) != _good_first_positions.words[i] )
+        return false;
+    return true;
+  }
+
+  /*! \brief Computes the signature of an operator applied to signatures
+   *
+   * `b` is ignored for unary operators.
+   */
+  trace_signature compute( operator_opcode op, trace_signature const& a, trace_signature const& b = {} ) const
+  {
+    trace_signature v;
+    v.words.resize( _num_words );
+
+    switch ( op )
+    {
+    case operator_opcode::not_:
+      for ( auto i = 0u; i < _num_words; ++i )
+        v.words[i] = ~a.words[i];
+      mask_last_word( v );
+      break;
+
+    case operator_opcode::and_:
+      for ( auto i = 0u; i < _num_words; ++i )
+        v.words[i] = a.words[i] & b.words[i];
+      break;
+
+    case operator_opcode::or_:
+      for ( auto i = 0u; i < _num_words; ++i )
+        v.words[i] = a.words[i] | b.words[i];
+      break;
+
+    case operator_opcode::implies_:
+      for ( auto i = 0u; i < _num_words; ++i )
+        v.words[i] = ~a.words[i] | b.words[i];
+      mask_last_word( v );
+      break;
+
+    case operator_opcode::next_:
+      for ( const auto& s : _segments )
+      {
+        lasso_next( s.length, s.loop_start, s.is_lasso,
+                    [&]( uint32_t i ){ return a.get( s.offset + i ); },
+                    [&]( uint32_t i, bool value ){ v.set( s.offset + i, value ); } );
+      }
+      break;
+
+    case operator_opcode::eventually_:
+      until( v, nullptr, a );
+      break;
+
+    case operator_opcode::globally_:
+      /* G a = !F !a */
+      until( v, nullptr, compute( operator_opcode::not_, a ) );
+      for ( auto i = 0u; i < _num_words; ++i )
+        v.words[i] = ~v.words[i];
+      mask_last_word( v );
+      break;
+
+    case operator_opcode::until_:
+      until( v, &a, b );
+      break;
+    }
+
+    return v;
+  }
+
+protected:
+  void add_trace( trace const& t )
+  {
+    segment s;
+    s.offset = _num_positions;
+    s.length = t.length();
+    s.loop_start = t.prefix_length();
+    s.is_lasso = !t.is_finite();
+    _segments.emplace_back( s );
+    _num_positions += s.length;
+  }
+
+  void mask_last_word( trace_signature& v ) const
+  {
+    if ( _num_words > 0u )
+      v.words.back() &= _last_word_mask;
+  }
+
+  /* computes v = a U b (a == nullptr means true) */
+  void until( trace_signature& v, trace_signature const* a, trace_signature const& b ) const
+  {
+    for ( const auto& s : _segments )
+    {
+      lasso_until( s.length, s.loop_start, s.is_lasso,
+                   [&]( uint32_t i ){ return !a || a->get( s.offset + i ); },
+                   [&]( uint32_t i ){ return b.get( s.offset + i ); },
+                   [&]( uint32_t i, bool value ){ v.set( s.offset + i, value ); } );
+    }
+  }
+
+protected:
+  std::vector<segment> _segments;
+  uint32_t _num_positions{0u};
+  uint32_t _num_words{0u};
+  uint64_t _last_word_mask{0u};
+
+  trace_signature _first_positions;
+  trace_signature _good_first_positions;
+  bool _unseparable{false};
+
+  /* signature of proposition p at index p; index 0 is unused */
+  std::vector<trace_signature> _propositions;
+}; /* trace_signature_layout */
+
+} /* namespace copycat */
@@ -32,27 +32,85 @@
 
 #pragma once
 
-#include <vector>
+#include <copycat/traits.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
+#include <type_traits>
+#include <vector>
 
 namespace copycat
 {
 
-namespace detail
+/*! \brief View of the fanins of a chain step
+ *
+ * Behaves like a read-only container of fanins; it is invalidated when
+ * steps are added to or changed in the chain.
+ */
+template<typename FaninType>
+class chain_step_view
 {
+public:
+  using value_type = FaninType;
+  using const_iterator = FaninType const*;
+
+public:
+  chain_step_view( FaninType const* begin, FaninType const* end )
+    : _begin( begin )
+    , _end( end )
+  {
+  }
 
-template<class Fn, class ElementType, class ReturnType>
-inline constexpr bool is_callable_with_index_v = std::is_invocable_r_v<ReturnType, Fn, ElementType, uint32_t>;
+  const_iterator begin() const
+  {
+    return _begin;
+  }
 
-template<class Fn, class ElementType, class ReturnType>
-inline constexpr bool is_callable_without_index_v = std::is_invocable_r_v<ReturnType, Fn, ElementType>;
+  const_iterator end() const
+  {
+    return _end;
+  }
 
-} /* detail */
+  std::size_t size() const
+  {
+    return _end - _begin;
+  }
+
+  bool empty() const
+  {
+    return _begin == _end;
+  }
+
+  FaninType const& operator[]( std::size_t i ) const
+  {
+    return _begin[i];
+  }
+
+  FaninType const& at( std::size_t i ) const
+  {
+    assert( i < size() );
+    return _begin[i];
+  }
+
+private:
+  FaninType const* _begin;
+  FaninType const* _end;
+}; /* chain_step_view */
 
 /*! \brief Container to represent generalized chains.
  *
  * A chain is a straight-line program.  This container allows to
  * provide the label_type as an external template parameter.
+ *
+ * The fanins of all steps are stored in one flat array with offsets,
+ * such that adding a step does not allocate once the capacity is
+ * reserved.  `clear` keeps the capacity, so a chain reused for many
+ * candidates allocates nothing per candidate.  `foreach_step` passes
+ * a `chain_step_view` to functions that accept it, and a `step_type`
+ * otherwise.
  */
 template<typename LabelType, typename StepType>
 class chain
@@ -60,6 +118,8 @@ class chain
 public:
   using label_type = LabelType;
   using step_type  = StepType;
+  using fanin_type = std::decay_t<decltype( *std::begin( std::declval<StepType>() ) )>;
+  using step_view  = chain_step_view<fanin_type>;
 
 public:
   /*! \brief Construct a chain without inputs (e.g., because the number of inputs is unknown) */
@@ -68,7 +128,7 @@ public:
   /*! \brief Construct a chain with a specified number of inputs */
   explicit chain( uint32_t num_inputs, uint32_t num_steps = 0 )
     : _num_inputs( num_inputs )
-    , _steps( num_steps )
+    , _offsets( num_steps + 1u, 0u )
     , _labels( num_steps )
   {
   }
@@ -85,18 +145,26 @@ public:
   template<typename Fn>
   void foreach_step( Fn&& fn ) const
   {
-    static_assert( detail::is_callable_with_index_v<Fn, step_type, void> ||
-                   detail::is_callable_without_index_v<Fn, step_type, void> );
-
-    if constexpr ( detail::is_callable_without_index_v<Fn, step_type, void> )
+    if constexpr ( detail::is_callable_without_index_v<Fn, step_view, void> )
+    {
+      for ( auto i = 0u; i < _labels.size(); ++i )
+        fn( fanins( i ) );
+    }
+    else if constexpr ( detail::is_callable_with_index_v<Fn, step_view, void> )
     {
-      for ( auto i = 0u; i < _steps.size(); ++i )
-        fn( _steps.at( i ) );
+      for ( auto i = 0u; i < _labels.size(); ++i )
+        fn( fanins( i ), _num_inputs + 1u + i );
     }
-    else if constexpr ( detail::is_callable_with_index_v<Fn, step_type, void> )
+    else if constexpr ( detail::is_callable_without_index_v<Fn, step_type, void> )
     {
-      for ( auto i = 0u; i < _steps.size(); ++i )
-        fn( _steps.at( i ), _num_inputs + 1u + i );
+      for ( auto i = 0u; i < _labels.size(); ++i )
+        fn( make_step( i ) );
+    }
+    else
+    {
+      static_assert( detail::is_callable_with_index_v<Fn, step_type, void> );
+      for ( auto i = 0u; i < _labels.size(); ++i )
+        fn( make_step( i ), _num_inputs + 1u + i );
     }
   }
 
@@ -122,8 +190,7 @@ public:
   /*! \brief Returns the length of the chain */
   uint32_t length() const
   {
-    assert( _labels.size() == _steps.size() );
-    return _num_inputs + _steps.size();
+    return _num_inputs + _labels.size();
   }
 
   /*! \brief Returns the number of inputs */
@@ -135,20 +202,27 @@ public:
   /*! \brief Returns the number of steps */
   uint32_t num_steps() const
   {
-    assert( _labels.size() == _steps.size() );
-    return _steps.size();
+    return _labels.size();
   }
 
   /*! \brief Returns the i-th step */
   step_type step_at( uint32_t index ) const
   {
     assert( index > _num_inputs );
-    assert( index < _num_inputs + _steps.size() + 1u );
-    return _steps.at( index - _num_inputs - 1u );
+    assert( index < _num_inputs + _labels.size() + 1u );
+    return make_step( index - _num_inputs - 1u );
+  }
+
+  /*! \brief Returns the fanins of the i-th step without copying them */
+  step_view fanins_at( uint32_t index ) const
+  {
+    assert( index > _num_inputs );
+    assert( index < _num_inputs + _labels.size() + 1u );
+    return fanins( index - _num_inputs - 1u );
   }
 
   /*! \brief Returns the i-th label */
-  label_type label_at( uint32_t index ) const
+  label_type const& label_at( uint32_t index ) const
   {
     assert( index > _num_inputs );
     assert( index < _num_inputs + _labels.size() + 1u );
@@ -161,14 +235,42 @@ public:
     _num_inputs = num_inputs;
   }
 
+  /*! \brief Reserve memory for steps and fanins */
+  void reserve( uint32_t num_steps, uint32_t num_fanins )
+  {
+    _labels.reserve( num_steps );
+    _offsets.reserve( num_steps + 1u );
+    _fanins.reserve( num_fanins );
+  }
+
+  /*! \brief Remove all steps but keep the allocated memory */
+  void clear()
+  {
+    _labels.clear();
+    _offsets.resize( 1u );
+    _fanins.clear();
+  }
+
   /*! \brief Add a step to the chain */
   int32_t add_step( label_type const& label, step_type const& step )
   {
-    assert( _steps.size() == _labels.size() );
+    return add_step( label, std::begin( step ), std::end( step ) );
+  }
+
+  /*! \brief Add a step to the chain */
+  int32_t add_step( label_type const& label, std::initializer_list<fanin_type> step )
+  {
+    return add_step( label, step.begin(), step.end() );
+  }
 
-    auto const index = _steps.size();
+  /*! \brief Add a step with fanins in the range [begin, end) to the chain */
+  template<typename Iterator>
+  int32_t add_step( label_type const& label, Iterator begin, Iterator end )
+  {
+    auto const index = _labels.size();
     _labels.emplace_back( label );
-    _steps.emplace_back( step );
+    _fanins.insert( _fanins.end(), begin, end );
+    _offsets.emplace_back( _fanins.size() );
     return _num_inputs + int32_t( index ) + 1;
   }
 
@@ -176,55 +278,67 @@ public:
   void set_step( uint32_t index, label_type const& label, step_type const& step )
   {
     assert( index > _num_inputs );
-    assert( index < _num_inputs + _labels.size() + 1u);
-    assert( index < _num_inputs + _steps.size() + 1u);
+    assert( index < _num_inputs + _labels.size() + 1u );
 
-    _labels[index - _num_inputs - 1u] = label;
-    _steps[index - _num_inputs - 1u] = step;
+    auto const i = index - _num_inputs - 1u;
+    _labels[i] = label;
+
+    /* replace the fanins and shift the offsets of later steps */
+    auto const old_size = int64_t( _offsets[i + 1u] - _offsets[i] );
+    auto const new_size = int64_t( std::distance( std::begin( step ), std::end( step ) ) );
+    auto const pos = _fanins.begin() + _offsets[i];
+    if ( new_size < old_size )
+      _fanins.erase( pos + new_size, pos + old_size );
+    else if ( new_size > old_size )
+      _fanins.insert( pos + old_size, new_size - old_size, fanin_type{} );
+    std::copy( std::begin( step ), std::end( step ), _fanins.begin() + _offsets[i] );
+    for ( auto j = i + 1u; j < _offsets.size(); ++j )
+      _offsets[j] += new_size - old_size;
   }
 
   /*! \brief Remove unused steps (inplace) */
   void remove_unused_steps()
   {
-    assert( _steps.size() == _labels.size() );
+    assert( _offsets.size() == _labels.size() + 1u );
 
-    std::vector<bool> used( _steps.size(), false );
-    for ( auto i = 0u; i < _steps.size(); ++i )
+    std::vector<bool> used( _labels.size(), false );
+    for ( const auto& s : _fanins )
     {
-      for ( const auto& s : _steps.at( i ) )
-      {
-        used[s] = true;
-      }
+      used[s] = true;
     }
 
     /* last step is always used */
-    used[_steps.size()-1u] = true;
+    used[_labels.size()-1u] = true;
 
-    /* re-construct _steps and _labels */
-    std::vector<step_type> new_steps;
-    std::vector<label_type> new_labels;
+    /* compact _fanins, _offsets, and _labels */
+    uint32_t num_steps = 0u, num_fanins = 0u;
     for ( auto i = 0u; i < used.size(); ++i )
     {
       if ( used.at( i ) )
       {
-        new_steps.emplace_back( _steps.at( i ) );
-        new_labels.emplace_back( _labels.at( i ) );
+        auto const begin = _offsets[i], end = _offsets[i + 1u];
+        if ( num_steps != i )
+          _labels[num_steps] = std::move( _labels[i] );
+        for ( auto j = begin; j < end; ++j )
+          _fanins[num_fanins++] = _fanins[j];
+        _offsets[++num_steps] = num_fanins;
       }
     }
-    _steps = new_steps;
-    _labels = new_labels;
+    _labels.resize( num_steps );
+    _offsets.resize( num_steps + 1u );
+    _fanins.resize( num_fanins );
   }
 
   /*! \brief Incomplete check to ensure correctness of the data structure */
   bool okay() const
   {
-    if ( _steps.size() != _labels.size() )
+    if ( _offsets.size() != _labels.size() + 1u || _offsets.back() != _fanins.size() )
       return false;
 
-    for ( auto i = 0u; i < _steps.size(); ++i )
+    for ( auto i = 0u; i < _labels.size(); ++i )
     {
       int32_t step_index = _num_inputs + 1u + i;
-      for ( auto const& s : _steps.at( i ) )
+      for ( auto const& s : fanins( i ) )
       {
         if ( abs(s) >= step_index )
           return false;
@@ -234,18 +348,38 @@ public:
     return true;
   }
 
+private:
+  step_view fanins( uint32_t i ) const
+  {
+    return step_view( _fanins.data() + _offsets[i], _fanins.data() + _offsets[i + 1u] );
+  }
+
+  step_type make_step( uint32_t i ) const
+  {
+    auto const v = fanins( i );
+    if constexpr ( std::is_constructible_v<step_type, typename step_view::const_iterator, typename step_view::const_iterator> )
+    {
+      return step_type( v.begin(), v.end() );
+    }
+    else
+    {
+      /* fixed-size steps such as std::array */
+      step_type step{};
+      std::copy( v.begin(), v.end(), std::begin( step ) );
+      return step;
+    }
+  }
+
 private:
   /*! \brief Number of inputs */
   uint32_t _num_inputs = 0u;
 
-  /*! \brief Steps of the chain */
-  std::vector<step_type> _steps;
+  /*! \brief Fanins of all steps; the fanins of step i are at [_offsets[i], _offsets[i + 1]) */
+  std::vector<fanin_type> _fanins;
+  std::vector<uint32_t> _offsets = {0u};
 
   /*! \brief Labels of the chain */
   std::vector<label_type> _labels;
-
-  /*! \brief Outputs of the chain */
-  // std::vector<int> _outputs;
 }; /* chain */
 
 } /* copycat */
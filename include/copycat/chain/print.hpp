@@ -55,7 +55,7 @@ void write_chain( chain<L,S> const& c, std::ostream& os = std::cout )
   assert( c.okay() );
   for ( uint32_t i = 0; i < c.num_steps(); ++i )
   {
-    auto const& step = c.step_at( num_inputs + 1u + i );
+    auto const& step = c.fanins_at( num_inputs + 1u + i );
     if ( step.size() == 0u )
     {
       /* step has no arguments */
@@ -31,23 +31,20 @@
   \author Heinz Riener
 */
 
+#pragma once
+
+#include <copycat/traits.hpp>
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace copycat
 {
 
-namespace detail
-{
-
-template<class Fn, class ElementType, class ReturnType>
-inline constexpr bool is_callable_with_index_v = std::is_invocable_r_v<ReturnType, Fn, ElementType, uint32_t>;
-
-template<class Fn, class ElementType, class ReturnType>
-inline constexpr bool is_callable_without_index_v = std::is_invocable_r_v<ReturnType, Fn, ElementType>;
-
-} /* detail */
-
 template<int FI>
 class dag
 {
@@ -70,7 +67,7 @@ public:
     reset( num_inputs, num_vertices );
   }
 
-  explicit dag( dag&& other )
+  dag( dag&& other ) noexcept
     : _num_inputs( other._num_inputs )
     , _num_vertices( other._num_vertices )
     , _vertices( std::move( other._vertices ) )
@@ -80,14 +77,30 @@ public:
     other._num_vertices = -1;
   }
 
-  explicit dag( dag const& other )
+  dag( dag const& other )
   {
     copy_dag( other );
   }
 
   dag& operator=( dag const& other )
   {
-    copy_dag( other );
+    if ( this != &other )
+      copy_dag( other );
+    return *this;
+  }
+
+  dag& operator=( dag&& other ) noexcept
+  {
+    if ( this != &other )
+    {
+      _num_inputs = other._num_inputs;
+      _num_vertices = other._num_vertices;
+      _vertices = std::move( other._vertices );
+
+      /* invalidate other */
+      other._num_inputs = -1;
+      other._num_vertices = -1;
+    }
     return *this;
   }
 
@@ -191,7 +204,7 @@ public:
 
     vertex new_v;
     for ( int i = 0; i < FI; ++i )
-      new_v = fs.at( i );
+      new_v[i] = fs.at( i );
 
     _vertices.emplace_back( new_v );
 
@@ -225,20 +238,26 @@ private:
   /* \brief Copies a DAG */
   inline void copy_dag( dag const& other )
   {
-    reset( other._num_inputs, other._num_vertices );
-    _vertices.resize( other._num_vertices );
-
-    for ( int i = 0; i < _num_vertices; ++i )
-      for ( int j = 0; j < FI; ++j )
-        _vertices[i][j] = other._vertices.at( i ).at( j );
+    _num_inputs = other._num_inputs;
+    _num_vertices = other._num_vertices;
+    _vertices = other._vertices;
   }
 
 protected:
-  int _num_inputs;
-  int _num_vertices;
+  int _num_inputs{0};
+  int _num_vertices{0};
   std::vector<std::array<fanin, FI>> _vertices;
 }; /* dag */
 
+/*! \brief Binary DAG
+ *
+ * The fanins are stored as a structure of arrays: all first fanins
+ * followed by all second fanins in one contiguous block.  The block
+ * grows geometrically, such that adding a vertex is amortized
+ * constant time.  Up to `small_size` vertices are stored inside the
+ * object, such that building and copying small DAGs (as done during
+ * DAG enumeration) does not allocate.
+ */
 template<>
 class dag<2>
 {
@@ -246,6 +265,9 @@ public:
   using fanin = int;
   using vertex = std::pair<int,int>;
 
+  /*! \brief Number of vertices stored without heap allocation */
+  static constexpr int small_size = 16;
+
   explicit dag() = default;
 
   explicit dag( int num_inputs )
@@ -258,35 +280,35 @@ public:
     reset( num_inputs, num_vertices );
   }
 
-  explicit dag( dag&& other )
-    : _num_inputs( other._num_inputs )
-    , _num_vertices( other._num_vertices )
-    , _js( other._js )
-    , _ks( other._ks )
+  dag( dag&& other ) noexcept
   {
-    /* invalidate other */
-    other._num_inputs = -1;
-    other._num_vertices = -1;
-    other._js = nullptr;
-    other._ks = nullptr;
+    move_dag( std::move( other ) );
   }
 
-  explicit dag( dag const& other )
+  dag( dag const& other )
   {
     copy_dag( other );
   }
 
   ~dag()
   {
-    if ( _js != nullptr )
-      delete[] _js;
-    if ( _ks != nullptr )
-      delete[] _ks;
+    release();
   }
 
   dag& operator=( dag const& other )
   {
-    copy_dag( other );
+    if ( this != &other )
+      copy_dag( other );
+    return *this;
+  }
+
+  dag& operator=( dag&& other ) noexcept
+  {
+    if ( this != &other )
+    {
+      release();
+      move_dag( std::move( other ) );
+    }
     return *this;
   }
 
@@ -296,12 +318,8 @@ public:
          _num_vertices != other._num_vertices )
       return false;
 
-    for ( int i = 0; i < _num_vertices; ++i )
-      if ( _js[i] != other._js[i] ||
-           _ks[i] != other._ks[i] )
-        return false;
-
-    return true;
+    return std::equal( _js, _js + _num_vertices, other._js ) &&
+           std::equal( _ks, _ks + _num_vertices, other._ks );
   }
 
   bool operator!=( dag const& other ) const
@@ -321,6 +339,29 @@ public:
     return _num_vertices;
   }
 
+  /*! \brief Returns the number of vertices that fit without reallocation */
+  int capacity() const
+  {
+    return _capacity;
+  }
+
+  /*! \brief Reserve memory for at least `num_vertices` vertices */
+  void reserve( int num_vertices )
+  {
+    if ( num_vertices <= _capacity )
+      return;
+
+    auto const new_capacity = std::max( num_vertices, 2 * _capacity );
+    auto const block = new fanin[2 * new_capacity];
+    std::copy_n( _js, std::max( _num_vertices, 0 ), block );
+    std::copy_n( _ks, std::max( _num_vertices, 0 ), block + new_capacity );
+
+    release();
+    _capacity = new_capacity;
+    _js = block;
+    _ks = block + new_capacity;
+  }
+
   /*! \brief Set fanins of vertex at index */
   void set_vertex( int index, fanin fi0, fanin fi1 )
   {
@@ -332,73 +373,33 @@ public:
   /*! \brief Set fanins of vertex at index */
   void set_vertex( int index, std::array<fanin,2> const& fs )
   {
-    assert( index < _num_vertices && "Index out of bounds" );
-    _js[index] = fs.at( 0 );
-    _ks[index] = fs.at( 1 );
+    set_vertex( index, fs[0], fs[1] );
   }
 
   /*! \brief Set fanins of vertex at index */
   void set_vertex( int index, std::vector<fanin> const& fs )
   {
-    assert( index < _num_vertices && "Index out of bounds" );
-    _js[index] = fs.at( 0 );
-    _ks[index] = fs.at( 1 );
+    set_vertex( index, fs.at( 0 ), fs.at( 1 ) );
   }
 
   /*! \brief Add vertex to DAG */
   int add_vertex( fanin fi0, fanin fi1 )
   {
-    auto new_js = new fanin[_num_vertices + 1u];
-    auto new_ks = new fanin[_num_vertices + 1u];
+    if ( _num_vertices == _capacity )
+      reserve( _num_vertices + 1 );
 
-    for ( int i = 0; i < _num_vertices; ++i )
-    {
-      new_js[i] = _js[i];
-      new_ks[i] = _ks[i];
-    }
-
-    new_js[_num_vertices] = fi0;
-    new_ks[_num_vertices] = fi1;
-
-    if ( _js != nullptr )
-      delete[] _js;
-    _js = new_js;
-
-    if ( _ks != nullptr )
-      delete[] _ks;
-    _ks = new_ks;
+    _js[_num_vertices] = fi0;
+    _ks[_num_vertices] = fi1;
 
     auto const id = _num_vertices;
     ++_num_vertices;
-    return _num_vertices;
+    return id;
   }
 
   /*! \brief Add vertex to DAG */
   int add_vertex( std::array<fanin,2> const& fs )
   {
-    auto new_js = new fanin[_num_vertices + 1u];
-    auto new_ks = new fanin[_num_vertices + 1u];
-
-    for ( int i = 0; i < _num_vertices; ++i )
-    {
-      new_js[i] = _js[i];
-      new_ks[i] = _ks[i];
-    }
-
-    new_js[_num_vertices] = fs.at( 0 );
-    new_ks[_num_vertices] = fs.at( 1 );
-
-    if ( _js != nullptr )
-      delete[] _js;
-    _js = new_js;
-
-    if ( _ks != nullptr )
-      delete[] _ks;
-    _ks = new_ks;
-
-    auto const id = _num_vertices;
-    ++_num_vertices;
-    return id;
+    return add_vertex( fs[0], fs[1] );
   }
 
   /*! \brief Get vertex at index from DAG */
@@ -455,37 +456,82 @@ public:
   }
 
 private:
+  bool is_small() const
+  {
+    return _js == _buffer.data();
+  }
+
+  /*! \brief Free heap memory and fall back to the small buffer */
+  void release()
+  {
+    if ( !is_small() )
+      delete[] _js;
+
+    _capacity = small_size;
+    _js = _buffer.data();
+    _ks = _buffer.data() + small_size;
+  }
+
   /*! \brief Reset (and resize) the DAG */
   void reset( int num_inputs, int num_vertices )
   {
+    _num_vertices = 0;
+    reserve( num_vertices );
+
     _num_inputs = num_inputs;
     _num_vertices = num_vertices;
-
-    if ( _js != nullptr )
-      delete[] _js;
-    _js = new int[_num_vertices]();
-
-    if ( _ks != nullptr )
-      delete[] _ks;
-    _ks = new int[_num_vertices]();
+    std::fill_n( _js, _num_vertices, 0 );
+    std::fill_n( _ks, _num_vertices, 0 );
   }
 
   /* \brief Copies a DAG */
   void copy_dag( dag const& other )
   {
-    reset( other._num_inputs, other._num_vertices );
-    for ( int i = 0; i < _num_vertices; ++i )
+    _num_vertices = 0;
+    reserve( other._num_vertices );
+
+    _num_inputs = other._num_inputs;
+    _num_vertices = other._num_vertices;
+    std::copy_n( other._js, std::max( _num_vertices, 0 ), _js );
+    std::copy_n( other._ks, std::max( _num_vertices, 0 ), _ks );
+  }
+
+  /* \brief Moves a DAG (this must not own heap memory) */
+  void move_dag( dag&& other )
+  {
+    assert( is_small() );
+    _num_inputs = other._num_inputs;
+    _num_vertices = other._num_vertices;
+
+    if ( other.is_small() )
     {
-      _js[i] = other._js[i];
-      _ks[i] = other._ks[i];
+      std::copy_n( other._js, std::max( _num_vertices, 0 ), _js );
+      std::copy_n( other._ks, std::max( _num_vertices, 0 ), _ks );
     }
+    else
+    {
+      /* steal the heap block */
+      _capacity = other._capacity;
+      _js = other._js;
+      _ks = other._ks;
+
+      other._capacity = small_size;
+      other._js = other._buffer.data();
+      other._ks = other._buffer.data() + small_size;
+    }
+
+    /* invalidate other */
+    other._num_inputs = -1;
+    other._num_vertices = -1;
   }
 
 private:
-  int _num_inputs;
-  int _num_vertices;
-  int *_js{nullptr};
-  int *_ks{nullptr};
+  int _num_inputs{0};
+  int _num_vertices{0};
+  int _capacity{small_size};
+  std::array<fanin, 2 * small_size> _buffer;
+  fanin *_js{_buffer.data()};
+  fanin *_ks{_buffer.data() + small_size};
 }; /* dag<2> */
 
 template<typename Dag>
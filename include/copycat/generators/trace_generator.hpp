@@ -0,0 +1,280 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file trace_generator.hpp
+  \brief Trace generator
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include <copycat/algorithms/exact_ltl_traits.hpp>
+#include <copycat/algorithms/sequential_simulation.hpp>
+#include <copycat/io/ltl_synthesis_spec_reader.hpp>
+#include <copycat/trace.hpp>
+#include <algorithm>
+#include <cassert>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace copycat
+{
+
+/*! \brief Simulation callback that records a trace
+ *
+ * Records the values of all signals of a sequential network in each
+ * time frame into a `trace`.  A signal that is true in a time frame
+ * is recorded by its proposition id.  The proposition ids are
+ * assigned in the order
+ *
+ *   1, ..., #pis                       primary inputs
+ *   #pis + 1, ..., #cis                register inputs (next state)
+ *   #cis + 1, ..., #cis + #registers   register outputs (current state)
+ *   #cis + #registers + 1, ...         primary outputs
+ *
+ * If a lasso start is given, all time frames starting at the lasso
+ * start are recorded into the suffix of the trace; otherwise the
+ * trace is finite.  The lasso is a run of the network only if the
+ * register state after the last time frame equals the register state
+ * at the lasso start (see `closes_lasso`).  The stimulus is then
+ * periodic by construction, since the suffix repeats the recorded
+ * input values.
+ */
+template<typename Ntk>
+class trace_generator
+{
+public:
+  explicit trace_generator( Ntk const& ntk, trace& tr, std::optional<uint32_t> const& lasso_start = std::nullopt )
+    : ntk( ntk )
+    , tr( tr )
+    , lasso_start( lasso_start )
+    , loop_state( ntk.num_registers() )
+    , next_state( ntk.num_registers() )
+  {
+  }
+
+  /*! \brief Returns the number of signals (= number of propositions) */
+  uint32_t num_signals() const
+  {
+    return ntk.num_cis() + ntk.num_cos();
+  }
+
+  /*! \brief Returns true if and only if the recorded trace is finite or a run of the network
+   *
+   * Checks that the register state after the last recorded time
+   * frame equals the register state at the lasso start, i.e., that
+   * the suffix of the trace can be repeated forever.
+   */
+  bool closes_lasso() const
+  {
+    return !lasso_start || ( tr.suffix_length() > 0u && next_state == loop_state );
+  }
+
+  void on_time_frame_start( uint32_t time_frame )
+  {
+    curr_time_frame = time_frame;
+    data.clear();
+  }
+
+  void on_pi( uint32_t index, bool value )
+  {
+    if ( value )
+      data.emplace_back( index + 1 );
+  }
+
+  void on_ri( uint32_t index, bool value )
+  {
+    next_state[index] = value;
+    if ( value )
+      data.emplace_back( ntk.num_pis() + index + 1 );
+  }
+
+  void on_ro( uint32_t index, bool value )
+  {
+    if ( lasso_start && curr_time_frame == *lasso_start )
+      loop_state[index] = value;
+    if ( value )
+      data.emplace_back( ntk.num_cis() + index + 1 );
+  }
+
+  void on_po( uint32_t index, bool value )
+  {
+    if ( value )
+      data.emplace_back( ntk.num_cis() + ntk.num_registers() + index + 1 );
+  }
+
+  void on_time_frame_end( uint32_t time_frame )
+  {
+    std::sort( std::begin( data ), std::end( data ) );
+    if ( lasso_start && time_frame >= *lasso_start )
+      tr.emplace_suffix( data );
+    else
+      tr.emplace_prefix( data );
+  }
+
+protected:
+  Ntk const& ntk;
+  trace& tr;
+  std::optional<uint32_t> lasso_start;
+
+  std::vector<int32_t> data;
+  uint32_t curr_time_frame{0u};
+
+  /* register state at the lasso start and after the current time frame */
+  std::vector<bool> loop_state;
+  std::vector<bool> next_state;
+}; /* trace_generator */
+
+/*! \brief Flips randomly chosen bits of a stimuli sequence
+ *
+ * Returns a copy of `stimuli` in which `num_flips` distinct, randomly
+ * chosen input values have been negated, i.e., the result differs from
+ * `stimuli` if `num_flips` is positive.  If there are fewer input
+ * values, all of them are negated.
+ */
+template<typename RandomEngine>
+std::vector<std::vector<bool>> mutate_stimuli( std::vector<std::vector<bool>> stimuli, RandomEngine& engine, uint32_t num_flips = 1u )
+{
+  if ( stimuli.empty() || stimuli[0u].empty() )
+    return stimuli;
+
+  uint64_t const num_inputs = stimuli[0u].size();
+  uint64_t const num_values = stimuli.size() * num_inputs;
+  uint64_t const k = std::min<uint64_t>( num_flips, num_values );
+
+  /* Floyd's algorithm samples k distinct positions out of num_values */
+  std::vector<uint64_t> positions;
+  positions.reserve( k );
+  for ( auto j = num_values - k; j < num_values; ++j )
+  {
+    auto const t = std::uniform_int_distribution<uint64_t>( 0u, j )( engine );
+    positions.emplace_back( std::find( positions.begin(), positions.end(), t ) == positions.end() ? t : j );
+  }
+
+  for ( const auto& pos : positions )
+  {
+    auto const time_frame = pos / num_inputs;
+    auto const index = pos % num_inputs;
+    stimuli[time_frame][index] = !stimuli[time_frame][index];
+  }
+  return stimuli;
+}
+
+namespace detail
+{
+  inline bool is_same_trace( trace const& a, trace const& b )
+  {
+    return a._prefix_length == b._prefix_length && a._data == b._data;
+  }
+
+  inline bool contains_trace( std::vector<trace> const& traces, trace const& t )
+  {
+    return std::any_of( std::begin( traces ), std::end( traces ),
+                        [&]( trace const& other ){ return is_same_trace( other, t ); } );
+  }
+} /* detail */
+
+/*! \brief Generates an LTL synthesis specification by simulation
+ *
+ * Simulates a sequential network and adds the recorded traces
+ * directly to an `ltl_synthesis_spec`: good traces are obtained from
+ * simulating the design on valid stimuli, bad traces from simulating
+ * it on (e.g., mutated) invalid stimuli.  The traces use the
+ * proposition ids of `trace_generator`.
+ *
+ * A trace is rejected (and the `add_*` methods return false) if its
+ * lasso is not a run of the network, or if the same trace is already
+ * part of the spec with the opposite label.  In particular, a mutated
+ * stimulus that does not change the observed trace is not added as a
+ * bad trace.
+ */
+template<typename Ntk>
+class ltl_synthesis_spec_generator
+{
+public:
+  explicit ltl_synthesis_spec_generator( Ntk const& ntk, ltl_synthesis_spec& spec )
+    : ntk( ntk )
+    , spec( spec )
+  {
+    ensure_default_operators( spec );
+  }
+
+  /*! \brief Simulates `num_time_steps` time frames and adds a good trace */
+  template<typename Simulator>
+  bool add_good_trace( Simulator& sim, uint32_t num_time_steps, std::optional<uint32_t> const& lasso_start = std::nullopt )
+  {
+    return add_trace( spec.good_traces, spec.bad_traces, sim, num_time_steps, lasso_start );
+  }
+
+  /*! \brief Simulates `num_time_steps` time frames and adds a bad trace */
+  template<typename Simulator>
+  bool add_bad_trace( Simulator& sim, uint32_t num_time_steps, std::optional<uint32_t> const& lasso_start = std::nullopt )
+  {
+    return add_trace( spec.bad_traces, spec.good_traces, sim, num_time_steps, lasso_start );
+  }
+
+  /*! \brief Simulates stimuli and adds a good trace */
+  bool add_good_stimuli( std::vector<std::vector<bool>> const& stimuli, std::optional<uint32_t> const& lasso_start = std::nullopt )
+  {
+    stimuli_simulator sim( ntk, stimuli );
+    return add_good_trace( sim, stimuli.size(), lasso_start );
+  }
+
+  /*! \brief Simulates stimuli and adds a bad trace */
+  bool add_bad_stimuli( std::vector<std::vector<bool>> const& stimuli, std::optional<uint32_t> const& lasso_start = std::nullopt )
+  {
+    stimuli_simulator sim( ntk, stimuli );
+    return add_bad_trace( sim, stimuli.size(), lasso_start );
+  }
+
+protected:
+  template<typename Simulator>
+  bool add_trace( std::vector<trace>& traces, std::vector<trace> const& opposite, Simulator& sim,
+                  uint32_t num_time_steps, std::optional<uint32_t> const& lasso_start )
+  {
+    assert( !lasso_start || *lasso_start < num_time_steps );
+
+    trace tr;
+    tr._data.reserve( num_time_steps );
+
+    trace_generator<Ntk> gen( ntk, tr, lasso_start );
+    simulate( ntk, sim, num_time_steps, gen );
+
+    if ( !gen.closes_lasso() || detail::contains_trace( opposite, tr ) )
+      return false;
+
+    spec.num_propositions = std::max( spec.num_propositions, gen.num_signals() );
+    traces.emplace_back( std::move( tr ) );
+    return true;
+  }
+
+protected:
+  Ntk const& ntk;
+  ltl_synthesis_spec& spec;
+}; /* ltl_synthesis_spec_generator */
+
+} /* namespace copycat */
@@ -34,6 +34,17 @@
 
 #include <copycat/io/ltl.hpp>
 #include <copycat/ltl.hpp>
+#include <copycat/utils/memory_mapped_file.hpp>
+#include <copycat/utils/string_utils.hpp>
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace copycat
 {
@@ -139,4 +150,400 @@ protected:
   mutable std::vector<ltl_formula_store::ltl_formula> formula;
 }; /* ltl_formula_reader */
 
+namespace detail
+{
+
+/*! \brief Single-pass LTL parser
+ *
+ * Parses LTL formulas from a buffer (one formula per line) and
+ * constructs them directly in an `ltl_formula_store`.  The parser
+ * accepts the same language as `ltl_parser` with the operators
+ * interpreted as in `ltl_formula_reader`: unary operators (`!`, `~`,
+ * `X`, `F`, `G`) apply to the remainder of the formula and binary
+ * operators (`->`, `*`, `&`, `+`, `|`, `U`, `R`) are
+ * right-associative without precedence.  The parser does not build an
+ * abstract syntax tree and keeps an explicit stack instead of
+ * recursing, such that deeply nested formulas do not exhaust the call
+ * stack.  Blank lines and lines with only comments are skipped.
+ */
+class ltl_buffer_parser
+{
+public:
+  using formula = ltl_formula_store::ltl_formula;
+
+public:
+  explicit ltl_buffer_parser( ltl_formula_store& ltl, std::map<std::string, formula>& names )
+    : ltl( ltl )
+    , names( names )
+  {
+  }
+
+  return_code parse( std::string_view buffer )
+  {
+    bool success = true;
+    foreach_line( buffer, [&]( std::string_view l ){
+        line = l;
+        return ( success = parse_line() );
+      });
+    return success ? return_code::success : return_code::parse_error;
+  }
+
+protected:
+  enum class kind : uint8_t
+  {
+    eof, name, lparan, rparan, unary, binary, error
+  };
+
+  /* pending operator: unary, binary (with left operand), or parenthesis */
+  struct frame
+  {
+    kind type;
+    char op;
+    formula left;
+  };
+
+  static bool is_whitespace( char c )
+  {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\\';
+  }
+
+  static bool is_operator( char c )
+  {
+    switch ( c )
+    {
+    case '(': case ')': case '~': case '!': case '*': case '+': case '&':
+    case '|': case '-': case 'X': case 'G': case 'F': case 'U': case 'R':
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  /* advances to the next token and returns its kind; `op` is set for operators */
+  kind next_token()
+  {
+    while ( cursor < line.size() )
+    {
+      auto const c = line[cursor];
+      if ( is_whitespace( c ) )
+      {
+        ++cursor;
+      }
+      else if ( c == '/' && cursor + 1u < line.size() && line[cursor + 1u] == '*' )
+      {
+        auto const end = line.find( "*/", cursor + 2u );
+        cursor = end == std::string_view::npos ? line.size() : end + 2u;
+      }
+      else
+      {
+        break;
+      }
+    }
+
+    if ( cursor == line.size() )
+      return kind::eof;
+
+    auto const c = line[cursor];
+    switch ( c )
+    {
+    case '(':
+      ++cursor;
+      return kind::lparan;
+    case ')':
+      ++cursor;
+      return kind::rparan;
+    case '~': case '!': case 'X': case 'G': case 'F':
+      ++cursor;
+      op = c;
+      return kind::unary;
+    case '*': case '+': case '&': case '|': case 'U': case 'R':
+      ++cursor;
+      op = c;
+      return kind::binary;
+    case '-':
+      if ( cursor + 1u < line.size() && line[cursor + 1u] == '>' )
+      {
+        cursor += 2u;
+        op = '>';
+        return kind::binary;
+      }
+      return kind::error;
+    default:
+      break;
+    }
+
+    auto const begin = cursor;
+    while ( cursor < line.size() && !is_whitespace( line[cursor] ) && !is_operator( line[cursor] ) &&
+            !( line[cursor] == '/' && cursor + 1u < line.size() && line[cursor + 1u] == '*' ) )
+    {
+      ++cursor;
+    }
+    lexem = line.substr( begin, cursor - begin );
+    return ( ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || c == '_' ) ? kind::name : kind::error;
+  }
+
+  formula get_proposition( std::string_view name )
+  {
+    auto const it = cache.find( name );
+    if ( it != std::end( cache ) )
+      return it->second;
+
+    auto [names_it, inserted] = names.try_emplace( std::string( name ) );
+    if ( inserted )
+      names_it->second = ltl.create_variable();
+
+    cache.emplace( name, names_it->second );
+    return names_it->second;
+  }
+
+  formula apply_unary( char op, formula const& a )
+  {
+    switch ( op )
+    {
+    case 'X':
+      return ltl.create_next( a );
+    case 'F':
+      return ltl.create_eventually( a );
+    case 'G':
+      return ltl.create_globally( a );
+    default:
+      return !a;
+    }
+  }
+
+  formula apply_binary( char op, formula const& a, formula const& b )
+  {
+    switch ( op )
+    {
+    case '>':
+      return ltl.create_or( !a, b );
+    case '*': case '&':
+      return !ltl.create_or( !a, !b );
+    case 'U':
+      return ltl.create_until( a, b );
+    case 'R':
+      return ltl.create_releases( a, b );
+    default:
+      return ltl.create_or( a, b );
+    }
+  }
+
+  bool parse_line()
+  {
+    cursor = 0u;
+    stack.clear();
+
+    auto tok = next_token();
+    if ( tok == kind::eof )
+      return true;
+
+    formula current;
+    while ( true )
+    {
+      /* operand: sequence of unary operators and parentheses followed by a name */
+      while ( tok == kind::unary || tok == kind::lparan )
+      {
+        stack.emplace_back( frame{tok, op, {}} );
+        tok = next_token();
+      }
+
+      if ( tok != kind::name )
+        return false;
+      current = get_proposition( lexem );
+      tok = next_token();
+
+      /* a binary operator continues the formula to the right */
+      while ( tok != kind::binary )
+      {
+        /* the formula ends: apply pending operators up to the innermost parenthesis */
+        while ( !stack.empty() && stack.back().type != kind::lparan )
+        {
+          auto const& f = stack.back();
+          current = f.type == kind::binary ? apply_binary( f.op, f.left, current ) : apply_unary( f.op, current );
+          stack.pop_back();
+        }
+
+        if ( stack.empty() )
+        {
+          if ( tok != kind::eof )
+            return false;
+
+          ltl.create_formula( current );
+          return true;
+        }
+
+        if ( tok != kind::rparan )
+          return false;
+
+        stack.pop_back();
+        tok = next_token();
+      }
+
+      stack.emplace_back( frame{kind::binary, op, current} );
+      tok = next_token();
+    }
+  }
+
+protected:
+  ltl_formula_store& ltl;
+  std::map<std::string, formula>& names;
+  std::unordered_map<std::string_view, formula> cache;
+
+  std::string_view line;
+  std::size_t cursor{0u};
+  std::string_view lexem;
+  char op{0};
+
+  std::vector<frame> stack;
+}; /* ltl_buffer_parser */
+
+/*! \brief Copies the formulas of one store into another store
+ *
+ * Re-creates the nodes of `from` in index order in `to`, such that
+ * structural hashing in `to` merges shared subformulas.  Variables are
+ * identified by their names; variables unknown to `to_names` are
+ * created.  The formulas are added to `to` in their order in `from`.
+ */
+inline void copy_ltl_formulas( ltl_formula_store const& from, std::map<std::string, ltl_formula_store::ltl_formula> const& from_names,
+                               ltl_formula_store& to, std::map<std::string, ltl_formula_store::ltl_formula>& to_names )
+{
+  using formula = ltl_formula_store::ltl_formula;
+
+  std::vector<std::string const*> variable_names( from.num_nodes(), nullptr );
+  for ( const auto& [name, f] : from_names )
+  {
+    variable_names[f.index] = &name;
+  }
+
+  std::vector<formula> map( from.num_nodes() );
+  map[0u] = to.get_constant( false );
+
+  auto const mapped = [&]( formula const& f ){
+    return map[f.index] ^ bool( f.complement );
+  };
+
+  for ( auto n = 1u; n < from.num_nodes(); ++n )
+  {
+    if ( from.is_variable( n ) )
+    {
+      assert( variable_names[n] != nullptr );
+      auto [it, inserted] = to_names.try_emplace( *variable_names[n] );
+      if ( inserted )
+        it->second = to.create_variable();
+      map[n] = it->second;
+      continue;
+    }
+
+    std::array<formula,2> children;
+    from.foreach_fanin( n, [&]( const auto& f, uint32_t index ){
+        children[index] = mapped( f );
+      });
+
+    if ( from.is_or( n ) )
+      map[n] = to.create_or( children[0u], children[1u] );
+    else if ( from.is_and( n ) )
+      map[n] = to.create_and( children[0u], children[1u] );
+    else if ( from.is_next( n ) )
+      map[n] = to.create_next( children[0u] );
+    else if ( from.is_eventually( n ) )
+      map[n] = to.create_eventually( children[0u] );
+    else if ( from.is_until( n ) )
+      map[n] = to.create_until( children[0u], children[1u] );
+    else if ( from.is_releases( n ) )
+      map[n] = to.create_releases( children[0u], children[1u] );
+    else
+      assert( false && "unknown operator" );
+  }
+
+  from.foreach_formula( [&]( formula const& f ){
+      to.create_formula( mapped( f ) );
+      return true;
+    });
+}
+
+} /* namespace detail */
+
+/*! \brief Reads LTL formulas from a buffer into an LTL formula store
+ *
+ * Propositions are looked up by name in `names`; unknown propositions
+ * are created as new variables and added to `names`.
+ */
+inline return_code read_ltl_formulas( std::string_view buffer, ltl_formula_store& ltl,
+                                      std::map<std::string, ltl_formula_store::ltl_formula>& names )
+{
+  return detail::ltl_buffer_parser( ltl, names ).parse( buffer );
+}
+
+/*! \brief Reads LTL formulas from an input stream into an LTL formula store */
+inline return_code read_ltl_formulas( std::istream& in, ltl_formula_store& ltl,
+                                      std::map<std::string, ltl_formula_store::ltl_formula>& names )
+{
+  std::string const buffer( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>{} );
+  return read_ltl_formulas( std::string_view( buffer ), ltl, names );
+}
+
+/*! \brief Reads LTL formulas from a file into an LTL formula store */
+inline return_code read_ltl_formulas( std::string const& filename, ltl_formula_store& ltl,
+                                      std::map<std::string, ltl_formula_store::ltl_formula>& names )
+{
+  memory_mapped_file const file( filename );
+  if ( !file.good() )
+    return return_code::parse_error;
+  return read_ltl_formulas( file.view(), ltl, names );
+}
+
+/*! \brief Reads LTL formulas from a buffer using multiple threads
+ *
+ * Splits the buffer at line boundaries into chunks, parses each chunk
+ * into a thread-local store, and merges the local stores in order
+ * into `ltl`.  The result is the same as for `read_ltl_formulas`:
+ * shared subformulas are stored once and the formulas appear in the
+ * order of the buffer.
+ */
+inline return_code read_ltl_formulas_parallel( std::string_view buffer, ltl_formula_store& ltl,
+                                               std::map<std::string, ltl_formula_store::ltl_formula>& names,
+                                               uint32_t num_threads = std::thread::hardware_concurrency() )
+{
+  using names_t = std::map<std::string, ltl_formula_store::ltl_formula>;
+
+  auto const chunks = split_at_lines( buffer, buffer.size() / std::max( num_threads, 1u ) + 1u );
+
+  std::vector<ltl_formula_store> stores( chunks.size() );
+  std::vector<names_t> local_names( chunks.size() );
+  std::vector<return_code> results( chunks.size(), return_code::success );
+
+  std::vector<std::thread> threads;
+  threads.reserve( chunks.size() );
+  for ( auto i = 0u; i < chunks.size(); ++i )
+  {
+    threads.emplace_back( [&, i](){
+        results[i] = read_ltl_formulas( chunks[i], stores[i], local_names[i] );
+      });
+  }
+  for ( auto& t : threads )
+  {
+    t.join();
+  }
+
+  /* merge in order; a failing chunk contains the formulas before the parse error */
+  for ( auto i = 0u; i < chunks.size(); ++i )
+  {
+    detail::copy_ltl_formulas( stores[i], local_names[i], ltl, names );
+    if ( results[i] != return_code::success )
+      return results[i];
+  }
+  return return_code::success;
+}
+
+/*! \brief Reads LTL formulas from a file using multiple threads */
+inline return_code read_ltl_formulas_parallel( std::string const& filename, ltl_formula_store& ltl,
+                                               std::map<std::string, ltl_formula_store::ltl_formula>& names,
+                                               uint32_t num_threads = std::thread::hardware_concurrency() )
+{
+  memory_mapped_file const file( filename );
+  if ( !file.good() )
+    return return_code::parse_error;
+  return read_ltl_formulas_parallel( file.view(), ltl, names, num_threads );
+}
+
 } /* copycat */
@@ -32,11 +32,22 @@
 
 #pragma once
 
+#include <copycat/algorithms/exact_ltl_traits.hpp>
 #include <copycat/io/traces.hpp>
 #include <copycat/trace.hpp>
+#include <copycat/utils/memory_mapped_file.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <iostream>
+#include <iterator>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
-#include <iostream>
 
 namespace copycat
 {
@@ -52,6 +63,111 @@ struct ltl_synthesis_spec
   uint32_t num_propositions = 0u;
 }; /* ltl_synthesis_spec */
 
+/*! \brief Enables all operators if no operators have been specified */
+inline void ensure_default_operators( ltl_synthesis_spec& spec )
+{
+  if ( spec.operators.size() == 0u )
+  {
+    spec.operators.emplace_back( copycat::operator_opcode::not_ );
+    spec.operators.emplace_back( copycat::operator_opcode::next_ );
+    spec.operators.emplace_back( copycat::operator_opcode::and_ );
+    spec.operators.emplace_back( copycat::operator_opcode::or_ );
+    spec.operators.emplace_back( copycat::operator_opcode::implies_ );
+    spec.operators.emplace_back( copycat::operator_opcode::until_ );
+    spec.operators.emplace_back( copycat::operator_opcode::eventually_ );
+    spec.operators.emplace_back( copycat::operator_opcode::globally_ );
+  }
+}
+
+/*! \brief Maps an operator symbol of a spec to an opcode */
+inline std::optional<operator_opcode> operator_opcode_from_string( std::string_view op )
+{
+  if ( op == "!" || op == "~" )
+    return operator_opcode::not_;
+  else if ( op == "&" )
+    return operator_opcode::and_;
+  else if ( op == "|" )
+    return operator_opcode::or_;
+  else if ( op == "->" )
+    return operator_opcode::implies_;
+  else if ( op == "X" )
+    return operator_opcode::next_;
+  else if ( op == "U" )
+    return operator_opcode::until_;
+  else if ( op == "F" )
+    return operator_opcode::eventually_;
+  else if ( op == "G" )
+    return operator_opcode::globally_;
+  return std::nullopt;
+}
+
+/*! \brief Reads operator weights from the parameter section of a spec
+ *
+ * Each parameter of the form `<op>:<weight>` or `<op>=<weight>`
+ * assigns a positive integer weight to an operator.  Other
+ * parameters are ignored.  Operators of the spec without a weight get
+ * weight 1; if no parameter specifies a weight, the result is empty.
+ */
+inline std::unordered_map<operator_opcode, uint32_t> read_operator_weights( ltl_synthesis_spec const& spec )
+{
+  std::unordered_map<operator_opcode, uint32_t> weights;
+  for ( const auto& parameter : spec.parameters )
+  {
+    auto const pos = parameter.find_first_of( ":=" );
+    if ( pos == std::string::npos )
+      continue;
+
+    auto const op = detail::trim_view( std::string_view( parameter ).substr( 0, pos ) );
+    auto const value = detail::trim_view( std::string_view( parameter ).substr( pos + 1u ) );
+    auto const opcode = operator_opcode_from_string( op );
+    if ( !opcode || value.empty() || !std::all_of( value.begin(), value.end(), []( char c ){ return std::isdigit( static_cast<unsigned char>( c ) ) != 0; } ) ||
+         std::all_of( value.begin(), value.end(), []( char c ){ return c == '0'; } ) )
+    {
+      std::cout << fmt::format( "[w] ignore parameter `{}'\n", parameter );
+      continue;
+    }
+    weights[*opcode] = std::stoul( std::string( value ) );
+  }
+
+  if ( !weights.empty() )
+  {
+    for ( const auto& op : spec.operators )
+      weights.emplace( op, 1u );
+  }
+  return weights;
+}
+
+namespace detail
+{
+
+/*! \brief Creates a trace from a prefix and a suffix */
+inline trace make_trace( std::vector<std::vector<int>> const& prefix,
+                         std::vector<std::vector<int>> const& suffix )
+{
+  trace t;
+  t._data.reserve( prefix.size() + suffix.size() );
+  for ( const auto& p : prefix )
+    t.emplace_prefix( p );
+  for ( const auto& s : suffix )
+    t.emplace_suffix( s );
+  return t;
+}
+
+/*! \brief Parses a chunk of trace lines; returns the number of propositions */
+inline uint32_t parse_trace_chunk( std::string_view chunk, std::vector<trace>& traces )
+{
+  uint32_t num_propositions = 0u;
+  trace_line_parser trace_line;
+  foreach_line( chunk, [&]( std::string_view line ){
+      trace_line.parse( line, num_propositions );
+      traces.emplace_back( make_trace( trace_line.prefix(), trace_line.suffix() ) );
+      return true;
+    });
+  return num_propositions;
+}
+
+} /* namespace detail */
+
 class ltl_synthesis_spec_reader : public trace_reader
 {
 public:
@@ -63,17 +179,7 @@ public:
   ~ltl_synthesis_spec_reader()
   {
     /* if no operators have been specified, then enable everything */
-    if ( _spec.operators.size() == 0u )
-    {
-      _spec.operators.emplace_back( copycat::operator_opcode::not_ );
-      _spec.operators.emplace_back( copycat::operator_opcode::next_ );
-      _spec.operators.emplace_back( copycat::operator_opcode::and_ );
-      _spec.operators.emplace_back( copycat::operator_opcode::or_ );
-      _spec.operators.emplace_back( copycat::operator_opcode::implies_ );
-      _spec.operators.emplace_back( copycat::operator_opcode::until_ );
-      _spec.operators.emplace_back( copycat::operator_opcode::eventually_ );
-      _spec.operators.emplace_back( copycat::operator_opcode::globally_ );
-    }
+    ensure_default_operators( _spec );
   }
 
   virtual void set_num_propositions( uint32_t num_propositions ) const override
@@ -84,43 +190,19 @@ public:
   void on_good_trace( std::vector<std::vector<int>> const& prefix,
                       std::vector<std::vector<int>> const& suffix ) const override
   {
-    trace t;
-    for ( const auto& p : prefix )
-      t.emplace_prefix( p );
-    for ( const auto& s : suffix )
-      t.emplace_suffix( s );
-    _spec.good_traces.emplace_back( t );
+    _spec.good_traces.emplace_back( detail::make_trace( prefix, suffix ) );
   }
 
   void on_bad_trace( std::vector<std::vector<int>> const& prefix,
                      std::vector<std::vector<int>> const& suffix ) const override
   {
-    trace t;
-    for ( const auto& p : prefix )
-      t.emplace_prefix( p );
-    for ( const auto& s : suffix )
-      t.emplace_suffix( s );
-    _spec.bad_traces.emplace_back( t );
+    _spec.bad_traces.emplace_back( detail::make_trace( prefix, suffix ) );
   }
 
   void on_operator( std::string const& op ) const override
   {
-    if ( op == "!" )
-      _spec.operators.emplace_back( operator_opcode::not_ );
-    else if ( op == "&" )
-      _spec.operators.emplace_back( operator_opcode::and_ );
-    else if ( op == "|" )
-      _spec.operators.emplace_back( operator_opcode::or_ );
-    else if ( op == "->" )
-      _spec.operators.emplace_back( operator_opcode::implies_ );
-    else if ( op == "X" )
-      _spec.operators.emplace_back( operator_opcode::next_ );
-    else if ( op == "U" )
-      _spec.operators.emplace_back( operator_opcode::until_ );
-    else if ( op == "F" )
-      _spec.operators.emplace_back( operator_opcode::eventually_ );
-    else if ( op == "G" )
-      _spec.operators.emplace_back( operator_opcode::globally_ );
+    if ( auto const opcode = operator_opcode_from_string( op ) )
+      _spec.operators.emplace_back( *opcode );
     else
       std::cout << fmt::format( "[w] unsupported operator `{}'\n", op );
   }
@@ -140,15 +222,93 @@ private:
 }; /* ltl_synthesis_spec_reader */
 
 /*! \brief Read LTL synthesis spec from an input stream */
-bool read_ltl_synthesis_spec( std::istream& is, ltl_synthesis_spec& spec )
+inline bool read_ltl_synthesis_spec( std::istream& is, ltl_synthesis_spec& spec )
 {
   return read_traces( is, ltl_synthesis_spec_reader( spec ) );
 }
 
 /*! \brief Read LTL synthesis spec from a file */
-bool read_ltl_synthesis_spec( std::string const& filename, ltl_synthesis_spec& spec )
+inline bool read_ltl_synthesis_spec( std::string const& filename, ltl_synthesis_spec& spec )
 {
   return read_traces( filename, ltl_synthesis_spec_reader( spec ) );
 }
 
+/*! \brief Read LTL synthesis spec from a file using multiple threads
+ *
+ * Maps the file into memory, splits the good and bad trace sections
+ * at line boundaries into chunks, and parses the chunks concurrently.
+ * The traces are merged into `spec` in the order of the file.  The
+ * remaining sections are small and read sequentially.
+ */
+inline bool read_ltl_synthesis_spec_parallel( std::string const& filename, ltl_synthesis_spec& spec,
+                                              uint32_t num_threads = std::thread::hardware_concurrency() )
+{
+  memory_mapped_file const file( filename );
+  if ( !file.good() )
+  {
+    std::cerr << "[e] could not open file: " << filename << std::endl;
+    return false;
+  }
+  auto const buffer = file.view();
+
+  /* locate the good and bad trace sections */
+  std::array<std::string_view, 2u> sections;
+  std::string_view tail;
+
+  uint32_t num_sections = 0u;
+  std::size_t section_begin = 0u;
+  foreach_line( buffer, [&]( std::string_view line ){
+      if ( !detail::is_separator_line( line ) )
+        return true;
+
+      auto const line_begin = std::size_t( line.data() - buffer.data() );
+      sections[num_sections++] = buffer.substr( section_begin, line_begin - section_begin );
+      section_begin = std::min( buffer.size(), line_begin + line.size() + 1u );
+      return num_sections < 2u;
+    });
+
+  if ( num_sections < 2u )
+    sections[num_sections] = buffer.substr( section_begin );
+  else
+    tail = buffer.substr( section_begin );
+
+  /* split sections into chunks */
+  auto const chunk_size = ( sections[0u].size() + sections[1u].size() ) / std::max( num_threads, 1u ) + 1u;
+  auto const good_chunks = split_at_lines( sections[0u], chunk_size );
+  auto const bad_chunks = split_at_lines( sections[1u], chunk_size );
+
+  std::vector<std::string_view> chunks( good_chunks );
+  chunks.insert( std::end( chunks ), std::begin( bad_chunks ), std::end( bad_chunks ) );
+
+  /* parse chunks in parallel */
+  std::vector<std::vector<trace>> traces( chunks.size() );
+  std::vector<uint32_t> num_propositions( chunks.size(), 0u );
+  std::vector<std::thread> threads;
+  threads.reserve( chunks.size() );
+  for ( auto i = 0u; i < chunks.size(); ++i )
+  {
+    threads.emplace_back( [&, i](){
+        num_propositions[i] = detail::parse_trace_chunk( chunks[i], traces[i] );
+      });
+  }
+  for ( auto& t : threads )
+  {
+    t.join();
+  }
+
+  /* read the remaining sections */
+  if ( !read_traces_from_buffer( tail, ltl_synthesis_spec_reader( spec ), trace_section::operators ) )
+    return false;
+
+  /* merge in order */
+  for ( auto i = 0u; i < chunks.size(); ++i )
+  {
+    auto& dest = i < good_chunks.size() ? spec.good_traces : spec.bad_traces;
+    dest.insert( std::end( dest ), std::make_move_iterator( std::begin( traces[i] ) ), std::make_move_iterator( std::end( traces[i] ) ) );
+    spec.num_propositions = std::max( spec.num_propositions, num_propositions[i] );
+  }
+
+  return true;
+}
+
 } /* copycat */
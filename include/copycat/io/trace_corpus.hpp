@@ -0,0 +1,365 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file trace_corpus.hpp
+  \brief Binary columnar trace corpus
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include <copycat/io/ltl_synthesis_spec_reader.hpp>
+#include <copycat/trace.hpp>
+#include <copycat/utils/memory_mapped_file.hpp>
+#include <fmt/format.h>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace copycat
+{
+
+/*! \brief Header of a binary trace corpus
+ *
+ * A trace corpus consists of
+ *
+ *   1. the header,
+ *   2. an index with one `trace_corpus_entry` per trace (good traces
+ *      first, then bad traces), and
+ *   3. the trace data.
+ *
+ * The data of a trace of length `l` consists of one bit-column per
+ * proposition, each stored as `ceil(l/64)` 64-bit words; bit `k` of
+ * the column of proposition `p` is set if and only if `p` holds in
+ * time step `k`.  All numbers are stored in native byte order.
+ */
+struct trace_corpus_header
+{
+  std::array<char, 8u> magic;
+  uint32_t version;
+  uint32_t num_propositions;
+  uint64_t num_good_traces;
+  uint64_t num_bad_traces;
+}; /* trace_corpus_header */
+
+/*! \brief Index entry of a trace in a binary trace corpus */
+struct trace_corpus_entry
+{
+  uint64_t offset;
+  uint32_t length;
+  uint32_t prefix_length;
+}; /* trace_corpus_entry */
+
+inline constexpr std::array<char, 8u> trace_corpus_magic = { 'C', 'C', 'T', 'R', 'A', 'C', 'E', '\0' };
+inline constexpr uint32_t trace_corpus_version = 1u;
+
+namespace detail
+{
+
+inline uint64_t trace_corpus_num_words( uint32_t length )
+{
+  return ( uint64_t( length ) + 63u ) / 64u;
+}
+
+} /* namespace detail */
+
+/*! \brief Writes the traces of a spec as binary trace corpus */
+inline bool write_trace_corpus( std::ostream& os, ltl_synthesis_spec const& spec )
+{
+  auto const num_propositions = spec.num_propositions;
+
+  /* check the propositions before writing anything */
+  for ( const auto& traces : { std::cref( spec.good_traces ), std::cref( spec.bad_traces ) } )
+  {
+    for ( const auto& t : traces.get() )
+    {
+      for ( const auto& step : t._data )
+      {
+        for ( const auto& p : step )
+        {
+          if ( p <= 0 || uint32_t( p ) > num_propositions )
+          {
+            std::cerr << fmt::format( "[e] proposition {} is out of range [1,{}]\n", p, num_propositions );
+            return false;
+          }
+        }
+      }
+    }
+  }
+
+  trace_corpus_header header;
+  header.magic = trace_corpus_magic;
+  header.version = trace_corpus_version;
+  header.num_propositions = num_propositions;
+  header.num_good_traces = spec.good_traces.size();
+  header.num_bad_traces = spec.bad_traces.size();
+  os.write( reinterpret_cast<char const*>( &header ), sizeof( header ) );
+
+  /* index */
+  uint64_t offset = sizeof( trace_corpus_header ) + ( spec.good_traces.size() + spec.bad_traces.size() ) * sizeof( trace_corpus_entry );
+  auto const write_entry = [&]( trace const& t ){
+    trace_corpus_entry entry;
+    entry.offset = offset;
+    entry.length = t.length();
+    entry.prefix_length = t.is_finite() ? entry.length : t.prefix_length();
+    os.write( reinterpret_cast<char const*>( &entry ), sizeof( entry ) );
+    offset += num_propositions * detail::trace_corpus_num_words( entry.length ) * sizeof( uint64_t );
+  };
+  for ( const auto& t : spec.good_traces )
+    write_entry( t );
+  for ( const auto& t : spec.bad_traces )
+    write_entry( t );
+
+  /* data */
+  std::vector<uint64_t> columns;
+  auto const write_data = [&]( trace const& t ){
+    auto const num_words = detail::trace_corpus_num_words( t.length() );
+    columns.assign( num_propositions * num_words, 0u );
+    for ( auto k = 0u; k < t.length(); ++k )
+    {
+      for ( const auto& p : t._data[k] )
+      {
+        columns[( p - 1 ) * num_words + k / 64u] |= uint64_t( 1 ) << ( k % 64u );
+      }
+    }
+    os.write( reinterpret_cast<char const*>( columns.data() ), columns.size() * sizeof( uint64_t ) );
+  };
+  for ( const auto& t : spec.good_traces )
+    write_data( t );
+  for ( const auto& t : spec.bad_traces )
+    write_data( t );
+
+  return bool( os );
+}
+
+/*! \brief Writes the traces of a spec as binary trace corpus into a file */
+inline bool write_trace_corpus( std::string const& filename, ltl_synthesis_spec const& spec )
+{
+  std::ofstream ofs( filename, std::ios::out | std::ios::binary );
+  return write_trace_corpus( ofs, spec );
+}
+
+/*! \brief Binary trace corpus
+ *
+ * Memory-maps a binary trace corpus and materializes traces only on
+ * request.  Single values can be queried without materializing the
+ * trace.  A trace is finite if its prefix length equals its length.
+ */
+class trace_corpus
+{
+public:
+  explicit trace_corpus( std::string const& filename )
+    : file( filename )
+  {
+    auto const buffer = file.view();
+    if ( !file.good() || buffer.size() < sizeof( trace_corpus_header ) )
+    {
+      std::cerr << fmt::format( "[e] could not read trace corpus `{}'\n", filename );
+      return;
+    }
+
+    std::memcpy( &header, buffer.data(), sizeof( header ) );
+    if ( header.magic != trace_corpus_magic || header.version != trace_corpus_version )
+    {
+      std::cerr << fmt::format( "[e] `{}' is not a trace corpus\n", filename );
+      return;
+    }
+
+    uint64_t const max_traces = ( buffer.size() - sizeof( trace_corpus_header ) ) / sizeof( trace_corpus_entry );
+    if ( header.num_good_traces > max_traces || header.num_bad_traces > max_traces - header.num_good_traces )
+    {
+      std::cerr << fmt::format( "[e] trace corpus `{}' is truncated\n", filename );
+      return;
+    }
+
+    /* every trace must lie within the data section */
+    uint64_t const index_end = sizeof( trace_corpus_header ) + num_traces() * sizeof( trace_corpus_entry );
+    for ( uint64_t i = 0u; i < num_traces(); ++i )
+    {
+      auto const e = entry( i );
+      if ( e.prefix_length > e.length || e.offset < index_end || e.offset > buffer.size() ||
+           data_size( e ) > buffer.size() - e.offset )
+      {
+        std::cerr << fmt::format( "[e] trace {} of trace corpus `{}' is out of bounds\n", i, filename );
+        return;
+      }
+    }
+
+    _good = true;
+  }
+
+  /*! \brief Returns true if and only if the corpus has been read successfully */
+  bool good() const
+  {
+    return _good;
+  }
+
+  uint32_t num_propositions() const
+  {
+    return header.num_propositions;
+  }
+
+  uint64_t num_good_traces() const
+  {
+    return header.num_good_traces;
+  }
+
+  uint64_t num_bad_traces() const
+  {
+    return header.num_bad_traces;
+  }
+
+  uint64_t num_traces() const
+  {
+    return header.num_good_traces + header.num_bad_traces;
+  }
+
+  /*! \brief Returns true if and only if the i-th trace is a good trace */
+  bool is_good( uint64_t index ) const
+  {
+    return index < header.num_good_traces;
+  }
+
+  uint32_t length( uint64_t index ) const
+  {
+    return entry( index ).length;
+  }
+
+  uint32_t prefix_length( uint64_t index ) const
+  {
+    return entry( index ).prefix_length;
+  }
+
+  /*! \brief Returns true if and only if proposition `prop` holds in time step `time_index` of the i-th trace */
+  bool has( uint64_t index, uint32_t time_index, uint32_t prop ) const
+  {
+    auto const e = entry( index );
+    assert( time_index < e.length );
+    assert( prop > 0u && prop <= num_propositions() );
+    auto const word = ( prop - 1u ) * detail::trace_corpus_num_words( e.length ) + time_index / 64u;
+    return ( read_word( e.offset + word * sizeof( uint64_t ) ) >> ( time_index % 64u ) ) & 1u;
+  }
+
+  /*! \brief Materializes the i-th trace */
+  trace get_trace( uint64_t index ) const
+  {
+    auto const e = entry( index );
+    auto const num_words = detail::trace_corpus_num_words( e.length );
+
+    std::vector<std::vector<int32_t>> steps( e.length );
+    for ( auto p = 0u; p < num_propositions(); ++p )
+    {
+      for ( auto w = 0u; w < num_words; ++w )
+      {
+        auto bits = read_word( e.offset + ( p * num_words + w ) * sizeof( uint64_t ) );
+        while ( bits )
+        {
+          auto const k = w * 64u + __builtin_ctzll( bits );
+          steps[k].emplace_back( p + 1 );
+          bits &= bits - 1u;
+        }
+      }
+    }
+
+    trace t;
+    t._data.reserve( e.length );
+    for ( auto k = 0u; k < e.length; ++k )
+    {
+      if ( k < e.prefix_length )
+        t.emplace_prefix( steps[k] );
+      else
+        t.emplace_suffix( steps[k] );
+    }
+    return t;
+  }
+
+  trace get_good_trace( uint64_t index ) const
+  {
+    assert( index < num_good_traces() );
+    return get_trace( index );
+  }
+
+  trace get_bad_trace( uint64_t index ) const
+  {
+    assert( index < num_bad_traces() );
+    return get_trace( num_good_traces() + index );
+  }
+
+  /*! \brief Materializes all traces into a spec */
+  void load( ltl_synthesis_spec& spec ) const
+  {
+    spec.num_propositions = std::max( spec.num_propositions, num_propositions() );
+    spec.good_traces.reserve( spec.good_traces.size() + num_good_traces() );
+    spec.bad_traces.reserve( spec.bad_traces.size() + num_bad_traces() );
+    for ( uint64_t i = 0u; i < num_traces(); ++i )
+    {
+      ( is_good( i ) ? spec.good_traces : spec.bad_traces ).emplace_back( get_trace( i ) );
+    }
+  }
+
+protected:
+  trace_corpus_entry entry( uint64_t index ) const
+  {
+    assert( index < num_traces() );
+    trace_corpus_entry e;
+    std::memcpy( &e, file.view().data() + sizeof( trace_corpus_header ) + index * sizeof( trace_corpus_entry ), sizeof( e ) );
+    return e;
+  }
+
+  uint64_t data_size( trace_corpus_entry const& e ) const
+  {
+    return num_propositions() * detail::trace_corpus_num_words( e.length ) * sizeof( uint64_t );
+  }
+
+  uint64_t read_word( uint64_t offset ) const
+  {
+    uint64_t word;
+    std::memcpy( &word, file.view().data() + offset, sizeof( word ) );
+    return word;
+  }
+
+protected:
+  memory_mapped_file file;
+  trace_corpus_header header{};
+  bool _good{false};
+}; /* trace_corpus */
+
+/*! \brief Converts a text trace file into a binary trace corpus */
+inline bool convert_traces_to_corpus( std::string const& trace_filename, std::string const& corpus_filename )
+{
+  ltl_synthesis_spec spec;
+  if ( !read_ltl_synthesis_spec_parallel( trace_filename, spec ) )
+    return false;
+  return write_trace_corpus( corpus_filename, spec );
+}
+
+} /* namespace copycat */
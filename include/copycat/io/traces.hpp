@@ -32,20 +32,20 @@
 
 #pragma once
 
+#include "../utils/memory_mapped_file.hpp"
+#include "../utils/string_utils.hpp"
+#include <cassert>
+#include <cctype>
 #include <fstream>
 #include <iostream>
-#include <regex>
 #include <sstream>
-#include <cassert>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace copycat
 {
 
-namespace trace_regex
-{
-  static std::regex separator_line( R"(^-+$)" );
-} /* namespace trace_regex */
-
 class trace_reader
 {
 public:
@@ -106,6 +106,11 @@ public:
     return index;
   }
 
+  uint32_t num_sections() const
+  {
+    return sections.size();
+  }
+
   std::string section_name( uint32_t section_index ) const
   {
     assert( section_index < sections.size() );
@@ -122,158 +127,273 @@ private:
   std::vector<section> sections;
 };
 
+/*! \brief Sections of a trace file in the order of their appearance */
+enum class trace_section : uint32_t
+{
+  good_traces  = 0u,
+  bad_traces   = 1u,
+  operators    = 2u,
+  parameter    = 3u,
+  verification = 4u,
+}; /* trace_section */
+
 namespace detail
 {
-  std::vector<std::string> split_string( std::string const& input_string, std::string const& delimiter )
+  /*! \brief Removes leading and trailing whitespace without copying */
+  inline std::string_view trim_view( std::string_view s, std::string_view whitespace = " \t" )
   {
-    uint64_t curr, prev = 0;
-    curr = input_string.find( delimiter );
+    auto const beg = s.find_first_not_of( whitespace );
+    if ( beg == std::string_view::npos )
+      return std::string_view();
 
-    std::vector<std::string> result;
-    while ( curr != std::string::npos )
-    {
-      result.emplace_back( input_string.substr( prev, curr - prev ) );
-      prev = curr + delimiter.size();
-      curr = input_string.find( delimiter, prev );
-    }
-    result.emplace_back( input_string.substr( prev, curr - prev ) );
-
-    return result;
+    auto const end = s.find_last_not_of( whitespace );
+    return s.substr( beg, end - beg + 1u );
   }
 
-  std::string trim( std::string const& input_string, std::string const& whitespace = " \t" )
+  /*! \brief Parses a decimal integer prefix (like `std::atoi`) */
+  inline int32_t parse_int( std::string_view s )
   {
-    auto const beg = input_string.find_first_not_of( whitespace );
-    if ( beg == std::string::npos )
-      return std::string();
+    std::size_t i = 0u;
+    while ( i < s.size() && std::isspace( static_cast<unsigned char>( s[i] ) ) )
+      ++i;
+
+    bool negative = false;
+    if ( i < s.size() && ( s[i] == '+' || s[i] == '-' ) )
+      negative = s[i++] == '-';
+
+    int64_t value = 0;
+    while ( i < s.size() && s[i] >= '0' && s[i] <= '9' )
+      value = 10 * value + ( s[i++] - '0' );
+
+    return static_cast<int32_t>( negative ? -value : value );
+  }
 
-    auto const end = input_string.find_last_not_of( whitespace );
-    auto const range = end - beg + 1u;
-    return input_string.substr( beg, range );
+  /*! \brief Returns true if and only if the line matches `^-+$` */
+  inline bool is_separator_line( std::string_view line )
+  {
+    return !line.empty() && line.find_first_not_of( '-' ) == std::string_view::npos;
   }
 
-  std::vector<std::vector<int>> parse_trace( std::string const& trace_string, uint32_t& num_propositions )
+  /*! \brief In-place parser for a single trace line
+   *
+   * A trace line has the form `s_0;s_1;...;s_k[::l]`, where each time
+   * step `s_i` is a comma-separated list of fields and `l` is the
+   * start of the lasso.  The i-th field of a time step denotes that
+   * proposition i+1 holds if it is exactly `1`.  Time steps before the
+   * lasso start are stored in the prefix, all others in the suffix.
+   * The time step vectors are reused between lines.
+   */
+  class trace_line_parser
   {
-    std::vector<std::vector<int>> trace_data;
-    auto const time_steps = split_string( trace_string, ";" );
-    for ( const auto& time_step : time_steps )
+  public:
+    void parse( std::string_view line, uint32_t& num_propositions )
     {
-      auto const signals = split_string( time_step, "," );
-      std::vector<int> signal_data;
-      for ( auto i = 0u; i < signals.size(); ++i )
+      auto const lasso_pos = line.find( "::" );
+      auto const lasso_start = lasso_pos != std::string_view::npos ? uint32_t( parse_int( line.substr( lasso_pos + 2u ) ) ) : 0u;
+      auto const steps = line.substr( 0u, lasso_pos );
+
+      num_prefix = num_suffix = 0u;
+      auto* step = &next_step( lasso_start );
+
+      uint32_t field = 0u;
+      std::size_t field_start = 0u;
+      for ( std::size_t i = 0u; i <= steps.size(); ++i )
       {
-        if ( signals.at( i ) == "1" )
+        char const c = i < steps.size() ? steps[i] : ';';
+        if ( c != ',' && c != ';' )
+          continue;
+
+        if ( i - field_start == 1u && steps[field_start] == '1' )
         {
-          signal_data.emplace_back( i + 1 );
-          if ( num_propositions < i + 1 )
-            num_propositions = i + 1;
+          step->emplace_back( field + 1 );
+          if ( num_propositions < field + 1 )
+            num_propositions = field + 1;
+        }
+
+        field_start = i + 1u;
+        ++field;
+
+        if ( c == ';' && i < steps.size() )
+        {
+          step = &next_step( lasso_start );
+          field = 0u;
         }
       }
-      trace_data.emplace_back( signal_data );
-    }
-    return trace_data;
-  }
-} /* detail */
+      assert( lasso_start < num_prefix + num_suffix );
 
-bool read_traces( std::istream& is, trace_reader const& reader )
-{
-  using trace_t = std::vector<std::vector<int>>;
+      _prefix.resize( num_prefix );
+      _suffix.resize( num_suffix );
+    }
 
-  trace_parser parser;
+    std::vector<std::vector<int>> const& prefix() const
+    {
+      return _prefix;
+    }
 
-  uint32_t num_propositions = 0u;
-  auto const good_section = parser.create_section( "Good traces", 1u );
-  auto const bad_section = parser.create_section( "Bad traces", 2u );
-  auto const operator_section = parser.create_section( "Operators", 3u );
-  auto const parameter_section = parser.create_section( "Parameter", 4u );
-  auto const verify_section = parser.create_section( "Verification", 5u );
+    std::vector<std::vector<int>> const& suffix() const
+    {
+      return _suffix;
+    }
 
-  uint32_t curr_section = good_section;
-  // std::cout << "===--- " << parser.section_name( curr_section ) << " ---===" << std::endl;
+  private:
+    std::vector<int>& next_step( uint32_t lasso_start )
+    {
+      auto& steps = num_prefix < lasso_start ? _prefix : _suffix;
+      auto& count = num_prefix < lasso_start ? num_prefix : num_suffix;
+      if ( count == steps.size() )
+        steps.emplace_back();
+      auto& step = steps[count++];
+      step.clear();
+      return step;
+    }
 
-  std::string line;
-  while ( std::getline( is, line ) )
+  private:
+    std::vector<std::vector<int>> _prefix;
+    std::vector<std::vector<int>> _suffix;
+    uint32_t num_prefix{0u};
+    uint32_t num_suffix{0u};
+  }; /* trace_line_parser */
+
+  /*! \brief Line-by-line parser for the sections of a trace file
+   *
+   * Keeps track of the current section and dispatches each line to
+   * the reader.  The parser does not own any input; it is shared by
+   * the buffer and the stream front-ends.
+   */
+  class trace_file_parser
   {
-    if ( std::regex_match( line, trace_regex::separator_line ) )
+  public:
+    explicit trace_file_parser( trace_reader const& reader, trace_section first_section )
+      : reader( reader )
+      , curr_section( static_cast<uint32_t>( first_section ) )
     {
-      curr_section = parser.next_section( curr_section );
-      // std::cout << "===--- " << parser.section_name( curr_section ) << " ---===" << std::endl;
+      good_section = parser.create_section( "Good traces", 1u );
+      bad_section = parser.create_section( "Bad traces", 2u );
+      operator_section = parser.create_section( "Operators", 3u );
+      parameter_section = parser.create_section( "Parameter", 4u );
+      verify_section = parser.create_section( "Verification", 5u );
     }
-    else
+
+    /*! \brief Parses one line (without line terminator), returns false on error */
+    bool parse_line( std::string_view line )
     {
-      if ( curr_section == good_section )
+      if ( is_separator_line( line ) )
       {
-        /* split line by :: into prefix and suffix*/
-        auto const affixes = detail::split_string( line, "::" );
-        assert( affixes.size() <= 2u );
-
-        auto const lasso_start = affixes.size() >= 2u ? std::atoi( affixes[1u].c_str() ) : 0u;
-        trace_t const t = detail::parse_trace( affixes[0u], num_propositions );
-        assert( lasso_start < t.size() );
-
-        if ( lasso_start > 0u )
-        {
-          trace_t prefix( t.begin(), t.begin() + lasso_start );
-          trace_t suffix( t.begin() + lasso_start, t.end() );
-          reader.on_good_trace( prefix, suffix );
-        }
-        else
-        {
-          reader.on_good_trace( {}, t );
-        }
+        if ( curr_section < parser.num_sections() )
+          curr_section = parser.next_section( curr_section );
+      }
+      else if ( curr_section == good_section )
+      {
+        trace_line.parse( line, num_propositions );
+        reader.on_good_trace( trace_line.prefix(), trace_line.suffix() );
       }
       else if ( curr_section == bad_section )
       {
-        /* split line by :: into prefix and suffix*/
-        auto const affixes = detail::split_string( line, "::" );
-        assert( affixes.size() <= 2u );
-
-        auto const lasso_start = affixes.size() >= 2u ? std::atoi( affixes[1u].c_str() ) : 0u;
-        trace_t const t = detail::parse_trace( affixes[0u], num_propositions );
-        assert( lasso_start < t.size() );
-
-        if ( lasso_start > 0u )
-        {
-          trace_t prefix( t.begin(), t.begin() + lasso_start );
-          trace_t suffix( t.begin() + lasso_start, t.end() );
-          reader.on_bad_trace( prefix, suffix );
-        }
-        else
-        {
-          reader.on_bad_trace( {}, t );
-        }
+        trace_line.parse( line, num_propositions );
+        reader.on_bad_trace( trace_line.prefix(), trace_line.suffix() );
       }
       else if ( curr_section == operator_section )
       {
-        auto operators = detail::split_string( line, "," );
-        for ( const auto& op : operators )
-          reader.on_operator( detail::trim( op ) );
+        std::size_t op_pos = 0u;
+        while ( true )
+        {
+          auto const op_end = line.find( ',', op_pos );
+          reader.on_operator( std::string( trim_view( line.substr( op_pos, op_end - op_pos ) ) ) );
+          if ( op_end == std::string_view::npos )
+            break;
+          op_pos = op_end + 1u;
+        }
       }
       else if ( curr_section == parameter_section )
       {
-        reader.on_parameter( detail::trim( line ) );
+        reader.on_parameter( std::string( trim_view( line ) ) );
       }
       else if ( curr_section == verify_section )
       {
-        reader.on_formula( detail::trim( line ) );
+        reader.on_formula( std::string( trim_view( line ) ) );
       }
       else
       {
         std::cerr << "[e] unknown section: " << line << std::endl;
         return false;
       }
+      return true;
+    }
+
+    /*! \brief Reports the number of propositions seen in all trace lines */
+    void finish() const
+    {
+      reader.set_num_propositions( num_propositions );
     }
+
+  private:
+    trace_reader const& reader;
+    trace_parser parser;
+    trace_line_parser trace_line;
+
+    uint32_t good_section, bad_section, operator_section, parameter_section, verify_section;
+    uint32_t curr_section;
+    uint32_t num_propositions{0u};
+  }; /* trace_file_parser */
+} /* detail */
+
+/*! \brief Reads traces from a buffer
+ *
+ * Parses the buffer line by line in place.  Trace lines are tokenized
+ * without copying; the prefix and suffix of a trace are emitted
+ * directly into reusable buffers, so that the per-line allocations are
+ * limited to the (reused) time step vectors.
+ *
+ * The buffer is expected to start in section `first_section`, which
+ * allows to parse parts of a file.
+ */
+inline bool read_traces_from_buffer( std::string_view buffer, trace_reader const& reader,
+                                     trace_section first_section = trace_section::good_traces )
+{
+  detail::trace_file_parser parser( reader, first_section );
+
+  bool success = true;
+  foreach_line( buffer, [&]( std::string_view line ){
+      return success = parser.parse_line( line );
+    });
+
+  if ( !success )
+    return false;
+
+  parser.finish();
+  return true;
+}
+
+/*! \brief Reads traces from a stream
+ *
+ * Reads the stream one line at a time into a reused buffer, such that
+ * memory stays bounded by the longest line.  Prefer the filename
+ * overload for files, which parses a memory mapping of the file.
+ */
+inline bool read_traces( std::istream& is, trace_reader const& reader )
+{
+  detail::trace_file_parser parser( reader, trace_section::good_traces );
+
+  std::string line;
+  while ( std::getline( is, line ) )
+  {
+    if ( !parser.parse_line( line ) )
+      return false;
   }
-  reader.set_num_propositions( num_propositions );
+
+  parser.finish();
   return true;
 }
 
-bool read_traces( std::string const& filename, trace_reader const& reader )
+inline bool read_traces( std::string const& filename, trace_reader const& reader )
 {
-  std::ifstream ifs( filename, std::ios::in );
-  auto const result = read_traces( ifs, reader );
-  ifs.close();
-  return result;
+  memory_mapped_file const file( filename );
+  if ( !file.good() )
+  {
+    std::cerr << "[e] could not open file: " << filename << std::endl;
+    return false;
+  }
+  return read_traces_from_buffer( file.view(), reader );
 }
 
 } /* namespace copycat */
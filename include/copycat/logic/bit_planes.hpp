@@ -0,0 +1,274 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file bit_planes.hpp
+  \brief Bit-plane storage and word-parallel kernels for packed multi-valued Booleans
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace copycat
+{
+
+namespace detail
+{
+
+/* word operations; overloaded for 64-bit words and, with AVX2, 256-bit words */
+inline uint64_t word_and( uint64_t a, uint64_t b ) { return a & b; }
+inline uint64_t word_or( uint64_t a, uint64_t b ) { return a | b; }
+inline uint64_t word_andnot( uint64_t a, uint64_t b ) { return ~a & b; }
+
+#if defined(__AVX2__)
+/* wrapped such that it can be stored in std::array without losing its alignment attribute */
+struct word256
+{
+  __m256i value;
+}; /* word256 */
+
+inline word256 word_and( word256 a, word256 b ) { return { _mm256_and_si256( a.value, b.value ) }; }
+inline word256 word_or( word256 a, word256 b ) { return { _mm256_or_si256( a.value, b.value ) }; }
+inline word256 word_andnot( word256 a, word256 b ) { return { _mm256_andnot_si256( a.value, b.value ) }; }
+#endif
+
+/*! \brief Solves a backward recurrence over a bit-vector word by word
+ *
+ * Computes `out[i] = b[i] | ( a[i] & out[i + 1] )` for all `size`
+ * bits, where `out[size]` is `last`, i.e., the recurrence of the until
+ * operator on a Boolean plane.  If `dual` is set, the dual recurrence
+ * `out[i] = b[i] & ( a[i] | out[i + 1] )` is solved instead.  Bits
+ * beyond `size` are zero in `a` and `b` and are cleared in `out`.
+ *
+ * Each word is solved by a parallel prefix over its bits, i.e., with
+ * a logarithmic number of word operations, and its lowest bit is
+ * carried into the preceding word.
+ */
+inline void backward_until( uint64_t* out, uint64_t const* a, uint64_t const* b, std::size_t size, bool last, bool dual = false )
+{
+  auto const num_words = ( size + 63u ) >> 6u;
+  auto const num_bits = size & 63u;
+  uint64_t const flip = dual ? ~uint64_t( 0u ) : 0u;
+
+  /* the dual recurrence is solved as the recurrence of the complements */
+  bool carry = last != dual;
+  for ( auto w = num_words; w-- > 0u; )
+  {
+    bool const partial = w + 1u == num_words && num_bits != 0u;
+    uint64_t const mask = partial ? ( uint64_t( 1u ) << num_bits ) - 1u : ~uint64_t( 0u );
+
+    uint64_t p = ( a[w] ^ flip ) & mask;
+    uint64_t g = ( b[w] ^ flip ) & mask;
+    if ( partial )
+      g |= uint64_t( carry ) << num_bits;
+    else
+      g |= p & ( uint64_t( carry ) << 63u );
+
+    for ( auto shift = 1u; shift < 64u; shift <<= 1u )
+    {
+      g |= p & ( g >> shift );
+      p &= p >> shift;
+    }
+
+    g &= mask;
+    carry = g & 1u;
+    out[w] = ( g ^ flip ) & mask;
+  }
+}
+
+} /* namespace detail */
+
+/*! \brief Vector of multi-valued Booleans stored in bit-planes
+ *
+ * Element `i` is encoded by bit `i` of each of the `NumPlanes`
+ * planes.  Bits beyond `size()` are zero in all planes; the kernels of
+ * the packed types preserve this.
+ */
+template<uint32_t NumPlanes>
+class bit_planes
+{
+public:
+  using planes_type = std::array<uint64_t, NumPlanes>;
+
+public:
+  bit_planes() = default;
+
+  explicit bit_planes( std::size_t size )
+    : _size( size )
+  {
+    for ( auto& p : _planes )
+      p.resize( ( size + 63u ) >> 6u, 0u );
+  }
+
+  std::size_t size() const
+  {
+    return _size;
+  }
+
+  std::size_t num_words() const
+  {
+    return _planes[0u].size();
+  }
+
+  uint64_t* plane( uint32_t k )
+  {
+    return _planes[k].data();
+  }
+
+  uint64_t const* plane( uint32_t k ) const
+  {
+    return _planes[k].data();
+  }
+
+  /*! \brief Returns the bits of element `i` in all planes */
+  planes_type get_bits( std::size_t i ) const
+  {
+    planes_type bits;
+    for ( auto k = 0u; k < NumPlanes; ++k )
+      bits[k] = ( _planes[k][i >> 6u] >> ( i & 63u ) ) & 1u;
+    return bits;
+  }
+
+  void set_bits( std::size_t i, planes_type const& bits )
+  {
+    auto const mask = uint64_t( 1u ) << ( i & 63u );
+    for ( auto k = 0u; k < NumPlanes; ++k )
+    {
+      auto& w = _planes[k][i >> 6u];
+      w = bits[k] ? ( w | mask ) : ( w & ~mask );
+    }
+  }
+
+  /*! \brief Sets all elements to the same bits */
+  void fill( planes_type const& bits )
+  {
+    for ( auto k = 0u; k < NumPlanes; ++k )
+    {
+      std::fill( _planes[k].begin(), _planes[k].end(), bits[k] ? ~uint64_t( 0u ) : 0u );
+      if ( bits[k] && ( _size & 63u ) != 0u )
+        _planes[k].back() &= ( uint64_t( 1u ) << ( _size & 63u ) ) - 1u;
+    }
+  }
+
+  bool operator==( bit_planes const& other ) const
+  {
+    return _size == other._size && _planes == other._planes;
+  }
+
+  /*! \brief Computes `out = fn( a )` word by word
+   *
+   * `fn` is called with an array of words, one per plane, and returns
+   * an array of words for the planes of the result.  It must be
+   * written in terms of the `detail::word_*` operations; with AVX2,
+   * it is applied to four words at a time.
+   */
+  template<typename Fn>
+  static void transform( bit_planes& out, bit_planes const& a, Fn&& fn )
+  {
+    transform_impl<1u>( out, { &a }, fn );
+  }
+
+  /*! \brief Computes `out = fn( a, b )` word by word */
+  template<typename Fn>
+  static void transform( bit_planes& out, bit_planes const& a, bit_planes const& b, Fn&& fn )
+  {
+    transform_impl<2u>( out, { &a, &b }, fn );
+  }
+
+  /*! \brief Computes `out[i] = a[i + 1]`; the last element of `out` is zero in all planes */
+  static void shift_down( bit_planes& out, bit_planes const& a )
+  {
+    auto const n = out.num_words();
+    for ( auto k = 0u; k < NumPlanes; ++k )
+    {
+      auto const* in = a.plane( k );
+      auto* o = out.plane( k );
+      for ( std::size_t w = 0u; w < n; ++w )
+        o[w] = ( in[w] >> 1u ) | ( w + 1u < n ? ( in[w + 1u] << 63u ) : 0u );
+    }
+  }
+
+protected:
+  template<uint32_t NumArgs, typename Fn>
+  static void transform_impl( bit_planes& out, std::array<bit_planes const*, NumArgs> const& args, Fn&& fn )
+  {
+    auto const n = out.num_words();
+    std::size_t w = 0u;
+
+#if defined(__AVX2__)
+    for ( ; w + 4u <= n; w += 4u )
+    {
+      std::array<std::array<detail::word256, NumPlanes>, NumArgs> in;
+      for ( auto j = 0u; j < NumArgs; ++j )
+        for ( auto k = 0u; k < NumPlanes; ++k )
+          in[j][k].value = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( args[j]->plane( k ) + w ) );
+
+      auto const result = apply( fn, in );
+      for ( auto k = 0u; k < NumPlanes; ++k )
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( out.plane( k ) + w ), result[k].value );
+    }
+#endif
+
+    for ( ; w < n; ++w )
+    {
+      std::array<std::array<uint64_t, NumPlanes>, NumArgs> in;
+      for ( auto j = 0u; j < NumArgs; ++j )
+        for ( auto k = 0u; k < NumPlanes; ++k )
+          in[j][k] = args[j]->plane( k )[w];
+
+      auto const result = apply( fn, in );
+      for ( auto k = 0u; k < NumPlanes; ++k )
+        out.plane( k )[w] = result[k];
+    }
+  }
+
+  template<typename Fn, typename Word>
+  static std::array<Word, NumPlanes> apply( Fn&& fn, std::array<std::array<Word, NumPlanes>, 1u> const& in )
+  {
+    return fn( in[0u] );
+  }
+
+  template<typename Fn, typename Word>
+  static std::array<Word, NumPlanes> apply( Fn&& fn, std::array<std::array<Word, NumPlanes>, 2u> const& in )
+  {
+    return fn( in[0u], in[1u] );
+  }
+
+protected:
+  std::size_t _size = 0u;
+  std::array<std::vector<uint64_t>, NumPlanes> _planes;
+}; /* bit_planes */
+
+} /* namespace copycat */
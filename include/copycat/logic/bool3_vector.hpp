@@ -0,0 +1,209 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file bool3_vector.hpp
+  \brief Packed vector of three-valued Booleans
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include "bit_planes.hpp"
+#include "bool3.hpp"
+#include <cassert>
+#include <string>
+
+namespace copycat
+{
+
+/*! \brief Packed vector of `bool3` values
+ *
+ * The values are stored in two bit-planes: `t` is set for true, `f`
+ * is set for false, and neither is set for inconclusive.  Negation,
+ * conjunction, and disjunction are branch-free bitwise kernels with
+ * the semantics of the corresponding `bool3` operators.
+ */
+class bool3_vector
+{
+public:
+  enum plane_t : uint32_t
+  {
+    t = 0u,
+    f = 1u,
+  }; /* plane_t */
+
+  using planes_type = bit_planes<2u>;
+
+public:
+  bool3_vector() = default;
+
+  explicit bool3_vector( std::size_t size, bool3 const& value = false )
+    : _planes( size )
+  {
+    _planes.fill( to_bits( value ) );
+  }
+
+  std::size_t size() const
+  {
+    return _planes.size();
+  }
+
+  bool3 operator[]( std::size_t i ) const
+  {
+    return get( i );
+  }
+
+  bool3 get( std::size_t i ) const
+  {
+    return from_bits( _planes.get_bits( i ) );
+  }
+
+  void set( std::size_t i, bool3 const& value )
+  {
+    _planes.set_bits( i, to_bits( value ) );
+  }
+
+  planes_type const& planes() const
+  {
+    return _planes;
+  }
+
+  planes_type& planes()
+  {
+    return _planes;
+  }
+
+  bool operator==( bool3_vector const& other ) const
+  {
+    return _planes == other._planes;
+  }
+
+  bool operator!=( bool3_vector const& other ) const
+  {
+    return !this->operator==( other );
+  }
+
+  bool3_vector operator!() const
+  {
+    bool3_vector result( size() );
+    planes_type::transform( result._planes, _planes, []( auto const& a ){
+        return std::array<std::decay_t<decltype( a[0u] )>, 2u>{ a[f], a[t] };
+      } );
+    return result;
+  }
+
+  bool3_vector operator&( bool3_vector const& other ) const
+  {
+    bool3_vector result( size() );
+    planes_type::transform( result._planes, _planes, other._planes, []( auto const& a, auto const& b ){
+        using detail::word_and;
+        using detail::word_or;
+        return std::array<std::decay_t<decltype( a[0u] )>, 2u>{ word_and( a[t], b[t] ), word_or( a[f], b[f] ) };
+      } );
+    return result;
+  }
+
+  bool3_vector operator|( bool3_vector const& other ) const
+  {
+    bool3_vector result( size() );
+    planes_type::transform( result._planes, _planes, other._planes, []( auto const& a, auto const& b ){
+        using detail::word_and;
+        using detail::word_or;
+        return std::array<std::decay_t<decltype( a[0u] )>, 2u>{ word_or( a[t], b[t] ), word_and( a[f], b[f] ) };
+      } );
+    return result;
+  }
+
+  /* the short-circuit operators of `bool3` coincide with `&` and `|` */
+  bool3_vector operator&&( bool3_vector const& other ) const
+  {
+    return *this & other;
+  }
+
+  bool3_vector operator||( bool3_vector const& other ) const
+  {
+    return *this | other;
+  }
+
+  /*! \brief Returns the vector shifted by one position towards the front
+   *
+   * Element `i` of the result is element `i + 1` of this vector; the
+   * last element is `last`.
+   */
+  bool3_vector shift_down( bool3 const& last ) const
+  {
+    bool3_vector result( size() );
+    planes_type::shift_down( result._planes, _planes );
+    if ( size() > 0u )
+      result.set( size() - 1u, last );
+    return result;
+  }
+
+  /*! \brief Computes `a U b` in all positions
+   *
+   * Solves `v[i] = b[i] | ( a[i] & v[i + 1] )` backwards, where the
+   * value after the last element is `last`.  Both planes are monotone
+   * in the order of `bool3`, such that the true plane is solved as a
+   * Boolean until and the false plane as its dual.
+   */
+  static bool3_vector until( bool3_vector const& a, bool3_vector const& b, bool3 const& last )
+  {
+    assert( a.size() == b.size() );
+    bool3_vector result( a.size() );
+    detail::backward_until( result._planes.plane( t ), a._planes.plane( t ), b._planes.plane( t ), a.size(), last.is_true() );
+    detail::backward_until( result._planes.plane( f ), a._planes.plane( f ), b._planes.plane( f ), a.size(), last.is_false(), /* dual */true );
+    return result;
+  }
+
+  std::string to_string() const
+  {
+    std::string s;
+    for ( auto i = 0u; i < size(); ++i )
+      s += get( i ).to_string();
+    return s;
+  }
+
+protected:
+  static planes_type::planes_type to_bits( bool3 const& value )
+  {
+    return { value.is_true() ? 1u : 0u, value.is_false() ? 1u : 0u };
+  }
+
+  static bool3 from_bits( planes_type::planes_type const& bits )
+  {
+    if ( bits[t] )
+      return true;
+    if ( bits[f] )
+      return false;
+    return inconclusive3;
+  }
+
+protected:
+  planes_type _planes;
+}; /* bool3_vector */
+
+} /* namespace copycat */
@@ -0,0 +1,285 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file bool5_vector.hpp
+  \brief Packed vector of five-valued Booleans
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include "bit_planes.hpp"
+#include "bool5.hpp"
+#include <cassert>
+#include <string>
+#include <vector>
+
+namespace copycat
+{
+
+/*! \brief Packed vector of `bool5` values
+ *
+ * The values are stored in three bit-planes: `t` is set for true and
+ * presumably true, `f` is set for false and presumably false, and `d`
+ * (definite) is set for true and false.  Inconclusive has no bit set.
+ * Negation, conjunction, and disjunction are branch-free bitwise
+ * kernels with the semantics of the corresponding `bool5` operators.
+ */
+class bool5_vector
+{
+public:
+  enum plane_t : uint32_t
+  {
+    t = 0u,
+    f = 1u,
+    d = 2u,
+  }; /* plane_t */
+
+  using planes_type = bit_planes<3u>;
+
+public:
+  bool5_vector() = default;
+
+  explicit bool5_vector( std::size_t size, bool5 const& value = false )
+    : _planes( size )
+  {
+    _planes.fill( to_bits( value ) );
+  }
+
+  std::size_t size() const
+  {
+    return _planes.size();
+  }
+
+  bool5 operator[]( std::size_t i ) const
+  {
+    return get( i );
+  }
+
+  bool5 get( std::size_t i ) const
+  {
+    return from_bits( _planes.get_bits( i ) );
+  }
+
+  void set( std::size_t i, bool5 const& value )
+  {
+    _planes.set_bits( i, to_bits( value ) );
+  }
+
+  planes_type const& planes() const
+  {
+    return _planes;
+  }
+
+  planes_type& planes()
+  {
+    return _planes;
+  }
+
+  bool operator==( bool5_vector const& other ) const
+  {
+    return _planes == other._planes;
+  }
+
+  bool operator!=( bool5_vector const& other ) const
+  {
+    return !this->operator==( other );
+  }
+
+  bool5_vector operator!() const
+  {
+    bool5_vector result( size() );
+    planes_type::transform( result._planes, _planes, []( auto const& a ){
+        return std::array<std::decay_t<decltype( a[0u] )>, 3u>{ a[f], a[t], a[d] };
+      } );
+    return result;
+  }
+
+  bool5_vector operator&( bool5_vector const& other ) const
+  {
+    bool5_vector result( size() );
+    planes_type::transform( result._planes, _planes, other._planes, []( auto const& a, auto const& b ){
+        return meet( a, b );
+      } );
+    return result;
+  }
+
+  bool5_vector operator&&( bool5_vector const& other ) const
+  {
+    bool5_vector result( size() );
+    planes_type::transform( result._planes, _planes, other._planes, []( auto const& a, auto const& b ){
+        /* (presumably) false on the left-hand side is kept as is */
+        return select( a[f], a, meet( a, b ) );
+      } );
+    return result;
+  }
+
+  bool5_vector operator|( bool5_vector const& other ) const
+  {
+    bool5_vector result( size() );
+    planes_type::transform( result._planes, _planes, other._planes, []( auto const& a, auto const& b ){
+        return join( a, b );
+      } );
+    return result;
+  }
+
+  bool5_vector operator||( bool5_vector const& other ) const
+  {
+    bool5_vector result( size() );
+    planes_type::transform( result._planes, _planes, other._planes, []( auto const& a, auto const& b ){
+        /* (presumably) true on the left-hand side is kept as is */
+        return select( a[t], a, join( a, b ) );
+      } );
+    return result;
+  }
+
+  /*! \brief Returns the vector shifted by one position towards the front
+   *
+   * Element `i` of the result is element `i + 1` of this vector; the
+   * last element is `last`.
+   */
+  bool5_vector shift_down( bool5 const& last ) const
+  {
+    bool5_vector result( size() );
+    planes_type::shift_down( result._planes, _planes );
+    if ( size() > 0u )
+      result.set( size() - 1u, last );
+    return result;
+  }
+
+  /*! \brief Computes `a U b` in all positions
+   *
+   * Solves `v[i] = b[i] | ( a[i] & v[i + 1] )` backwards, where the
+   * value after the last element is `last`.  The values of `bool5`
+   * form a chain, such that each threshold `v >= c` commutes with
+   * meet and join: the thresholds true and presumably true (`t`) are
+   * solved as Boolean untils, the thresholds false and presumably
+   * false (`f`) as their duals, and the definite plane is recombined
+   * from the extreme thresholds.
+   */
+  static bool5_vector until( bool5_vector const& a, bool5_vector const& b, bool5 const& last )
+  {
+    assert( a.size() == b.size() );
+    auto const size = a.size();
+    auto const num_words = a._planes.num_words();
+
+    bool5_vector result( size );
+    auto& r = result._planes;
+    detail::backward_until( r.plane( t ), a._planes.plane( t ), b._planes.plane( t ), size,
+                            last.is_true() || last.is_presumably_true() );
+    detail::backward_until( r.plane( f ), a._planes.plane( f ), b._planes.plane( f ), size,
+                            last.is_false() || last.is_presumably_false(), /* dual */true );
+
+    /* definite values: solve the thresholds true and false */
+    std::vector<uint64_t> ax( num_words ), bx( num_words ), definite_true( num_words ), definite_false( num_words );
+    for ( std::size_t w = 0u; w < num_words; ++w )
+    {
+      ax[w] = a._planes.plane( t )[w] & a._planes.plane( d )[w];
+      bx[w] = b._planes.plane( t )[w] & b._planes.plane( d )[w];
+    }
+    detail::backward_until( definite_true.data(), ax.data(), bx.data(), size, last.is_true() );
+
+    for ( std::size_t w = 0u; w < num_words; ++w )
+    {
+      ax[w] = a._planes.plane( f )[w] & a._planes.plane( d )[w];
+      bx[w] = b._planes.plane( f )[w] & b._planes.plane( d )[w];
+    }
+    detail::backward_until( definite_false.data(), ax.data(), bx.data(), size, last.is_false(), /* dual */true );
+
+    for ( std::size_t w = 0u; w < num_words; ++w )
+      r.plane( d )[w] = definite_true[w] | definite_false[w];
+    return result;
+  }
+
+  std::string to_string() const
+  {
+    std::string s;
+    for ( auto i = 0u; i < size(); ++i )
+      s += get( i ).to_string();
+    return s;
+  }
+
+protected:
+  /* minimum: false if either side is false, true only if both sides are */
+  template<typename Word>
+  static std::array<Word, 3u> meet( std::array<Word, 3u> const& a, std::array<Word, 3u> const& b )
+  {
+    using detail::word_and;
+    using detail::word_or;
+    auto const rt = word_and( a[t], b[t] );
+    auto const rf = word_or( a[f], b[f] );
+    auto const rd = word_or( word_and( rf, word_or( word_and( a[f], a[d] ), word_and( b[f], b[d] ) ) ),
+                             word_and( rt, word_and( a[d], b[d] ) ) );
+    return { rt, rf, rd };
+  }
+
+  /* maximum: dual of the minimum */
+  template<typename Word>
+  static std::array<Word, 3u> join( std::array<Word, 3u> const& a, std::array<Word, 3u> const& b )
+  {
+    using detail::word_and;
+    using detail::word_or;
+    auto const rt = word_or( a[t], b[t] );
+    auto const rf = word_and( a[f], b[f] );
+    auto const rd = word_or( word_and( rt, word_or( word_and( a[t], a[d] ), word_and( b[t], b[d] ) ) ),
+                             word_and( rf, word_and( a[d], b[d] ) ) );
+    return { rt, rf, rd };
+  }
+
+  /* bitwise `mask ? a : b` */
+  template<typename Word>
+  static std::array<Word, 3u> select( Word const& mask, std::array<Word, 3u> const& a, std::array<Word, 3u> const& b )
+  {
+    using detail::word_and;
+    using detail::word_andnot;
+    using detail::word_or;
+    return { word_or( word_and( mask, a[t] ), word_andnot( mask, b[t] ) ),
+             word_or( word_and( mask, a[f] ), word_andnot( mask, b[f] ) ),
+             word_or( word_and( mask, a[d] ), word_andnot( mask, b[d] ) ) };
+  }
+
+  static planes_type::planes_type to_bits( bool5 const& value )
+  {
+    return { ( value.is_true() || value.is_presumably_true() ) ? 1u : 0u,
+             ( value.is_false() || value.is_presumably_false() ) ? 1u : 0u,
+             ( value.is_true() || value.is_false() ) ? 1u : 0u };
+  }
+
+  static bool5 from_bits( planes_type::planes_type const& bits )
+  {
+    if ( bits[t] )
+      return bits[d] ? bool5( true ) : presumably_true;
+    if ( bits[f] )
+      return bits[d] ? bool5( false ) : presumably_false;
+    return inconclusive5;
+  }
+
+protected:
+  planes_type _planes;
+}; /* bool5_vector */
+
+} /* namespace copycat */
@@ -90,7 +90,7 @@ public:
 
   bool operator==( ltl_node const &other ) const
   {
-    return children == other.children;
+    return children == other.children && data == other.data;
   }
 }; /* ltl_node */
 
@@ -271,6 +271,12 @@ public:
     return {index,0};
   }
 
+  ltl_formula variable_at( uint32_t index ) const
+  {
+    assert( index < storage->inputs.size() );
+    return {storage->inputs[index], 0};
+  }
+
   void create_formula( ltl_formula const& a )
   {
     storage->outputs.push_back( a );
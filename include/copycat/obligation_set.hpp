@@ -34,11 +34,18 @@
 
 #include <copycat/ltl.hpp>
 #include <algorithm>
+#include <iterator>
+#include <unordered_map>
 #include <vector>
 
 namespace copycat
 {
 
+/*! \brief Set of obligations
+ *
+ * The obligations are stored in a sorted vector without duplicates,
+ * such that insertion is a binary search and union is a merge.
+ */
 class obligation_set
 {
 public:
@@ -47,18 +54,17 @@ public:
 public:
   explicit obligation_set() = default;
 
-  bool operator==( obligation_set const& other ) const
+  /*! \brief Constructs the obligation set from formulas in any order */
+  explicit obligation_set( std::vector<formula> obligations )
+    : _obligations( std::move( obligations ) )
   {
-    if ( _obligations.size() != other._obligations.size() )
-      return false;
-
-    for ( auto i = 0u; i < _obligations.size(); ++i )
-    {
-      if ( _obligations.at( i ) != other._obligations.at( i ) )
-        return false;
-    }
+    std::sort( std::begin( _obligations ), std::end( _obligations ) );
+    _obligations.erase( std::unique( std::begin( _obligations ), std::end( _obligations ) ), std::end( _obligations ) );
+  }
 
-    return true;
+  bool operator==( obligation_set const& other ) const
+  {
+    return _obligations == other._obligations;
   }
 
   bool operator!=( obligation_set const& other ) const
@@ -66,23 +72,33 @@ public:
     return !operator==( other );
   }
 
+  /*! \brief Number of obligations */
+  uint32_t size() const
+  {
+    return uint32_t( _obligations.size() );
+  }
+
   /*! \brief Adds an LTL formula to the obligation set */
   void add_formula( formula const& f )
   {
-    for ( const auto& o : _obligations )
-      if ( f == o )
-        return;
+    auto const it = std::lower_bound( std::begin( _obligations ), std::end( _obligations ), f );
+    if ( it != std::end( _obligations ) && *it == f )
+      return;
 
-    _obligations.emplace_back( f );
-    std::sort( std::begin( _obligations ), std::end( _obligations ) );
+    _obligations.insert( it, f );
   }
 
   void set_union( obligation_set const& other )
   {
-    for ( const auto& o : other._obligations )
-    {
-      add_formula( o );
-    }
+    if ( other._obligations.empty() )
+      return;
+
+    std::vector<formula> merged;
+    merged.reserve( _obligations.size() + other._obligations.size() );
+    std::set_union( std::begin( _obligations ), std::end( _obligations ),
+                    std::begin( other._obligations ), std::end( other._obligations ),
+                    std::back_inserter( merged ) );
+    _obligations = std::move( merged );
   }
 
   template<typename Fn>
@@ -109,100 +125,110 @@ protected:
   std::vector<formula> _obligations;
 }; /* obligation_set */
 
-obligation_set cart_product( ltl_formula_store& ltl, obligation_set const& as, obligation_set const& bs )
+inline obligation_set cart_product( ltl_formula_store& ltl, obligation_set const& as, obligation_set const& bs )
 {
-  obligation_set new_set;
+  /* build all conjunctions first and sort them once */
+  std::vector<ltl_formula_store::ltl_formula> conjunctions;
+  conjunctions.reserve( as.size() * bs.size() );
   as.foreach_element( [&]( const auto& a, auto ){
       bs.foreach_element( [&]( const auto& b, auto ){
-          new_set.add_formula( ltl.create_and( a, b ) );
+          conjunctions.emplace_back( ltl.create_and( a, b ) );
         });
     });
-  return new_set;
+  return obligation_set( std::move( conjunctions ) );
 }
 
-obligation_set compute_obligations( ltl_formula_store& ltl, ltl_formula_store::ltl_formula const& f )
+/*! \brief Cache for `compute_obligations`
+ *
+ * Maps a constant or literal to its obligation set, and any other node
+ * (uncomplemented) to the obligation set of the node.
+ */
+using obligation_cache = std::unordered_map<uint32_t, obligation_set>;
+
+/*! \brief Computes the obligations of a formula with memoization
+ *
+ * The obligation set of every node is computed once and stored in
+ * `cache`, which can be shared between calls for formulas of the same
+ * store.
+ */
+inline obligation_set const& compute_obligations( ltl_formula_store& ltl, ltl_formula_store::ltl_formula const& f, obligation_cache& cache )
 {
   auto const node = ltl.get_node( f );
 
+  /* the complement of constants and literals matters; it is ignored for the other operators */
+  bool const is_leaf = ltl.is_constant( node ) || ltl.is_variable( node );
+  auto const key = is_leaf ? f.data : ( +f ).data;
+  if ( auto const it = cache.find( key ); it != cache.end() )
+    return it->second;
+
+  std::vector<ltl_formula_store::ltl_formula> fanins;
+  if ( !is_leaf )
+  {
+    ltl.foreach_fanin( node, [&]( const auto& f, auto ){
+        fanins.emplace_back( f );
+      } );
+  }
+
+  obligation_set olg;
+
   /* constant */
   if ( ltl.is_constant( node ) )
   {
-    if ( ltl.is_complemented( f ) )
-    {
-      /* true */
-      return obligation_set{};
-    }
-    else
-    {
-      /* false */
-      obligation_set olg;
+    /* true has no obligations, false has the obligation false */
+    if ( !ltl.is_complemented( f ) )
       olg.add_formula( ltl.get_constant( false ) );
-      return olg;
-    }
   }
 
   /* literal */
   else if ( ltl.is_variable( node ) )
   {
-    obligation_set olg;
     olg.add_formula( f );
-    return olg;
   }
 
   /* next */
   else if ( ltl.is_next( node ) )
   {
-    std::vector<ltl_formula_store::ltl_formula> fanins;
-    ltl.foreach_fanin( node, [&]( const auto& f, auto ){
-        fanins.emplace_back( f );
-      } );
-    assert( fanins.size() == 1u );
-    return compute_obligations( ltl, fanins[0u] );
+    /* the second fanin of a unary operator is the constant */
+    assert( fanins.size() == 2u );
+    olg = compute_obligations( ltl, fanins[0u], cache );
   }
 
   /* OR */
   else if ( ltl.is_or( node ) )
   {
-    std::vector<ltl_formula_store::ltl_formula> fanins;
-    ltl.foreach_fanin( node, [&]( const auto& f, auto ){
-        fanins.emplace_back( f );
-      } );
     assert( fanins.size() == 2u );
-
-    obligation_set olg0 = compute_obligations( ltl, fanins[0u] );
-    obligation_set const olg1 = compute_obligations( ltl, fanins[1u] );
-    olg0.set_union( olg1 );
-    return olg0;
+    olg = compute_obligations( ltl, fanins[0u], cache );
+    olg.set_union( compute_obligations( ltl, fanins[1u], cache ) );
   }
 
   /* AND */
   else if ( ltl.is_and( node ) )
   {
-    std::vector<ltl_formula_store::ltl_formula> fanins;
-    ltl.foreach_fanin( node, [&]( const auto& f, auto ){
-        fanins.emplace_back( f );
-      } );
     assert( fanins.size() == 2u );
-
-    obligation_set const olg0 = compute_obligations( ltl, fanins[0u] );
-    obligation_set const olg1 = compute_obligations( ltl, fanins[1u] );
-    return cart_product( ltl, olg0, olg1 );
+    auto const& olg0 = compute_obligations( ltl, fanins[0u], cache );
+    auto const& olg1 = compute_obligations( ltl, fanins[1u], cache );
+    olg = cart_product( ltl, olg0, olg1 );
   }
 
   /* UNTIL or RELEASES */
   else if ( ltl.is_until( node ) || ltl.is_releases( node ) )
   {
-    std::vector<ltl_formula_store::ltl_formula> fanins;
-    ltl.foreach_fanin( node, [&]( const auto& f, auto ){
-        fanins.emplace_back( f );
-      } );
     assert( fanins.size() == 2u );
+    olg = compute_obligations( ltl, fanins[1u], cache );
+  }
 
-    return compute_obligations( ltl, fanins[1u] );
+  else
+  {
+    assert( false && "unsupported node type" );
   }
 
-  assert( false && "unsupported node type" );
-  return obligation_set{};
+  return cache.emplace( key, std::move( olg ) ).first->second;
+}
+
+inline obligation_set compute_obligations( ltl_formula_store& ltl, ltl_formula_store::ltl_formula const& f )
+{
+  obligation_cache cache;
+  return compute_obligations( ltl, f, cache );
 }
 
 } /* namespace copycat */
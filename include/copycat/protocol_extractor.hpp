@@ -31,31 +31,130 @@
 
 #pragma once
 
-#include <vector>
+#include "utils/string_pool.hpp"
+#include "waveform.hpp"
+#include <fmt/format.h>
+#include <json/json.hpp>
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <tuple>
-#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace copycat
+{
 
-namespace std
+namespace detail
 {
 
-template<>
-struct hash<std::tuple<std::string,std::string>>
+/*! \brief Open-addressing hash map from 64-bit keys to 32-bit values
+ *
+ * The key `~0` is reserved to mark empty slots.
+ */
+class flat_index_map
 {
-  using argument_type = std::tuple<std::string,std::string>;
-  using result_type = std::size_t;
+public:
+  static constexpr uint64_t empty_key = ~uint64_t( 0u );
 
-  result_type operator()( argument_type const& g ) const noexcept {
-    result_type const h1 ( std::hash<std::string>{}( std::get<0>( g ) ) );
-    result_type const h2 ( std::hash<std::string>{}( std::get<1>( g ) ) );
-    return h1 ^ ( h2 << 1 );
+public:
+  explicit flat_index_map( uint32_t initial_capacity = 64u )
+  {
+    uint32_t capacity = 16u;
+    while ( capacity < 2u * initial_capacity )
+      capacity <<= 1u;
+    slots.assign( capacity, { empty_key, 0u } );
   }
-}; /* std::hash<vertex> */
 
-} /* namespace std */
+  /*! \brief Returns the value of `key`, inserting `value` if the key is new */
+  std::pair<uint32_t, bool> insert( uint64_t key, uint32_t value )
+  {
+    assert( key != empty_key );
+    auto& s = slots[find_slot( key )];
+    if ( s.first == key )
+      return { s.second, false };
 
-namespace copycat
+    s = { key, value };
+    if ( 2u * ++num_entries > slots.size() )
+      rehash();
+    return { value, true };
+  }
+
+  uint32_t const* find( uint64_t key ) const
+  {
+    auto const& s = slots[find_slot( key )];
+    return s.first == key ? &s.second : nullptr;
+  }
+
+  uint32_t size() const
+  {
+    return num_entries;
+  }
+
+  void clear()
+  {
+    std::fill( slots.begin(), slots.end(), std::make_pair( empty_key, 0u ) );
+    num_entries = 0u;
+  }
+
+protected:
+  static uint64_t mix( uint64_t key )
+  {
+    /* finalizer of MurmurHash3 */
+    key ^= key >> 33u;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33u;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33u;
+    return key;
+  }
+
+  std::size_t find_slot( uint64_t key ) const
+  {
+    auto const mask = slots.size() - 1u;
+    auto slot = mix( key ) & mask;
+    while ( slots[slot].first != key && slots[slot].first != empty_key )
+      slot = ( slot + 1u ) & mask;
+    return slot;
+  }
+
+  void rehash()
+  {
+    std::vector<std::pair<uint64_t, uint32_t>> old( 2u * slots.size(), { empty_key, 0u } );
+    std::swap( old, slots );
+    for ( auto const& s : old )
+      if ( s.first != empty_key )
+        slots[find_slot( s.first )] = s;
+  }
+
+protected:
+  std::vector<std::pair<uint64_t, uint32_t>> slots;
+  uint32_t num_entries{0u};
+}; /* flat_index_map */
+
+/* escapes a string for a quoted DOT label */
+inline std::string dot_escape( std::string_view s )
 {
+  std::string r;
+  r.reserve( s.size() );
+  for ( auto c : s )
+  {
+    if ( c == '"' || c == '\\' )
+      r += '\\';
+    if ( c == '\n' )
+    {
+      r += "\\n";
+      continue;
+    }
+    r += c;
+  }
+  return r;
+}
+
+} /* namespace detail */
 
 /* ***** Definition of protocol graph ***** */
 struct vertex
@@ -65,19 +164,25 @@ struct vertex
     return input == other.input && output == other.output;
   }
 
-  std::string input;
-  std::string output;
-
-  std::vector<uint32_t> parents;
-  std::vector<uint32_t> children;
+  /* IDs of the input and output symbols in the symbol pool */
+  uint32_t input;
+  uint32_t output;
 }; /* vertex */
 
+/*! \brief Graph of observed input/output pairs
+ *
+ * A node is a pair of input and output symbols; the symbols are
+ * interned in a string pool and a node is found by the 64-bit key
+ * packing both symbol IDs.  Edges are collected in a list while the
+ * graph is built; `compact` sorts them, removes duplicates, and stores
+ * the children and parents of all nodes in compressed sparse row form.
+ */
 class protocol_graph
 {
 public:
   using index_t = uint32_t;
-  using hash_key_t = std::tuple<std::string, std::string>;
-  
+  using symbol_t = string_pool::id_type;
+
   explicit protocol_graph()
   {
   }
@@ -89,32 +194,121 @@ public:
     return index;
   }
 
-  index_t add_node( std::string const &input, std::string const &output )
+  index_t add_node( std::string_view input, std::string_view output )
   {
-    auto const key = hash_key_t{input,output};
-    auto const it = node_map.find( key );
-    if ( it == node_map.end() )
-    {
-      auto const index = nodes.size();
-      nodes.emplace_back( vertex{input,output,{},{}} );
-      node_map.emplace( key, index );
-      return index;
-    }
-    else
-    {
-      return it->second;
-    }
+    return add_node( symbols.intern( input ), symbols.intern( output ) );
+  }
+
+  index_t add_node( symbol_t input, symbol_t output )
+  {
+    auto const key = ( uint64_t( input ) << 32u ) | output;
+    auto const [index, is_new] = node_map.insert( key, uint32_t( nodes.size() ) );
+    if ( is_new )
+      nodes.emplace_back( vertex{input,output} );
+    return index;
   }
 
   void add_edge( index_t source, index_t target )
   {
-    nodes[source].children.emplace_back( target );
-    nodes[target].parents.emplace_back( source );
+    assert( source < nodes.size() && target < nodes.size() );
+    pending_edges.emplace_back( source, target );
+  }
+
+  /*! \brief Builds the compressed adjacency of all edges added so far */
+  void compact()
+  {
+    if ( pending_edges.empty() && child_offsets.size() == nodes.size() + 1u )
+      return;
+
+    auto edges = std::move( pending_edges );
+    pending_edges = {};
+    foreach_edge( [&]( index_t source, index_t target ){ edges.emplace_back( source, target ); } );
+    std::sort( edges.begin(), edges.end() );
+    edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+
+    build_csr( edges, child_offsets, children );
+    for ( auto& e : edges )
+      std::swap( e.first, e.second );
+    std::sort( edges.begin(), edges.end() );
+    build_csr( edges, parent_offsets, parents );
+  }
+
+  bool is_compact() const
+  {
+    return pending_edges.empty() && child_offsets.size() == nodes.size() + 1u;
+  }
+
+  template<typename Fn>
+  void foreach_child( index_t n, Fn&& fn ) const
+  {
+    assert( is_compact() );
+    for ( auto i = child_offsets[n]; i < child_offsets[n + 1u]; ++i )
+      fn( children[i] );
+  }
+
+  template<typename Fn>
+  void foreach_parent( index_t n, Fn&& fn ) const
+  {
+    assert( is_compact() );
+    for ( auto i = parent_offsets[n]; i < parent_offsets[n + 1u]; ++i )
+      fn( parents[i] );
+  }
+
+  /*! \brief Calls `fn( source, target )` for each edge of the compacted graph */
+  template<typename Fn>
+  void foreach_edge( Fn&& fn ) const
+  {
+    for ( index_t n = 0u; n + 1u < child_offsets.size(); ++n )
+      for ( auto i = child_offsets[n]; i < child_offsets[n + 1u]; ++i )
+        fn( n, children[i] );
   }
 
-  void write_dot()
+  vertex const& node( index_t n ) const
   {
-    assert( false && "yet not implemented" );
+    return nodes[n];
+  }
+
+  /*! \brief Returns the input symbol of node `n`
+   *
+   * The view is invalidated by the next call of `add_node` with new
+   * symbols.
+   */
+  std::string_view input( index_t n ) const
+  {
+    return symbols[nodes[n].input];
+  }
+
+  /*! \brief Returns the output symbol of node `n`
+   *
+   * The view is invalidated by the next call of `add_node` with new
+   * symbols.
+   */
+  std::string_view output( index_t n ) const
+  {
+    return symbols[nodes[n].output];
+  }
+
+  string_pool& symbol_pool()
+  {
+    return symbols;
+  }
+
+  string_pool const& symbol_pool() const
+  {
+    return symbols;
+  }
+
+  /*! \brief Writes the graph in DOT format; nodes are labeled with input/output */
+  void write_dot( std::ostream& os )
+  {
+    compact();
+    os << "digraph protocol {\n";
+    for ( index_t n = 0u; n < nodes.size(); ++n )
+      os << fmt::format( "  n{} [label=\"{}/{}\"];\n", n, detail::dot_escape( input( n ) ), detail::dot_escape( output( n ) ) );
+    foreach_edge( [&]( index_t source, index_t target ){
+        os << fmt::format( "  n{} -> n{};\n", source, target );
+      } );
+    os << "}\n";
   }
 
   uint32_t size() const
@@ -122,11 +316,298 @@ public:
     return nodes.size();
   }
 
+  /*! \brief Number of distinct edges of the compacted graph */
+  uint32_t num_edges() const
+  {
+    return children.size();
+  }
+
 protected:
+  void build_csr( std::vector<std::pair<index_t, index_t>> const& edges, std::vector<uint32_t>& offsets, std::vector<index_t>& targets ) const
+  {
+    offsets.assign( nodes.size() + 1u, 0u );
+    targets.resize( edges.size() );
+    for ( auto const& e : edges )
+      ++offsets[e.first + 1u];
+    for ( auto n = 0u; n < nodes.size(); ++n )
+      offsets[n + 1u] += offsets[n];
+    for ( auto i = 0u; i < edges.size(); ++i )
+      targets[i] = edges[i].second;
+  }
+
+protected:
+  string_pool symbols;
   std::vector<vertex> nodes;
-  std::unordered_map<hash_key_t,index_t> node_map;
+  detail::flat_index_map node_map;
+
+  /* edges added since the last compaction */
+  std::vector<std::pair<index_t, index_t>> pending_edges;
+
+  /* compressed adjacency */
+  std::vector<uint32_t> child_offsets;
+  std::vector<index_t> children;
+  std::vector<uint32_t> parent_offsets;
+  std::vector<index_t> parents;
 }; /* protocol_graph */
 
+/* ***** Extraction of protocols from simulation ***** */
 
-} /* namespace copycat */
+/*! \brief Builds a protocol graph from observed input/output pairs
+ *
+ * The extractor consumes the callbacks of `simulate`: in each time
+ * frame, the values of the primary inputs form the input symbol and the
+ * values of the primary outputs form the output symbol (one character
+ * '0' or '1' per signal).  Consecutive observations are connected by an
+ * edge, starting at the root.  Observations can also be added from
+ * waveforms or directly as symbols.
+ *
+ * Edges are deduplicated on the fly, so memory grows with the number
+ * of distinct observations and transitions, not with the number of
+ * simulated time frames.
+ */
+class protocol_extractor
+{
+public:
+  using index_t = protocol_graph::index_t;
+
+public:
+  explicit protocol_extractor( protocol_graph& g )
+    : g( g )
+    , root( g.get_root() )
+    , prev( root )
+  {
+  }
+
+  /* callbacks of `simulate` */
+  void on_time_frame_start( uint32_t time_frame )
+  {
+    (void)time_frame;
+    std::fill( input.begin(), input.end(), '0' );
+    std::fill( output.begin(), output.end(), '0' );
+  }
+
+  void on_pi( uint32_t index, bool value )
+  {
+    set_bit( input, index, value );
+  }
+
+  void on_po( uint32_t index, bool value )
+  {
+    set_bit( output, index, value );
+  }
+
+  void on_ro( uint32_t index, bool value )
+  {
+    (void)index;
+    (void)value;
+  }
+
+  void on_ri( uint32_t index, bool value )
+  {
+    (void)index;
+    (void)value;
+  }
+
+  void on_time_frame_end( uint32_t time_frame )
+  {
+    (void)time_frame;
+    add_observation( input, output );
+  }
+
+  /*! \brief Adds the observations of all time steps of a waveform
+   *
+   * `inputs` and `outputs` are the indices of the traces of the
+   * waveform that form the input and output symbols.
+   */
+  void add_waveform( waveform const& w, std::vector<uint32_t> const& inputs, std::vector<uint32_t> const& outputs )
+  {
+    std::string in( inputs.size(), '0' ), out( outputs.size(), '0' );
+    for ( auto t = 0u; t < w.num_time_steps(); ++t )
+    {
+      for ( auto i = 0u; i < inputs.size(); ++i )
+        in[i] = w.get_value( inputs[i], t ) ? '1' : '0';
+      for ( auto i = 0u; i < outputs.size(); ++i )
+        out[i] = w.get_value( outputs[i], t ) ? '1' : '0';
+      add_observation( in, out );
+    }
+  }
+
+  /*! \brief Adds an observation following the previous one */
+  void add_observation( std::string_view in, std::string_view out )
+  {
+    auto const curr = g.add_node( in, out );
+    if ( edges.insert( ( uint64_t( prev ) << 32u ) | curr, 0u ).second )
+      g.add_edge( prev, curr );
+    prev = curr;
+    ++num_observations;
+  }
+
+  /*! \brief Starts a new run at the root */
+  void reset()
+  {
+    prev = root;
+  }
+
+  uint64_t observations() const
+  {
+    return num_observations;
+  }
+
+  protocol_graph& graph()
+  {
+    return g;
+  }
 
+protected:
+  static void set_bit( std::string& s, uint32_t index, bool value )
+  {
+    if ( index >= s.size() )
+      s.resize( index + 1u, '0' );
+    s[index] = value ? '1' : '0';
+  }
+
+protected:
+  protocol_graph& g;
+  index_t const root;
+  index_t prev;
+
+  /* reused symbol buffers of the current time frame */
+  std::string input;
+  std::string output;
+
+  detail::flat_index_map edges;
+  uint64_t num_observations{0u};
+}; /* protocol_extractor */
+
+/*! \brief Partition of the nodes of a protocol graph into equivalent states */
+struct protocol_partition
+{
+  /* block of each node */
+  std::vector<uint32_t> block_of;
+  uint32_t num_blocks{0u};
+}; /* protocol_partition */
+
+/*! \brief Merges equivalent nodes of a protocol graph
+ *
+ * Two nodes are equivalent if they have the same output and, for each
+ * input, their successors with that input are equivalent (bisimilar).
+ * Starting from the partition by output, blocks are split by the
+ * signature of (input, block) pairs of their successors until the
+ * partition is stable.
+ */
+inline protocol_partition refine_partition( protocol_graph& g )
+{
+  g.compact();
+
+  protocol_partition p;
+  p.block_of.resize( g.size() );
+
+  /* initial partition by output */
+  {
+    std::map<uint32_t, uint32_t> blocks;
+    for ( auto n = 0u; n < g.size(); ++n )
+      p.block_of[n] = blocks.emplace( g.node( n ).output, uint32_t( blocks.size() ) ).first->second;
+    p.num_blocks = blocks.size();
+  }
+
+  std::vector<uint64_t> signature;
+  while ( true )
+  {
+    std::map<std::vector<uint64_t>, uint32_t> blocks;
+    std::vector<uint32_t> next( g.size() );
+    for ( auto n = 0u; n < g.size(); ++n )
+    {
+      signature.clear();
+      g.foreach_child( n, [&]( auto c ){
+          signature.emplace_back( ( uint64_t( g.node( c ).input ) << 32u ) | p.block_of[c] );
+        } );
+      std::sort( signature.begin(), signature.end() );
+      signature.erase( std::unique( signature.begin(), signature.end() ), signature.end() );
+      signature.emplace_back( p.block_of[n] );
+
+      next[n] = blocks.emplace( signature, uint32_t( blocks.size() ) ).first->second;
+    }
+
+    bool const stable = blocks.size() == p.num_blocks;
+    p.block_of = std::move( next );
+    p.num_blocks = blocks.size();
+    if ( stable )
+      break;
+  }
+  return p;
+}
+
+namespace detail
+{
+
+/* transitions between blocks as (source block, input symbol, target block) */
+inline std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> protocol_transitions( protocol_graph& g, protocol_partition const& p )
+{
+  g.compact();
+  std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> transitions;
+  g.foreach_edge( [&]( auto source, auto target ){
+      transitions.emplace_back( p.block_of[source], g.node( target ).input, p.block_of[target] );
+    } );
+  std::sort( transitions.begin(), transitions.end() );
+  transitions.erase( std::unique( transitions.begin(), transitions.end() ), transitions.end() );
+  return transitions;
+}
+
+/* output symbol of each block */
+inline std::vector<uint32_t> protocol_block_outputs( protocol_graph const& g, protocol_partition const& p )
+{
+  std::vector<uint32_t> outputs( p.num_blocks );
+  for ( auto n = 0u; n < g.size(); ++n )
+    outputs[p.block_of[n]] = g.node( n ).output;
+  return outputs;
+}
+
+} /* namespace detail */
+
+/*! \brief Writes the merged protocol in DOT format
+ *
+ * States are labeled with their output, transitions with the input
+ * that leads to the target state.
+ */
+inline void write_dot( protocol_graph& g, protocol_partition const& p, std::ostream& os )
+{
+  auto const& symbols = g.symbol_pool();
+  auto const outputs = detail::protocol_block_outputs( g, p );
+  auto const transitions = detail::protocol_transitions( g, p );
+
+  os << "digraph protocol {\n";
+  for ( auto b = 0u; b < p.num_blocks; ++b )
+    os << fmt::format( "  s{} [label=\"{}\"];\n", b, detail::dot_escape( symbols[outputs[b]] ) );
+  for ( auto const& [source, input, target] : transitions )
+    os << fmt::format( "  s{} -> s{} [label=\"{}\"];\n", source, target, detail::dot_escape( symbols[input] ) );
+  os << "}\n";
+}
+
+/*! \brief Returns the merged protocol as JSON
+ *
+ * The result has a list of states with their outputs and a list of
+ * transitions with source, input, and target.  The initial state is
+ * the state of the root.
+ */
+inline nlohmann::json protocol_to_json( protocol_graph& g, protocol_partition const& p )
+{
+  auto const& symbols = g.symbol_pool();
+  auto const outputs = detail::protocol_block_outputs( g, p );
+
+  auto states = nlohmann::json::array();
+  for ( auto b = 0u; b < p.num_blocks; ++b )
+    states.push_back( { { "id", b }, { "output", std::string( symbols[outputs[b]] ) } } );
+
+  auto transitions = nlohmann::json::array();
+  for ( auto const& [source, input, target] : detail::protocol_transitions( g, p ) )
+    transitions.push_back( { { "source", source }, { "input", std::string( symbols[input] ) }, { "target", target } } );
+
+  return { { "initial", p.block_of.empty() ? 0u : p.block_of[0u] }, { "states", states }, { "transitions", transitions } };
+}
+
+inline void write_json( protocol_graph& g, protocol_partition const& p, std::ostream& os )
+{
+  os << protocol_to_json( g, p ).dump() << '\n';
+}
+
+} /* namespace copycat */
@@ -32,6 +32,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
 #include <vector>
 #include <iostream>
 
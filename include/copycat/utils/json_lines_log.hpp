@@ -0,0 +1,224 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file json_lines_log.hpp
+  \brief Append-only log with one JSON record per line
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include <json/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace copycat
+{
+
+struct json_lines_log_parameters
+{
+  /*! \brief Keep the records of an existing log and append to it */
+  bool resume = false;
+
+  /*! \brief Field that identifies a record when resuming */
+  std::string key = "benchmark";
+
+  /*! \brief Field that holds the status of a record */
+  std::string status_key = "status";
+
+  /*! \brief Flush after this many records (1: after every record) */
+  uint32_t flush_interval = 1u;
+
+  /*! \brief Size of the output buffer in bytes */
+  uint32_t buffer_size = 1u << 16u;
+}; /* json_lines_log_parameters */
+
+/*! \brief Append-only JSON Lines log
+ *
+ * Each record is written as a single line of JSON.  Other than
+ * rewriting a JSON array, appending a record costs time proportional
+ * to its size only.
+ *
+ * In resume mode, the records of an existing log are kept; the values
+ * of the key field of these records can be queried with `contains` to
+ * skip work that has already been logged, and `status` returns the
+ * status field of the last record with a key, e.g., to retry failed
+ * work.  An incomplete last line, e.g., after a crash, is removed.
+ */
+class json_lines_log
+{
+public:
+  explicit json_lines_log( std::string const& filename, json_lines_log_parameters const& ps = {} )
+    : _ps( ps )
+    , _buffer( ps.buffer_size )
+  {
+    if ( ps.resume )
+      load( filename );
+
+    _os.rdbuf()->pubsetbuf( _buffer.data(), _buffer.size() );
+    _os.open( filename, ps.resume ? std::ios::app : std::ios::trunc );
+  }
+
+  ~json_lines_log()
+  {
+    flush();
+  }
+
+  bool good() const
+  {
+    return _os.good();
+  }
+
+  /*! \brief Returns true if the log has a record with the given key */
+  bool contains( std::string const& key ) const
+  {
+    return _keys.find( key ) != _keys.end();
+  }
+
+  /*! \brief Returns the status of the last record with the given key
+   *
+   * The status is empty if the record has no status field and
+   * `std::nullopt` if there is no record with the key.
+   */
+  std::optional<std::string> status( std::string const& key ) const
+  {
+    auto const it = _keys.find( key );
+    if ( it == _keys.end() )
+      return std::nullopt;
+    return it->second;
+  }
+
+  /*! \brief Number of records, including those of a resumed log */
+  uint64_t num_records() const
+  {
+    return _num_records;
+  }
+
+  /*! \brief Appends a record */
+  void append( nlohmann::json const& record )
+  {
+    _os << record.dump() << '\n';
+    add_key( record );
+
+    ++_num_records;
+    if ( ++_num_unflushed >= _ps.flush_interval )
+      flush();
+  }
+
+  void flush()
+  {
+    _os.flush();
+    _num_unflushed = 0u;
+  }
+
+protected:
+  void add_key( nlohmann::json const& record )
+  {
+    if ( !record.count( _ps.key ) || !record[_ps.key].is_string() )
+      return;
+
+    auto const status = record.count( _ps.status_key ) && record[_ps.status_key].is_string() ?
+      record[_ps.status_key].get<std::string>() : std::string();
+    _keys[record[_ps.key].get<std::string>()] = status;
+  }
+
+  void load( std::string const& filename )
+  {
+    std::ifstream is( filename, std::ios::in | std::ios::binary );
+    if ( !is.is_open() )
+      return;
+
+    uint64_t complete_size = 0u;
+    std::string line;
+    while ( std::getline( is, line ) )
+    {
+      /* the last line of a crashed run may lack the newline */
+      if ( is.eof() )
+        break;
+
+      complete_size += line.size() + 1u;
+      if ( line.empty() )
+        continue;
+
+      auto const record = nlohmann::json::parse( line, nullptr, false );
+      if ( record.is_discarded() )
+      {
+        std::cout << "[w] ignore malformed log record" << std::endl;
+        continue;
+      }
+
+      ++_num_records;
+      add_key( record );
+    }
+    is.close();
+
+    std::error_code ec;
+    if ( std::filesystem::file_size( filename, ec ) != complete_size && !ec )
+      std::filesystem::resize_file( filename, complete_size, ec );
+  }
+
+protected:
+  json_lines_log_parameters const _ps;
+  std::vector<char> _buffer;
+  std::ofstream _os;
+
+  /* key of each record and the status of its last record */
+  std::unordered_map<std::string, std::string> _keys;
+  uint64_t _num_records{0u};
+  uint32_t _num_unflushed{0u};
+}; /* json_lines_log */
+
+/*! \brief Reads a JSON Lines file record by record
+ *
+ * Calls `fn` for each well-formed record; stops if `fn` returns false.
+ */
+template<typename Fn>
+bool read_json_lines( std::string const& filename, Fn&& fn )
+{
+  std::ifstream is( filename, std::ios::in );
+  if ( !is.is_open() )
+    return false;
+
+  std::string line;
+  while ( std::getline( is, line ) )
+  {
+    if ( line.empty() )
+      continue;
+
+    auto const record = nlohmann::json::parse( line, nullptr, false );
+    if ( !record.is_discarded() && !fn( record ) )
+      break;
+  }
+  return true;
+}
+
+} /* namespace copycat */
@@ -0,0 +1,136 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file memory_mapped_file.hpp
+  \brief Read-only view of a file in memory
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define COPYCAT_HAS_MMAP
+#endif
+
+namespace copycat
+{
+
+/*! \brief Read-only view of a file in memory
+ *
+ * Maps a file into memory if the platform supports `mmap`;
+ * otherwise (or if mapping fails) the file is read into an internal
+ * buffer.  In both cases, the contents are accessible as a
+ * `std::string_view` that stays valid for the lifetime of the object.
+ */
+class memory_mapped_file
+{
+public:
+  explicit memory_mapped_file( std::string const& filename )
+  {
+#ifdef COPYCAT_HAS_MMAP
+    int const fd = ::open( filename.c_str(), O_RDONLY );
+    if ( fd >= 0 )
+    {
+      struct stat st;
+      if ( ::fstat( fd, &st ) == 0 )
+      {
+        _good = true;
+        _size = static_cast<std::size_t>( st.st_size );
+        if ( _size > 0u )
+        {
+          void* addr = ::mmap( nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0 );
+          if ( addr != MAP_FAILED )
+          {
+            ::madvise( addr, _size, MADV_SEQUENTIAL );
+            _mapped = static_cast<char const*>( addr );
+          }
+        }
+      }
+      ::close( fd );
+      if ( _mapped || _size == 0u )
+        return;
+    }
+#endif
+
+    /* fall back to reading the file into memory */
+    std::ifstream ifs( filename, std::ios::in | std::ios::binary );
+    _good = bool( ifs );
+    _buffer.assign( std::istreambuf_iterator<char>( ifs ), std::istreambuf_iterator<char>() );
+    _size = _buffer.size();
+  }
+
+  ~memory_mapped_file()
+  {
+#ifdef COPYCAT_HAS_MMAP
+    if ( _mapped )
+      ::munmap( const_cast<char*>( _mapped ), _size );
+#endif
+  }
+
+  memory_mapped_file( memory_mapped_file const& ) = delete;
+  memory_mapped_file& operator=( memory_mapped_file const& ) = delete;
+
+  /*! \brief Returns true if and only if the file could be opened */
+  bool good() const
+  {
+    return _good;
+  }
+
+  /*! \brief Returns true if and only if the file is mapped into memory */
+  bool is_mapped() const
+  {
+    return _mapped != nullptr;
+  }
+
+  /*! \brief Returns the contents of the file */
+  std::string_view view() const
+  {
+    return _mapped ? std::string_view( _mapped, _size ) : std::string_view( _buffer );
+  }
+
+  std::size_t size() const
+  {
+    return _size;
+  }
+
+protected:
+  bool _good{false};
+  char const* _mapped{nullptr};
+  std::size_t _size{0u};
+  std::string _buffer;
+}; /* memory_mapped_file */
+
+} /* namespace copycat */
@@ -0,0 +1,422 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file profiler.hpp
+  \brief Hierarchical timers and counters
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include <copycat/utils/stopwatch.hpp>
+#include <json/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace copycat
+{
+
+/*! \brief Profiling registry
+ *
+ * Collects the time spent in named, nested scopes together with named
+ * counters.  Every thread records into its own tree, which is found
+ * through a thread-local cache, such that timers and counters do not
+ * take a lock.  The trees of all threads are merged by scope name when
+ * reporting.
+ *
+ * Scopes are opened with a `scoped_timer`.  All functions that take a
+ * `profiler*` accept `nullptr`, which disables profiling at the cost
+ * of one branch.  Reporting (`to_json`, `write_folded`) and `clear`
+ * must not run concurrently with open scopes.
+ *
+ * Counter names are interned: `counter` maps a name to an id once,
+ * after which `count` takes constant time, which matters in hot paths
+ * such as adding clauses to a solver.
+ *
+   \verbatim embed:rst
+
+   Example
+
+   .. code-block:: c++
+
+      profiler prof;
+      auto const num_clauses = prof.counter( "#clauses" );
+      {
+        scoped_timer t( &prof, "encode" );
+        {
+          scoped_timer t2( &prof, "clauses" );
+          prof.count( num_clauses, 42 );
+        }
+      }
+      std::cout << prof.to_json().dump( 2 ) << std::endl;
+      prof.write_folded( std::cout, "benchmark" );
+   \endverbatim
+ */
+class profiler
+{
+public:
+  using clock = std::chrono::steady_clock;
+  using duration = stopwatch<clock>::duration;
+  using counter_id = uint32_t;
+
+  friend class scoped_timer;
+
+private:
+  struct counter_value
+  {
+    int64_t value = 0;
+    bool used = false;
+  };
+
+  struct node
+  {
+    std::string name;
+    uint32_t parent = 0u;
+    std::vector<uint32_t> children;
+    duration time{0};
+    uint64_t calls = 0u;
+
+    /* indexed by counter id */
+    std::vector<counter_value> counters;
+  };
+
+  struct thread_profile
+  {
+    std::thread::id id;
+
+    /* nodes never move, such that timers can refer to their duration */
+    std::deque<node> nodes{ node{} };
+    uint32_t current = 0u;
+  };
+
+public:
+  explicit profiler()
+    : _id( next_id() )
+  {
+  }
+
+  profiler( profiler const& ) = delete;
+  profiler& operator=( profiler const& ) = delete;
+
+  /*! \brief Returns the id of the counter `name`
+   *
+   * Ids are shared by all threads and scopes and remain valid after
+   * `clear`.
+   */
+  counter_id counter( std::string_view name )
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    auto const it = std::find( _counter_names.begin(), _counter_names.end(), name );
+    if ( it != _counter_names.end() )
+      return counter_id( it - _counter_names.begin() );
+
+    _counter_names.emplace_back( name );
+    return counter_id( _counter_names.size() - 1u );
+  }
+
+  /*! \brief Adds `value` to counter `id` of the innermost scope of the calling thread */
+  void count( counter_id id, int64_t value = 1 )
+  {
+    auto& p = local();
+    auto& counters = p.nodes[p.current].counters;
+    if ( counters.size() <= id )
+      counters.resize( id + 1u );
+    counters[id].value += value;
+    counters[id].used = true;
+  }
+
+  /*! \brief Adds `value` to the counter `name` (looks up the name on every call) */
+  void count( std::string_view name, int64_t value = 1 )
+  {
+    count( counter( name ), value );
+  }
+
+  /*! \brief Returns the number of threads that recorded into the profiler */
+  uint32_t num_threads() const
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    return _threads.size();
+  }
+
+  /*! \brief Removes all scopes and counters */
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _threads.clear();
+
+    /* invalidates the thread-local caches */
+    _id = next_id();
+  }
+
+  /*! \brief Returns the merged scopes as nested JSON object
+   *
+   * Each scope is an object with the entries `time` (in seconds),
+   * `calls`, and, if not empty, `counters` (keyed by counter name) and
+   * `children` (keyed by scope name).
+   */
+  nlohmann::json to_json() const
+  {
+    auto const merged = merge();
+
+    std::vector<std::string> counter_names;
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      counter_names = _counter_names;
+    }
+
+    auto json = node_to_json( merged, 0u, counter_names );
+    json.erase( "calls" );
+
+    duration total{0};
+    for ( auto const& c : merged.nodes[0u].children )
+      total += merged.nodes[c].time;
+    json["time"] = to_seconds( total );
+    json["threads"] = num_threads();
+    return json;
+  }
+
+  /*! \brief Writes the merged scopes in folded-stack format
+   *
+   * Each line consists of the `;`-separated path of a scope followed
+   * by its self time in microseconds, as expected by flamegraph.pl.
+   * The prefix, if not empty, is the outermost frame of every path.
+   * Semicolons and whitespace in frames are replaced by `_`.
+   */
+  void write_folded( std::ostream& os, std::string const& prefix = "" ) const
+  {
+    write_folded( to_json(), os, prefix );
+  }
+
+  /*! \brief Writes a profile obtained from `to_json` in folded-stack format */
+  static void write_folded( nlohmann::json const& profile, std::ostream& os, std::string const& prefix = "" )
+  {
+    if ( !profile.count( "children" ) )
+      return;
+
+    for ( auto it = profile["children"].begin(); it != profile["children"].end(); ++it )
+      write_folded_rec( it.value(), prefix.empty() ? folded_frame( it.key() ) : folded_frame( prefix ) + ";" + folded_frame( it.key() ), os );
+  }
+
+private:
+  static std::string folded_frame( std::string frame )
+  {
+    std::replace_if( frame.begin(), frame.end(), []( char c ){ return c == ';' || std::isspace( static_cast<unsigned char>( c ) ); }, '_' );
+    return frame;
+  }
+
+  static uint64_t next_id()
+  {
+    static std::atomic<uint64_t> id{1u};
+    return id++;
+  }
+
+  thread_profile& local()
+  {
+    thread_local uint64_t cached_id = 0u;
+    thread_local thread_profile* cached = nullptr;
+    if ( cached_id == _id )
+      return *cached;
+
+    std::lock_guard<std::mutex> lock( _mutex );
+    auto const id = std::this_thread::get_id();
+    auto it = std::find_if( _threads.begin(), _threads.end(), [&]( auto const& p ){ return p->id == id; } );
+    if ( it == _threads.end() )
+    {
+      _threads.emplace_back( std::make_unique<thread_profile>() );
+      _threads.back()->id = id;
+      it = _threads.end() - 1;
+    }
+
+    cached_id = _id;
+    cached = it->get();
+    return *cached;
+  }
+
+  static uint32_t find_or_create_child( thread_profile& p, uint32_t parent, std::string_view name )
+  {
+    for ( auto const& c : p.nodes[parent].children )
+      if ( p.nodes[c].name == name )
+        return c;
+
+    uint32_t const index = p.nodes.size();
+    p.nodes.emplace_back();
+    p.nodes.back().name = std::string( name );
+    p.nodes.back().parent = parent;
+    p.nodes[parent].children.emplace_back( index );
+    return index;
+  }
+
+  static void merge_rec( thread_profile& out, uint32_t out_index, thread_profile const& in, uint32_t in_index )
+  {
+    auto const& n = in.nodes[in_index];
+    out.nodes[out_index].time += n.time;
+    out.nodes[out_index].calls += n.calls;
+    auto& counters = out.nodes[out_index].counters;
+    if ( counters.size() < n.counters.size() )
+      counters.resize( n.counters.size() );
+    for ( auto i = 0u; i < n.counters.size(); ++i )
+    {
+      counters[i].value += n.counters[i].value;
+      counters[i].used = counters[i].used || n.counters[i].used;
+    }
+
+    for ( auto const& c : n.children )
+      merge_rec( out, find_or_create_child( out, out_index, in.nodes[c].name ), in, c );
+  }
+
+  thread_profile merge() const
+  {
+    thread_profile merged;
+    std::lock_guard<std::mutex> lock( _mutex );
+    for ( auto const& p : _threads )
+      merge_rec( merged, 0u, *p, 0u );
+    return merged;
+  }
+
+  static nlohmann::json node_to_json( thread_profile const& p, uint32_t index, std::vector<std::string> const& counter_names )
+  {
+    auto const& n = p.nodes[index];
+
+    auto json = nlohmann::json( {} );
+    json["time"] = to_seconds( n.time );
+    json["calls"] = n.calls;
+
+    auto counters = nlohmann::json( {} );
+    for ( auto i = 0u; i < n.counters.size(); ++i )
+      if ( n.counters[i].used )
+        counters[counter_names.at( i )] = n.counters[i].value;
+    if ( !counters.empty() )
+      json["counters"] = counters;
+
+    if ( !n.children.empty() )
+    {
+      auto children = nlohmann::json( {} );
+      for ( auto const& c : n.children )
+        children[p.nodes[c].name] = node_to_json( p, c, counter_names );
+      json["children"] = children;
+    }
+    return json;
+  }
+
+  static void write_folded_rec( nlohmann::json const& scope, std::string const& path, std::ostream& os )
+  {
+    auto self = scope["time"].get<double>();
+    if ( scope.count( "children" ) )
+    {
+      for ( auto it = scope["children"].begin(); it != scope["children"].end(); ++it )
+      {
+        self -= it.value()["time"].get<double>();
+        write_folded_rec( it.value(), path + ";" + folded_frame( it.key() ), os );
+      }
+    }
+
+    auto const us = std::llround( std::max( self, 0.0 ) * 1e6 );
+    if ( us > 0 )
+      os << path << ' ' << us << '\n';
+  }
+
+private:
+  uint64_t _id;
+  mutable std::mutex _mutex;
+  std::vector<std::unique_ptr<thread_profile>> _threads;
+  std::vector<std::string> _counter_names;
+}; /* profiler */
+
+/*! \brief Times a named scope of a profiler
+ *
+ * Opens the scope `name` inside the innermost open scope of the
+ * calling thread and closes it at destruction.  `next` closes the
+ * scope and opens a sibling, which allows to time consecutive phases
+ * of a function without introducing blocks.  Does nothing if the
+ * profiler is `nullptr`.
+ */
+class scoped_timer
+{
+public:
+  explicit scoped_timer( profiler* prof, std::string_view name )
+  {
+    if ( prof != nullptr )
+    {
+      _profile = &prof->local();
+      enter( name );
+    }
+  }
+
+  scoped_timer( scoped_timer const& ) = delete;
+  scoped_timer& operator=( scoped_timer const& ) = delete;
+
+  ~scoped_timer()
+  {
+    if ( _profile != nullptr )
+      leave();
+  }
+
+  /*! \brief Closes the scope and opens the sibling scope `name` */
+  void next( std::string_view name )
+  {
+    if ( _profile == nullptr )
+      return;
+
+    leave();
+    enter( name );
+  }
+
+private:
+  void enter( std::string_view name )
+  {
+    _node = profiler::find_or_create_child( *_profile, _profile->current, name );
+    _profile->current = _node;
+    _watch.emplace( _profile->nodes[_node].time );
+  }
+
+  void leave()
+  {
+    _watch.reset();
+    auto& n = _profile->nodes[_node];
+    ++n.calls;
+    _profile->current = n.parent;
+  }
+
+private:
+  profiler::thread_profile* _profile{nullptr};
+  uint32_t _node{0u};
+  std::optional<stopwatch<profiler::clock>> _watch;
+}; /* scoped_timer */
+
+} /* namespace copycat */
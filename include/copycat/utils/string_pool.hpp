@@ -0,0 +1,159 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file string_pool.hpp
+  \brief Interned strings with integer IDs
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace copycat
+{
+
+/*! \brief Pool of interned strings
+ *
+ * Maps each distinct string to a dense ID (0, 1, ...).  The characters
+ * of all strings are stored in one buffer, and the IDs are found with
+ * an open-addressing hash table over the stored hashes, such that
+ * interning a known string neither allocates nor copies.
+ */
+class string_pool
+{
+public:
+  using id_type = uint32_t;
+
+public:
+  explicit string_pool( uint32_t initial_capacity = 64u )
+  {
+    uint32_t capacity = 16u;
+    while ( capacity < 2u * initial_capacity )
+      capacity <<= 1u;
+    table.assign( capacity, empty );
+  }
+
+  /*! \brief Returns the ID of `s`, adding it to the pool if necessary */
+  id_type intern( std::string_view s )
+  {
+    auto const h = std::hash<std::string_view>{}( s );
+    auto slot = find_slot( s, h );
+    if ( table[slot] != empty )
+      return table[slot];
+
+    auto const id = id_type( hashes.size() );
+    offsets.emplace_back( chars.size() );
+    chars.insert( chars.end(), s.begin(), s.end() );
+    hashes.emplace_back( h );
+    table[slot] = id;
+
+    /* keep the load factor below 1/2 */
+    if ( 2u * hashes.size() > table.size() )
+      rehash();
+    return id;
+  }
+
+  /*! \brief Returns the ID of `s` if it is in the pool */
+  std::optional<id_type> find( std::string_view s ) const
+  {
+    auto const slot = find_slot( s, std::hash<std::string_view>{}( s ) );
+    if ( table[slot] == empty )
+      return std::nullopt;
+    return table[slot];
+  }
+
+  /*! \brief Returns the string with ID `id`
+   *
+   * The view is invalidated by the next call of `intern`.
+   */
+  std::string_view operator[]( id_type id ) const
+  {
+    assert( id < hashes.size() );
+    auto const begin = offsets[id];
+    auto const end = id + 1u < offsets.size() ? offsets[id + 1u] : chars.size();
+    return std::string_view( chars.data() + begin, end - begin );
+  }
+
+  /*! \brief Number of distinct strings */
+  uint32_t size() const
+  {
+    return uint32_t( hashes.size() );
+  }
+
+  void clear()
+  {
+    chars.clear();
+    offsets.clear();
+    hashes.clear();
+    std::fill( table.begin(), table.end(), empty );
+  }
+
+protected:
+  static constexpr id_type empty = ~id_type( 0u );
+
+  std::size_t find_slot( std::string_view s, std::size_t h ) const
+  {
+    auto const mask = table.size() - 1u;
+    for ( auto slot = h & mask; ; slot = ( slot + 1u ) & mask )
+    {
+      auto const id = table[slot];
+      if ( id == empty || ( hashes[id] == h && operator[]( id ) == s ) )
+        return slot;
+    }
+  }
+
+  void rehash()
+  {
+    table.assign( 2u * table.size(), empty );
+    auto const mask = table.size() - 1u;
+    for ( auto id = 0u; id < hashes.size(); ++id )
+    {
+      auto slot = hashes[id] & mask;
+      while ( table[slot] != empty )
+        slot = ( slot + 1u ) & mask;
+      table[slot] = id;
+    }
+  }
+
+protected:
+  std::vector<char> chars;
+  std::vector<std::size_t> offsets;
+  std::vector<std::size_t> hashes;
+
+  /* IDs by hash slot */
+  std::vector<id_type> table;
+}; /* string_pool */
+
+} /* namespace copycat */
@@ -32,15 +32,18 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cctype>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace copycat
 {
 
 /*! \brief Split string by delimiter */
-std::vector<std::string> split_path( std::string const& s, std::set<char> const& delimiters )
+inline std::vector<std::string> split_path( std::string const& s, std::set<char> const& delimiters )
 {
   std::vector<std::string> result;
 
@@ -68,7 +71,7 @@ std::vector<std::string> split_path( std::string const& s, std::set<char> const&
 }
 
 /*! \brief Convert string to upper case */
-std::string to_upper( std::string s )
+inline std::string to_upper( std::string s )
 {
   std::transform(
     s.begin(), s.end(), s.begin(),
@@ -77,4 +80,48 @@ std::string to_upper( std::string s )
   return s;
 }
 
+/*! \brief Calls `fn` for each line of the buffer (without the line break)
+ *
+ * Stops as soon as `fn` returns false.
+ */
+template<typename Fn>
+inline void foreach_line( std::string_view buffer, Fn&& fn )
+{
+  std::size_t pos = 0u;
+  while ( pos < buffer.size() )
+  {
+    auto end = buffer.find( '\n', pos );
+    if ( end == std::string_view::npos )
+      end = buffer.size();
+
+    auto const line = buffer.substr( pos, end - pos );
+    pos = end + 1u;
+
+    if ( !fn( line ) )
+      return;
+  }
+}
+
+/*! \brief Splits a buffer into chunks of about `chunk_size` bytes at line boundaries */
+inline std::vector<std::string_view> split_at_lines( std::string_view buffer, std::size_t chunk_size )
+{
+  std::vector<std::string_view> chunks;
+  chunk_size = std::max<std::size_t>( chunk_size, 1u );
+
+  std::size_t pos = 0u;
+  while ( pos < buffer.size() )
+  {
+    auto end = std::min( buffer.size(), pos + chunk_size );
+    if ( end < buffer.size() )
+    {
+      /* extend the chunk to the end of the current line */
+      auto const line_end = buffer.find( '\n', end - 1u );
+      end = line_end == std::string_view::npos ? buffer.size() : line_end + 1u;
+    }
+    chunks.emplace_back( buffer.substr( pos, end - pos ) );
+    pos = end;
+  }
+  return chunks;
+}
+
 } /* namespace copycat */
@@ -0,0 +1,360 @@
+/* copycat
+ * Copyright (C) 2018  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file subprocess_pool.hpp
+  \brief Run jobs in parallel subprocesses with time and memory limits
+
+  \author Heinz Riener
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define COPYCAT_HAS_FORK 1
+#endif
+
+namespace copycat
+{
+
+struct subprocess_pool_parameters
+{
+  /*! \brief Number of jobs that run at the same time */
+  uint32_t num_workers = std::max( 1u, std::thread::hardware_concurrency() );
+
+  /*! \brief Wall-clock time limit per job in seconds (0: no limit) */
+  double timeout = 0.0;
+
+  /*! \brief Address-space limit per job in bytes (0: no limit) */
+  uint64_t memory_limit = 0u;
+
+  /*! \brief Discard what jobs write to standard output */
+  bool quiet_workers = true;
+
+  /*! \brief Print aggregated progress */
+  bool progress = true;
+}; /* subprocess_pool_parameters */
+
+enum class job_status
+{
+  success,
+  failed,
+  timeout,
+  memory_limit,
+  crashed,
+}; /* job_status */
+
+inline std::string job_status_to_string( job_status status )
+{
+  switch ( status )
+  {
+  case job_status::success:
+    return "success";
+  case job_status::failed:
+    return "failed";
+  case job_status::timeout:
+    return "timeout";
+  case job_status::memory_limit:
+    return "memory_limit";
+  case job_status::crashed:
+    return "crashed";
+  }
+  return "unknown";
+}
+
+struct job_result
+{
+  uint32_t index;
+  job_status status;
+
+  /* string returned by the job */
+  std::string output;
+
+  /* wall-clock time in seconds */
+  double time;
+}; /* job_result */
+
+/*! \brief Pool of worker subprocesses
+ *
+ * Each job runs in a forked subprocess, such that a job that runs out
+ * of time or memory or crashes does not affect other jobs.  A job is a
+ * function that maps the job index to a string, which is sent back to
+ * the parent through a pipe.  Results are reported in the order of
+ * the job indices, independent of the order in which jobs finish.
+ *
+ * On platforms without `fork`, the jobs run sequentially in-process
+ * without limits.
+ */
+class subprocess_pool
+{
+public:
+  using job_type = std::function<std::string( uint32_t )>;
+  using result_callback_type = std::function<void( job_result const& )>;
+
+public:
+  explicit subprocess_pool( subprocess_pool_parameters const& ps = {} )
+    : _ps( ps )
+  {
+  }
+
+  /*! \brief Runs `num_jobs` jobs and calls `on_result` in job order */
+  void run( uint32_t num_jobs, job_type const& job, result_callback_type const& on_result )
+  {
+    std::map<uint32_t, job_result> finished;
+    uint32_t next_to_report = 0u;
+    uint32_t num_finished = 0u;
+
+    auto const report = [&]( job_result const& result ){
+      finished.emplace( result.index, result );
+      ++num_finished;
+      while ( !finished.empty() && finished.begin()->first == next_to_report )
+      {
+        on_result( finished.begin()->second );
+        finished.erase( finished.begin() );
+        ++next_to_report;
+      }
+      print_progress( num_finished, num_jobs );
+    };
+
+#ifdef COPYCAT_HAS_FORK
+    run_forked( num_jobs, job, report );
+#else
+    for ( auto i = 0u; i < num_jobs; ++i )
+    {
+      auto const start = std::chrono::steady_clock::now();
+      job_result result{i, job_status::success, {}, 0.0};
+      try
+      {
+        result.output = job( i );
+      }
+      catch ( std::bad_alloc const& )
+      {
+        result.status = job_status::memory_limit;
+      }
+      catch ( ... )
+      {
+        result.status = job_status::failed;
+      }
+      result.time = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      report( result );
+    }
+#endif
+
+    if ( _ps.progress && num_jobs > 0u )
+      std::cout << std::endl;
+  }
+
+protected:
+  void print_progress( uint32_t num_finished, uint32_t num_jobs ) const
+  {
+    if ( !_ps.progress )
+      return;
+
+    std::cout << fmt::format( "[i] jobs = {} / {} ({:6.2f}%)\r", num_finished, num_jobs,
+                              ( 100.00 * num_finished ) / double( num_jobs ) );
+    std::cout.flush();
+  }
+
+#ifdef COPYCAT_HAS_FORK
+  struct worker
+  {
+    uint32_t index;
+    pid_t pid;
+    int fd;
+    std::chrono::steady_clock::time_point start;
+    std::string output;
+    bool timed_out;
+  }; /* worker */
+
+  /* exit codes of a job subprocess */
+  static constexpr int exit_failed = 1;
+  static constexpr int exit_memory_limit = 3;
+
+  template<typename Report>
+  void run_forked( uint32_t num_jobs, job_type const& job, Report&& report )
+  {
+    std::vector<worker> workers;
+    uint32_t next_job = 0u;
+
+    while ( next_job < num_jobs || !workers.empty() )
+    {
+      while ( next_job < num_jobs && workers.size() < _ps.num_workers )
+      {
+        if ( auto w = launch( next_job, job ) )
+          workers.emplace_back( *w );
+        else
+          report( job_result{next_job, job_status::failed, {}, 0.0} );
+        ++next_job;
+      }
+
+      if ( workers.empty() )
+        continue;
+
+      std::vector<pollfd> fds;
+      for ( const auto& w : workers )
+        fds.push_back( pollfd{w.fd, POLLIN, 0} );
+      ::poll( fds.data(), fds.size(), 50 );
+
+      auto const now = std::chrono::steady_clock::now();
+      for ( auto i = workers.size(); i-- > 0u; )
+      {
+        auto& w = workers[i];
+        bool done = false;
+        if ( fds[i].revents & ( POLLIN | POLLHUP | POLLERR ) )
+        {
+          char buffer[4096];
+          auto const n = ::read( w.fd, buffer, sizeof( buffer ) );
+          if ( n > 0 )
+            w.output.append( buffer, n );
+          else
+            done = true;
+        }
+
+        if ( !done && !w.timed_out && _ps.timeout > 0.0 &&
+             std::chrono::duration<double>( now - w.start ).count() > _ps.timeout )
+        {
+          ::kill( w.pid, SIGKILL );
+          w.timed_out = true;
+        }
+
+        if ( done )
+        {
+          report( finish( w ) );
+          workers.erase( workers.begin() + i );
+        }
+      }
+    }
+  }
+
+  std::optional<worker> launch( uint32_t index, job_type const& job )
+  {
+    int fds[2];
+    if ( ::pipe( fds ) != 0 )
+      return std::nullopt;
+
+    /* do not duplicate buffered output into the child */
+    std::cout.flush();
+    std::fflush( nullptr );
+
+    auto const pid = ::fork();
+    if ( pid < 0 )
+    {
+      ::close( fds[0] );
+      ::close( fds[1] );
+      return std::nullopt;
+    }
+
+    if ( pid == 0 )
+    {
+      ::close( fds[0] );
+      if ( _ps.quiet_workers )
+      {
+        auto const null = ::open( "/dev/null", O_WRONLY );
+        if ( null >= 0 )
+          ::dup2( null, STDOUT_FILENO );
+      }
+
+      if ( _ps.memory_limit > 0u )
+      {
+        rlimit limit{rlim_t( _ps.memory_limit ), rlim_t( _ps.memory_limit )};
+        ::setrlimit( RLIMIT_AS, &limit );
+      }
+
+      int code = 0;
+      try
+      {
+        auto const output = job( index );
+        for ( std::size_t pos = 0u; pos < output.size(); )
+        {
+          auto const n = ::write( fds[1], output.data() + pos, output.size() - pos );
+          if ( n <= 0 )
+            break;
+          pos += n;
+        }
+      }
+      catch ( std::bad_alloc const& )
+      {
+        code = exit_memory_limit;
+      }
+      catch ( ... )
+      {
+        code = exit_failed;
+      }
+      std::cout.flush();
+      ::_exit( code );
+    }
+
+    ::close( fds[1] );
+    return worker{index, pid, fds[0], std::chrono::steady_clock::now(), {}, false};
+  }
+
+  job_result finish( worker& w )
+  {
+    ::close( w.fd );
+
+    int status = 0;
+    ::waitpid( w.pid, &status, 0 );
+
+    job_result result{w.index, job_status::success, std::move( w.output ), 0.0};
+    result.time = std::chrono::duration<double>( std::chrono::steady_clock::now() - w.start ).count();
+    if ( w.timed_out )
+      result.status = job_status::timeout;
+    else if ( WIFSIGNALED( status ) )
+      result.status = job_status::crashed;
+    else if ( WIFEXITED( status ) && WEXITSTATUS( status ) == exit_memory_limit )
+      result.status = job_status::memory_limit;
+    else if ( !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 )
+      result.status = job_status::failed;
+
+    if ( result.status != job_status::success )
+      result.output.clear();
+    return result;
+  }
+#endif
+
+protected:
+  subprocess_pool_parameters const _ps;
+}; /* subprocess_pool */
+
+} /* namespace copycat */
@@ -46,6 +46,16 @@ public:
   {
   }
 
+  uint32_t num_traces() const
+  {
+    return traces.size();
+  }
+
+  uint32_t num_time_steps() const
+  {
+    return traces.size() > 0u ? traces[0u].size() : 0u;
+  }
+
   std::vector<bool> get_trace_by_index( uint32_t index ) const
   {
     return traces.at( index );
@@ -0,0 +1,129 @@
+#include <catch.hpp>
+#include <copycat/algorithms/ltl_batch_verifier.hpp>
+#include <fmt/format.h>
+#include <random>
+
+using namespace copycat;
+
+namespace
+{
+
+using chain_t = chain<std::string, std::vector<int>>;
+
+trace random_trace( std::default_random_engine& engine )
+{
+  trace t;
+  auto const prefix_length = std::uniform_int_distribution<uint32_t>( 0u, 3u )( engine );
+  auto const suffix_length = std::uniform_int_distribution<uint32_t>( prefix_length == 0u ? 1u : 0u, 4u )( engine );
+  for ( auto i = 0u; i < prefix_length + suffix_length; ++i )
+  {
+    std::vector<int> props;
+    for ( auto p = 1; p <= 2; ++p )
+      if ( std::bernoulli_distribution( 0.5 )( engine ) )
+        props.emplace_back( p );
+
+    if ( i < prefix_length )
+      t.emplace_prefix( props );
+    else
+      t.emplace_suffix( props );
+  }
+  return t;
+}
+
+chain_t random_chain( std::default_random_engine& engine )
+{
+  std::vector<std::string> const ops = { "~", "&", "|", "->", "X", "F", "G", "U" };
+
+  chain_t c;
+  for ( auto p = 0u; p < 2u; ++p )
+    c.add_step( fmt::format( "x{}", p ), {} );
+
+  auto const num_steps = std::uniform_int_distribution<uint32_t>( 1u, 4u )( engine );
+  for ( auto s = 0u; s < num_steps; ++s )
+  {
+    auto const& op = ops[std::uniform_int_distribution<uint32_t>( 0u, ops.size() - 1u )( engine )];
+    std::uniform_int_distribution<int> fanin( 1, c.length() );
+    if ( op == "~" || op == "X" || op == "F" || op == "G" )
+      c.add_step( op, { fanin( engine ) } );
+    else
+      c.add_step( op, { fanin( engine ), fanin( engine ) } );
+  }
+  return c;
+}
+
+} /* namespace */
+
+TEST_CASE( "Verify LTL chains against a spec", "[ltl_batch_verifier]" )
+{
+  /* G( x0 -> F x1 ) */
+  chain_t c;
+  auto const x0 = c.add_step( "x0", {} );
+  auto const x1 = c.add_step( "x1", {} );
+  auto const i = c.add_step( "->", { x0, c.add_step( "F", { x1 } ) } );
+  c.add_step( "G", { i } );
+
+  /* F( x1 ) */
+  chain_t d;
+  d.add_step( "F", { d.add_step( "x1", {} ) } );
+
+  ltl_synthesis_spec spec;
+  spec.num_propositions = 2u;
+
+  /* ( {1} {} {2} )^omega */
+  trace good;
+  good.emplace_suffix( { 1 } );
+  good.emplace_suffix( {} );
+  good.emplace_suffix( { 2 } );
+  spec.good_traces.emplace_back( good );
+
+  /* {2} ( {1} )^omega */
+  trace bad;
+  bad.emplace_prefix( { 2 } );
+  bad.emplace_suffix( { 1 } );
+  spec.bad_traces.emplace_back( bad );
+
+  ltl_batch_verifier verifier( spec );
+  CHECK( verifier.verify( std::vector<chain_t>{ c, d, c } ) == std::vector<bool>{ true, false, true } );
+
+  auto const& st = verifier.statistics();
+  CHECK( st.num_chains == 3u );
+  CHECK( st.num_verified == 2u );
+  CHECK( st.num_cache_hits > 0u );
+
+  /* x0, x1, F x1, x0 -> F x1, G( x0 -> F x1 ) */
+  CHECK( verifier.num_nodes() == 5u );
+  verifier.clear_cache();
+  CHECK( verifier.num_nodes() == 0u );
+  CHECK( verifier.verify( c ) );
+}
+
+TEST_CASE( "Compare LTL batch verifier with chain evaluator", "[ltl_batch_verifier]" )
+{
+  std::default_random_engine engine( 7 );
+
+  for ( auto k = 0u; k < 20u; ++k )
+  {
+    ltl_synthesis_spec spec;
+    spec.num_propositions = 2u;
+    for ( auto j = 0u; j < 2u; ++j )
+    {
+      spec.good_traces.emplace_back( random_trace( engine ) );
+      spec.bad_traces.emplace_back( random_trace( engine ) );
+    }
+
+    ltl_batch_verifier verifier( spec );
+    for ( auto n = 0u; n < 50u; ++n )
+    {
+      auto const c = random_chain( engine );
+
+      ltl_chain_evaluator const eval( c );
+      bool expected = true;
+      for ( const auto& t : spec.good_traces )
+        expected = expected && eval.evaluate( t );
+      for ( const auto& t : spec.bad_traces )
+        expected = expected && !eval.evaluate( t );
+
+      CHECK( verifier.verify( c ) == expected );
+    }
+  }
+}
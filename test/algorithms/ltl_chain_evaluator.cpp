@@ -0,0 +1,146 @@
+#include <catch.hpp>
+#include <copycat/algorithms/ltl_chain_evaluator.hpp>
+#include <fmt/format.h>
+#include <random>
+
+using namespace copycat;
+
+namespace
+{
+
+using chain_t = chain<std::string, std::vector<int>>;
+
+/* reference semantics: follow the positions reachable from pos */
+bool evaluate_reference( chain_t const& c, trace const& t, uint32_t node, uint32_t pos )
+{
+  auto const label = c.label_at( node );
+  auto const step = c.step_at( node );
+
+  std::vector<uint32_t> path;
+  for ( auto i = pos; path.size() <= t.length(); )
+  {
+    path.emplace_back( i );
+    if ( i + 1u < t.length() )
+      ++i;
+    else if ( !t.is_finite() )
+      i = t.prefix_length();
+    else
+      break;
+  }
+
+  if ( label[0u] == 'x' )
+    return t.has( pos, std::atoi( label.c_str() + 1u ) + 1 );
+  else if ( label == "~" )
+    return !evaluate_reference( c, t, step[0u], pos );
+  else if ( label == "&" )
+    return evaluate_reference( c, t, step[0u], pos ) && evaluate_reference( c, t, step[1u], pos );
+  else if ( label == "|" )
+    return evaluate_reference( c, t, step[0u], pos ) || evaluate_reference( c, t, step[1u], pos );
+  else if ( label == "->" )
+    return !evaluate_reference( c, t, step[0u], pos ) || evaluate_reference( c, t, step[1u], pos );
+  else if ( label == "X" )
+    return path.size() > 1u && evaluate_reference( c, t, step[0u], path[1u] );
+  else if ( label == "F" )
+    return std::any_of( path.begin(), path.end(), [&]( uint32_t i ){ return evaluate_reference( c, t, step[0u], i ); } );
+  else if ( label == "G" )
+    return std::all_of( path.begin(), path.end(), [&]( uint32_t i ){ return evaluate_reference( c, t, step[0u], i ); } );
+
+  assert( label == "U" );
+  for ( const auto& i : path )
+  {
+    if ( evaluate_reference( c, t, step[1u], i ) )
+      return true;
+    if ( !evaluate_reference( c, t, step[0u], i ) )
+      return false;
+  }
+  return false;
+}
+
+} /* namespace */
+
+TEST_CASE( "Evaluate LTL chain on lasso traces", "[ltl_chain_evaluator]" )
+{
+  /* G( x0 -> F x1 ) */
+  chain_t c;
+  auto const x0 = c.add_step( "x0", {} );
+  auto const x1 = c.add_step( "x1", {} );
+  auto const f = c.add_step( "F", { x1 } );
+  auto const i = c.add_step( "->", { x0, f } );
+  c.add_step( "G", { i } );
+
+  ltl_chain_evaluator eval( c );
+
+  /* ( {1} {} {2} )^omega */
+  trace t0;
+  t0.emplace_suffix( { 1 } );
+  t0.emplace_suffix( {} );
+  t0.emplace_suffix( { 2 } );
+  CHECK( eval.evaluate( t0 ) );
+
+  /* {2} ( {1} )^omega */
+  trace t1;
+  t1.emplace_prefix( { 2 } );
+  t1.emplace_suffix( { 1 } );
+  CHECK( !eval.evaluate( t1 ) );
+  CHECK( eval.truth_vector( f ) == std::vector<bool>{ true, false } );
+
+  /* finite trace: strong next */
+  chain_t cx;
+  cx.add_step( "X", { cx.add_step( "x0", {} ) } );
+  trace t2;
+  t2.emplace_prefix( { 1 } );
+  CHECK( !ltl_chain_evaluator( cx ).evaluate( t2 ) );
+}
+
+TEST_CASE( "Compare LTL chain evaluator with reference semantics", "[ltl_chain_evaluator]" )
+{
+  std::default_random_engine engine( 42 );
+  std::vector<std::string> const ops = { "~", "&", "|", "->", "X", "F", "G", "U" };
+
+  for ( auto k = 0u; k < 200u; ++k )
+  {
+    /* random chain over 3 propositions */
+    chain_t c;
+    for ( auto p = 0u; p < 3u; ++p )
+      c.add_step( fmt::format( "x{}", p ), {} );
+
+    auto const num_steps = std::uniform_int_distribution<uint32_t>( 1u, 6u )( engine );
+    for ( auto s = 0u; s < num_steps; ++s )
+    {
+      auto const& op = ops[std::uniform_int_distribution<uint32_t>( 0u, ops.size() - 1u )( engine )];
+      std::uniform_int_distribution<int> fanin( 1, c.length() );
+      if ( op == "~" || op == "X" || op == "F" || op == "G" )
+        c.add_step( op, { fanin( engine ) } );
+      else
+        c.add_step( op, { fanin( engine ), fanin( engine ) } );
+    }
+
+    /* random trace */
+    trace t;
+    auto const prefix_length = std::uniform_int_distribution<uint32_t>( 0u, 3u )( engine );
+    auto const suffix_length = std::uniform_int_distribution<uint32_t>( prefix_length == 0u ? 1u : 0u, 4u )( engine );
+    for ( auto i = 0u; i < prefix_length + suffix_length; ++i )
+    {
+      std::vector<int> props;
+      for ( auto p = 1; p <= 3; ++p )
+        if ( std::bernoulli_distribution( 0.5 )( engine ) )
+          props.emplace_back( p );
+
+      if ( i < prefix_length )
+        t.emplace_prefix( props );
+      else
+        t.emplace_suffix( props );
+    }
+
+    ltl_chain_evaluator eval( c );
+    for ( auto n = 1u; n <= c.length(); ++n )
+    {
+      eval.evaluate( t, n );
+      auto const tv = eval.truth_vector( n );
+      for ( auto pos = 0u; pos < t.length(); ++pos )
+      {
+        CHECK( tv[pos] == evaluate_reference( c, t, n, pos ) );
+      }
+    }
+  }
+}
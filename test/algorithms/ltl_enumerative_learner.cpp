@@ -0,0 +1,162 @@
+#include <catch.hpp>
+#include <copycat/algorithms/ltl_batch_verifier.hpp>
+#include <copycat/algorithms/ltl_enumerative_learner.hpp>
+
+using namespace copycat;
+
+TEST_CASE( "Learn LTL formula by enumeration", "[ltl_enumerative_learner]" )
+{
+  ltl_synthesis_spec spec;
+  spec.num_propositions = 2u;
+
+  /* ( {1} {} {2} )^omega */
+  trace good;
+  good.emplace_suffix( { 1 } );
+  good.emplace_suffix( {} );
+  good.emplace_suffix( { 2 } );
+  spec.good_traces.emplace_back( good );
+
+  /* {2} ( {1} )^omega */
+  trace bad0;
+  bad0.emplace_prefix( { 2 } );
+  bad0.emplace_suffix( { 1 } );
+  spec.bad_traces.emplace_back( bad0 );
+
+  /* {1} ( {} )^omega */
+  trace bad1;
+  bad1.emplace_prefix( { 1 } );
+  bad1.emplace_suffix( {} );
+  spec.bad_traces.emplace_back( bad1 );
+
+  ltl_formula_store ltl;
+  ltl_enumerative_learner learner( ltl, spec );
+  auto const f = learner.run();
+  REQUIRE( f );
+
+  /* no formula of size 2 separates, X X x1 does */
+  CHECK( learner.size() == 3u );
+
+  auto const c = learner.get_chain();
+  CHECK( c.length() == 3u );
+  CHECK( ltl_batch_verifier( spec ).verify( c ) );
+
+  auto const& st = learner.statistics();
+  CHECK( st.num_candidates > st.num_pruned );
+  CHECK( st.num_pruned > 0u );
+
+  /* copies enumerate on their own */
+  auto copy = learner;
+  REQUIRE( copy.run() );
+  CHECK( copy.size() == 3u );
+}
+
+TEST_CASE( "Enumeration respects operators and size limit", "[ltl_enumerative_learner]" )
+{
+  ltl_synthesis_spec spec;
+  spec.num_propositions = 1u;
+  spec.operators = { operator_opcode::not_, operator_opcode::and_ };
+
+  /* ( {1} )^omega is good, {1} ( {} )^omega is bad: needs a temporal operator */
+  trace good;
+  good.emplace_suffix( { 1 } );
+  spec.good_traces.emplace_back( good );
+
+  trace bad;
+  bad.emplace_prefix( { 1 } );
+  bad.emplace_suffix( {} );
+  spec.bad_traces.emplace_back( bad );
+
+  ltl_formula_store ltl;
+  ltl_enumerative_learner_parameters ps;
+  ps.max_size = 4u;
+  ltl_enumerative_learner learner( ltl, spec, ps );
+  CHECK( !learner.run() );
+  CHECK( learner.statistics().max_size_explored == 4u );
+
+  spec.operators.emplace_back( operator_opcode::next_ );
+  ltl_enumerative_learner learner_with_next( ltl, spec, ps );
+  REQUIRE( learner_with_next.run() );
+  CHECK( learner_with_next.size() == 2u );
+  CHECK( ltl_batch_verifier( spec ).verify( learner_with_next.get_chain() ) );
+}
+
+TEST_CASE( "Enumeration respects the candidate limit for unary operators", "[ltl_enumerative_learner]" )
+{
+  ltl_synthesis_spec spec;
+  spec.num_propositions = 8u;
+  spec.operators = { operator_opcode::not_ };
+
+  /* ( {1} {2} ... {8} )^omega is good and bad, i.e., nothing separates */
+  trace t;
+  for ( auto p = 1; p <= 8; ++p )
+    t.emplace_suffix( { p } );
+  spec.good_traces.emplace_back( t );
+  spec.bad_traces.emplace_back( t );
+
+  ltl_formula_store ltl;
+  ltl_enumerative_learner_parameters ps;
+  ps.max_candidates = 10u;
+  ltl_enumerative_learner learner( ltl, spec, ps );
+  CHECK( !learner.run() );
+
+  /* 8 propositions and 2 negations */
+  CHECK( learner.statistics().num_candidates == 10u );
+  CHECK( learner.statistics().max_size_explored == 1u );
+}
+
+TEST_CASE( "Enumeration discards trivial candidates", "[ltl_enumerative_learner]" )
+{
+  ltl_synthesis_spec spec;
+  spec.num_propositions = 1u;
+  spec.operators = { operator_opcode::not_, operator_opcode::and_, operator_opcode::next_ };
+
+  /* ( {} {1} )^omega */
+  trace good;
+  good.emplace_suffix( {} );
+  good.emplace_suffix( { 1 } );
+  spec.good_traces.emplace_back( good );
+
+  /* ( {1} )^omega */
+  trace bad;
+  bad.emplace_suffix( { 1 } );
+  spec.bad_traces.emplace_back( bad );
+
+  ltl_enumerative_learner_parameters ps;
+  ps.filter_trivial_candidates = true;
+
+  ltl_formula_store ltl;
+  ltl_enumerative_learner learner( ltl, spec, ps );
+  REQUIRE( learner.run() );
+  CHECK( learner.size() == 2u );
+  CHECK( ltl_batch_verifier( spec ).verify( learner.get_chain() ) );
+  CHECK( learner.filter_statistics().num_queries > 0u );
+}
+
+TEST_CASE( "Enumeration keeps trivial candidates on finite traces", "[ltl_enumerative_learner]" )
+{
+  ltl_synthesis_spec spec;
+  spec.num_propositions = 1u;
+  spec.operators = { operator_opcode::not_, operator_opcode::or_, operator_opcode::next_ };
+
+  /* {1} */
+  trace good;
+  good.emplace_prefix( { 1 } );
+  spec.good_traces.emplace_back( good );
+
+  /* {1} {1} */
+  trace bad;
+  bad.emplace_prefix( { 1 } );
+  bad.emplace_prefix( { 1 } );
+  spec.bad_traces.emplace_back( bad );
+
+  ltl_enumerative_learner_parameters ps;
+  ps.filter_trivial_candidates = true;
+
+  /* X( x0 | !x0 ) is valid on infinite traces, but not at the last position of a finite trace */
+  ltl_formula_store ltl;
+  ltl_enumerative_learner learner( ltl, spec, ps );
+  REQUIRE( learner.run() );
+  CHECK( ltl_batch_verifier( spec ).verify( learner.get_chain() ) );
+  CHECK( learner.statistics().num_filtered == 0u );
+  CHECK( learner.filter_statistics().num_queries == 0u );
+}
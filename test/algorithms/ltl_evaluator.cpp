@@ -1,8 +1,69 @@
 #include <catch.hpp>
 #include <copycat/algorithms/ltl_evaluator.hpp>
+#include <array>
+#include <random>
 
 using namespace copycat;
 
+namespace
+{
+
+/* scalar reference for ltl_finite_trace_evaluator: evaluates one position recursively */
+class reference_finite_trace_evaluator
+{
+public:
+  using formula = ltl_formula_store::ltl_formula;
+  using node = ltl_formula_store::node;
+
+public:
+  explicit reference_finite_trace_evaluator( ltl_formula_store const& ltl )
+    : ltl( ltl )
+  {
+  }
+
+  bool3 evaluate_formula( formula const& f, trace const& t, uint32_t pos ) const
+  {
+    if ( ltl.is_complemented( f ) )
+      return !evaluate_formula( !f, t, pos );
+
+    auto const n = ltl.get_node( f );
+    if ( ltl.is_constant( n ) )
+      return false;
+    if ( pos >= t.length() )
+      return inconclusive3;
+    if ( ltl.is_variable( n ) )
+      return t.has( pos, n );
+
+    std::array<formula, 2u> fs;
+    ltl.foreach_fanin( n, [&]( auto const& fi, auto i ){ fs[i] = fi; } );
+
+    if ( ltl.is_or( n ) )
+      return evaluate_formula( fs[0u], t, pos ) || evaluate_formula( fs[1u], t, pos );
+    if ( ltl.is_and( n ) )
+      return evaluate_formula( fs[0u], t, pos ) && evaluate_formula( fs[1u], t, pos );
+
+    /* temporal operators are inconclusive in the last position */
+    if ( pos + 1u >= t.length() )
+      return inconclusive3;
+    if ( ltl.is_next( n ) )
+      return evaluate_formula( fs[0u], t, pos + 1u );
+    if ( ltl.is_eventually( n ) )
+      return evaluate_formula( fs[0u], t, pos ) || evaluate_formula( f, t, pos + 1u );
+    if ( ltl.is_until( n ) )
+      return evaluate_formula( fs[1u], t, pos ) ||
+        ( evaluate_formula( fs[0u], t, pos ) && evaluate_formula( f, t, pos + 1u ) );
+
+    assert( ltl.is_releases( n ) );
+    return evaluate_formula( fs[1u], t, pos ) &&
+      ( evaluate_formula( fs[0u], t, pos ) || evaluate_formula( f, t, pos + 1u ) );
+  }
+
+protected:
+  ltl_formula_store const& ltl;
+}; /* reference_finite_trace_evaluator */
+
+} /* namespace */
+
 TEST_CASE( "Evaluate LTL", "[ltl_evaluator]" )
 {
   ltl_formula_store store;
@@ -38,3 +99,184 @@ TEST_CASE( "Evaluate LTL", "[ltl_evaluator]" )
   CHECK( evaluate<ltl_finite_trace_evaluator>( property, t1, eval ).is_inconclusive() );
 #endif
 }
+
+TEST_CASE( "Evaluate LTL on finite traces with three-valued logic", "[ltl_evaluator]" )
+{
+  ltl_formula_store store;
+  auto const a = store.create_variable();
+  auto const b = store.create_variable();
+
+  std::vector<ltl_formula_store::ltl_formula> const formulas = {
+    store.create_globally( store.create_or( !a, store.create_eventually( b ) ) ),
+    store.create_releases( a, b ),
+    store.create_next( store.create_until( a, !b ) ),
+    store.create_and( store.create_next( a ), store.create_globally( b ) ),
+    store.create_until( store.create_eventually( a ), store.create_next( b ) ) };
+
+  std::default_random_engine engine( 11 );
+  ltl_finite_trace_evaluator eval( store );
+  reference_finite_trace_evaluator reference( store );
+  for ( auto k = 0u; k < 30u; ++k )
+  {
+    /* traces of up to three words, with long runs of a */
+    trace t;
+    auto const length = std::uniform_int_distribution<uint32_t>( 1u, 150u )( engine );
+    for ( auto i = 0u; i < length; ++i )
+    {
+      std::vector<int> props;
+      if ( std::bernoulli_distribution( 0.95 )( engine ) )
+        props.emplace_back( 1 );
+      if ( std::bernoulli_distribution( 0.05 )( engine ) )
+        props.emplace_back( 2 );
+      t.emplace_prefix( props );
+    }
+
+    for ( const auto& f : formulas )
+    {
+      for ( auto const pos : { 0u, 1u, 62u, 63u, 64u, 65u, length - 2u, length - 1u, length } )
+      {
+        if ( pos > length )
+          continue;
+        CHECK( eval.evaluate_formula( f, t, pos ) == reference.evaluate_formula( f, t, pos ) );
+        CHECK( eval.evaluate_formula( !f, t, pos ) == reference.evaluate_formula( !f, t, pos ) );
+      }
+    }
+    CHECK( evaluate<ltl_finite_trace_evaluator>( formulas[0u], t, eval ) == reference.evaluate_formula( formulas[0u], t, 0u ) );
+  }
+}
+
+TEST_CASE( "Evaluate LTL on lasso traces", "[ltl_evaluator]" )
+{
+  ltl_formula_store store;
+  auto const a = store.create_variable();
+  auto const b = store.create_variable();
+
+  /* G( a -> F b ), a R b, X( a U !b ) */
+  std::vector<ltl_formula_store::ltl_formula> const formulas = {
+    store.create_globally( store.create_or( !a, store.create_eventually( b ) ) ),
+    store.create_releases( a, b ),
+    store.create_next( store.create_until( a, !b ) ) };
+
+  using chain_t = ltl_chain_evaluator::chain_type;
+  std::vector<chain_t> chains( 3u );
+  {
+    auto& c = chains[0u];
+    auto const x0 = c.add_step( "x0", {} );
+    auto const f = c.add_step( "F", { c.add_step( "x1", {} ) } );
+    c.add_step( "G", { c.add_step( "->", { x0, f } ) } );
+  }
+  {
+    auto& c = chains[1u];
+    auto const na = c.add_step( "~", { c.add_step( "x0", {} ) } );
+    auto const nb = c.add_step( "~", { c.add_step( "x1", {} ) } );
+    c.add_step( "~", { c.add_step( "U", { na, nb } ) } );
+  }
+  {
+    auto& c = chains[2u];
+    auto const x0 = c.add_step( "x0", {} );
+    auto const nb = c.add_step( "~", { c.add_step( "x1", {} ) } );
+    c.add_step( "X", { c.add_step( "U", { x0, nb } ) } );
+  }
+
+  std::default_random_engine engine( 5 );
+  ltl_lasso_evaluator eval( store );
+  for ( auto k = 0u; k < 100u; ++k )
+  {
+    trace t;
+    auto const prefix_length = std::uniform_int_distribution<uint32_t>( 0u, 3u )( engine );
+    auto const suffix_length = std::uniform_int_distribution<uint32_t>( prefix_length == 0u ? 1u : 0u, 4u )( engine );
+    for ( auto i = 0u; i < prefix_length + suffix_length; ++i )
+    {
+      std::vector<int> props;
+      for ( auto p = 1; p <= 2; ++p )
+        if ( std::bernoulli_distribution( 0.5 )( engine ) )
+          props.emplace_back( p );
+
+      if ( i < prefix_length )
+        t.emplace_prefix( props );
+      else
+        t.emplace_suffix( props );
+    }
+
+    for ( auto i = 0u; i < formulas.size(); ++i )
+    {
+      ltl_chain_evaluator const chain_eval( chains[i] );
+      chain_eval.evaluate( t );
+      auto const tv = chain_eval.truth_vector( chains[i].length() );
+      for ( auto pos = 0u; pos < t.length(); ++pos )
+      {
+        CHECK( eval.evaluate_formula( formulas[i], t, pos ) == tv[pos] );
+        CHECK( eval.evaluate_formula( !formulas[i], t, pos ) == !tv[pos] );
+      }
+    }
+    CHECK( evaluate<ltl_lasso_evaluator>( formulas[0u], t, eval ) == eval.evaluate_formula( formulas[0u], t, 0u ) );
+  }
+}
+
+TEST_CASE( "Evaluate LTL with RV-LTL semantics", "[ltl_evaluator]" )
+{
+  ltl_formula_store store;
+  auto const a = store.create_variable();
+  auto const b = store.create_variable();
+
+  /* a, a */
+  trace t;
+  t.emplace_prefix( { 1 } );
+  t.emplace_prefix( { 1 } );
+
+  ltl_rv_evaluator eval( store );
+  CHECK( eval.evaluate_formula( store.create_globally( a ), t, 0u ) == presumably_true );
+  CHECK( eval.evaluate_formula( store.create_globally( !a ), t, 0u ) == bool5( false ) );
+  CHECK( eval.evaluate_formula( store.create_eventually( b ), t, 0u ) == presumably_false );
+  CHECK( eval.evaluate_formula( store.create_eventually( a ), t, 0u ) == bool5( true ) );
+  CHECK( eval.evaluate_formula( store.create_until( a, b ), t, 0u ) == presumably_false );
+  CHECK( eval.evaluate_formula( store.create_releases( b, a ), t, 0u ) == presumably_true );
+  CHECK( eval.evaluate_formula( store.create_next( a ), t, 0u ) == bool5( true ) );
+  CHECK( eval.evaluate_formula( store.create_next( store.create_next( a ) ), t, 0u ) == presumably_false );
+  CHECK( evaluate<ltl_rv_evaluator>( store.create_or( a, b ), t, eval ) == bool5( true ) );
+
+  /* trace files store traces without `::` as lassos whose suffix is the whole trace */
+  trace lasso;
+  lasso.emplace_suffix( { 1 } );
+  lasso.emplace_suffix( { 1 } );
+  CHECK( eval.evaluate_formula( store.create_globally( a ), lasso, 0u ) == presumably_true );
+  CHECK( eval.evaluate_formula( store.create_eventually( b ), lasso, 1u ) == presumably_false );
+  CHECK( eval.evaluate_formula( store.create_next( a ), lasso, 0u ) == bool5( true ) );
+
+  /* collapsing presumable values gives the strong-next semantics of the lasso evaluator */
+  std::vector<ltl_formula_store::ltl_formula> const formulas = {
+    store.create_globally( store.create_or( !a, store.create_eventually( b ) ) ),
+    store.create_releases( a, b ),
+    store.create_next( store.create_until( a, !b ) ),
+    store.create_and( store.create_next( a ), store.create_globally( b ) ) };
+
+  std::default_random_engine engine( 7 );
+  ltl_lasso_evaluator lasso_eval( store );
+  for ( auto k = 0u; k < 100u; ++k )
+  {
+    trace u;
+    auto const length = std::uniform_int_distribution<uint32_t>( 1u, 100u )( engine );
+    for ( auto i = 0u; i < length; ++i )
+    {
+      std::vector<int> props;
+      for ( auto p = 1; p <= 2; ++p )
+        if ( std::bernoulli_distribution( 0.7 )( engine ) )
+          props.emplace_back( p );
+      u.emplace_prefix( props );
+    }
+
+    for ( const auto& f : formulas )
+    {
+      auto const values = lasso_eval.evaluate_all( f, u );
+      REQUIRE( values.size() == u.length() );
+      CHECK( values.front() == lasso_eval.evaluate_formula( f, u, 0u ) );
+      for ( auto pos = 0u; pos < u.length(); ++pos )
+      {
+        auto const v = eval.evaluate_formula( f, u, pos );
+        CHECK( !v.is_inconclusive() );
+        CHECK( ( v.is_true() || v.is_presumably_true() ) == values[pos] );
+        CHECK( eval.evaluate_formula( !f, u, pos ) == !v );
+      }
+    }
+  }
+}
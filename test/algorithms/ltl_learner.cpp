@@ -1,7 +1,9 @@
 #include <catch.hpp>
 #include <copycat/chain/print.hpp>
+#include <copycat/algorithms/exact_ltl_pdag_encoder.hpp>
 #include <copycat/algorithms/ltl_learner.hpp>
 #include <copycat/algorithms/ltl_pdag_learner.hpp>
+#include <copycat/io/ltl_synthesis_spec_reader.hpp>
 #include <percy/partial_dag.hpp>
 #include <bill/sat/solver.hpp>
 
@@ -304,3 +306,73 @@ TEST_CASE( "Learn XX Or", "[ltl_learner]" )
   write_chain( c, chain_as_string );
   CHECK( chain_as_string.str() == "1 := x1\n2 := x0\n3 := X( 1 )\n4 := X( 3 )\n5 := |( 4,2 )\n" );
 }
+
+TEST_CASE( "Read operator weights from parameters", "[ltl_learner]" )
+{
+  ltl_synthesis_spec spec;
+  spec.operators = { operator_opcode::next_, operator_opcode::eventually_, operator_opcode::and_ };
+  CHECK( read_operator_weights( spec ).empty() );
+
+  spec.parameters = { "X:5", " F = 2 ", "unknown", "G:x", "&:0" };
+  auto const weights = read_operator_weights( spec );
+  CHECK( weights.size() == 3u );
+  CHECK( weights.at( operator_opcode::next_ ) == 5u );
+  CHECK( weights.at( operator_opcode::eventually_ ) == 2u );
+  CHECK( weights.at( operator_opcode::and_ ) == 1u );
+}
+
+TEST_CASE( "Minimize cost of LTL chain with incremental bounds", "[ltl_learner]" )
+{
+  using solver_t = bill::solver<bill::solvers::glucose_41>;
+  solver_t solver;
+
+  /* {} ( {1} )^omega is good, ( {} )^omega is bad: X x0 and F x0 separate */
+  trace good;
+  good.emplace_prefix( {} );
+  good.emplace_suffix( { 1 } );
+
+  trace bad;
+  bad.emplace_suffix( {} );
+
+  ltl_synthesis_spec spec;
+  spec.operators = { operator_opcode::next_, operator_opcode::eventually_ };
+  spec.parameters = { "X:5", "F:2" };
+
+  exact_ltl_pdag_encoder_parameter ps;
+  ps.verbose = false;
+  ps.num_propositions = 1u;
+  ps.ops = spec.operators;
+  ps.weights = read_operator_weights( spec );
+  ps.traces.emplace_back( good, true );
+  ps.traces.emplace_back( bad, false );
+
+  auto num_solutions = 0u;
+  for ( const auto& pd : pd_generate_filtered( 1u, 1u ) )
+  {
+    if ( pd.get_vertices().size() != 1u )
+      continue;
+
+    solver.restart();
+    ps.pd = pd;
+
+    exact_ltl_pdag_encoder<solver_t> enc( solver );
+    enc.encode( ps );
+    CHECK( enc.cost_at_least( 5u ) );
+    CHECK( !enc.cost_at_least( 6u ) );
+
+    /* tighten the bound on the same solver */
+    uint32_t cost = 0u;
+    while ( solver.solve() == bill::result::states::satisfiable )
+    {
+      cost = enc.extract_cost();
+      std::stringstream chain_as_string;
+      write_chain( enc.extract_chain(), chain_as_string );
+      CHECK( ( cost == 2u ? "1 := x0\n2 := F( 1 )\n" : "1 := x0\n2 := X( 1 )\n" ) == chain_as_string.str() );
+
+      enc.add_cost_bound( cost - 1u );
+      ++num_solutions;
+    }
+    CHECK( cost == 2u );
+  }
+  CHECK( num_solutions > 0u );
+}
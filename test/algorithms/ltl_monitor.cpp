@@ -0,0 +1,155 @@
+#include <catch.hpp>
+#include <copycat/algorithms/ltl_monitor.hpp>
+#include <copycat/algorithms/sequential_simulation.hpp>
+#include <mockturtle/networks/aig.hpp>
+
+using namespace copycat;
+
+namespace
+{
+
+mockturtle::aig_network make_toggle()
+{
+  using namespace mockturtle;
+  aig_network aig;
+
+  /* register toggles if enabled */
+  auto const en = aig.create_pi();
+  auto const l_out = aig.create_ro();
+  aig.create_po( l_out );
+  aig.create_ri( aig.create_xor( l_out, en ) );
+  return aig;
+}
+
+} /* namespace */
+
+TEST_CASE( "Progress LTL formulas letter by letter", "[ltl_monitor]" )
+{
+  ltl_formula_store ltl;
+  auto const a = ltl.create_variable();
+  auto const b = ltl.create_variable();
+
+  std::vector<ltl_formula_store::ltl_formula> const fs = {
+    ltl.create_eventually( b ),
+    ltl.create_globally( a ),
+    ltl.create_until( a, b ),
+    ltl.create_releases( b, a ),
+    ltl.create_next( !a ),
+  };
+
+  ltl_progression_monitor monitor( ltl, fs );
+  CHECK( monitor.verdict( 0u ) == inconclusive3 );
+
+  /* letters are indexed by proposition id */
+  CHECK( monitor.step( { false, true, false } ) );
+  CHECK( monitor.verdict( 0u ) == inconclusive3 );
+  CHECK( monitor.verdict( 1u ) == inconclusive3 );
+  CHECK( monitor.verdict( 2u ) == inconclusive3 );
+  CHECK( monitor.verdict( 3u ) == inconclusive3 );
+  CHECK( monitor.verdict( 4u ) == inconclusive3 );
+
+  CHECK( !monitor.step( { false, false, true } ) );
+  CHECK( monitor.verdict( 0u ) == bool3( true ) );
+  CHECK( monitor.verdict( 1u ) == bool3( false ) );
+  CHECK( monitor.verdict( 2u ) == bool3( true ) );
+  CHECK( monitor.verdict( 3u ) == bool3( false ) );
+  CHECK( monitor.verdict( 4u ) == bool3( true ) );
+  CHECK( monitor.all_decided() );
+}
+
+TEST_CASE( "Map variables to propositions by their position", "[ltl_monitor]" )
+{
+  /* b is created after a non-variable node, i.e., node index 3 denotes proposition 2 */
+  ltl_formula_store ltl;
+  auto const a = ltl.create_variable();
+  auto const xa = ltl.create_next( a );
+  auto const b = ltl.create_variable();
+  CHECK( ltl.get_node( b ) == 3u );
+
+  std::vector<ltl_formula_store::ltl_formula> const fs = { b, xa, ltl.create_and( a, b ) };
+  ltl_progression_monitor monitor( ltl, fs );
+
+  CHECK( monitor.step( { false, true, true } ) );
+  CHECK( monitor.verdict( 0u ) == bool3( true ) );
+  CHECK( monitor.verdict( 1u ) == inconclusive3 );
+  CHECK( monitor.verdict( 2u ) == bool3( true ) );
+
+  CHECK( !monitor.step( { false, false, true } ) );
+  CHECK( monitor.verdict( 1u ) == bool3( false ) );
+}
+
+TEST_CASE( "Monitor LTL formulas during simulation", "[ltl_monitor]" )
+{
+  auto const aig = make_toggle();
+
+  /* 1 = en, 2 = next state, 3 = current state, 4 = output */
+  ltl_formula_store ltl;
+  std::vector<ltl_formula_store::ltl_formula> xs;
+  for ( auto i = 0u; i < 4u; ++i )
+  {
+    xs.emplace_back( ltl.create_variable() );
+  }
+
+  std::vector<std::vector<bool>> const stimuli = { {true}, {false}, {true}, {true} };
+
+  SECTION( "simulate all time frames while a formula is inconclusive" )
+  {
+    std::vector<ltl_formula_store::ltl_formula> const fs = {
+      ltl.create_eventually( xs[3u] ),
+      ltl.create_globally( ltl.create_or( xs[0u], xs[2u] ) ),
+      !xs[3u],
+    };
+
+    stimuli_simulator sim( aig, stimuli );
+    ltl_simulation_monitor monitor( aig, ltl, fs );
+    simulate( aig, sim, stimuli.size(), monitor );
+
+    CHECK( monitor.get_monitor().num_letters() == 4u );
+    CHECK( monitor.get_monitor().verdict( 0u ) == bool3( true ) );
+    CHECK( monitor.get_monitor().verdict( 1u ) == inconclusive3 );
+    CHECK( monitor.get_monitor().verdict( 2u ) == bool3( true ) );
+  }
+
+  SECTION( "stop simulation when all verdicts are definite" )
+  {
+    std::vector<ltl_formula_store::ltl_formula> const fs = {
+      ltl.create_eventually( xs[3u] ),
+      ltl.create_until( xs[1u], xs[2u] ),
+      ltl.create_next( xs[0u] ),
+    };
+
+    stimuli_simulator sim( aig, stimuli );
+    ltl_simulation_monitor monitor( aig, ltl, fs );
+    simulate( aig, sim, stimuli.size(), monitor );
+
+    CHECK( monitor.get_monitor().num_letters() == 2u );
+    CHECK( monitor.get_monitor().verdict( 0u ) == bool3( true ) );
+    CHECK( monitor.get_monitor().verdict( 1u ) == bool3( true ) );
+    CHECK( monitor.get_monitor().verdict( 2u ) == bool3( false ) );
+  }
+
+  SECTION( "map signals to variables created after other nodes" )
+  {
+    /* the output is the 4th variable, but not the 4th node of the store */
+    ltl_formula_store ltl2;
+    auto const en = ltl2.create_variable();
+    auto const x_en = ltl2.create_next( en );
+    ltl2.create_variable();
+    ltl2.create_variable();
+    auto const out = ltl2.create_variable();
+    CHECK( ltl2.get_node( out ) != 4u );
+
+    std::vector<ltl_formula_store::ltl_formula> const fs = {
+      ltl2.create_eventually( out ),
+      x_en,
+    };
+
+    stimuli_simulator sim( aig, stimuli );
+    ltl_simulation_monitor monitor( aig, ltl2, fs );
+    simulate( aig, sim, stimuli.size(), monitor );
+
+    CHECK( monitor.get_monitor().num_letters() == 2u );
+    CHECK( monitor.get_monitor().verdict( 0u ) == bool3( true ) );
+    CHECK( monitor.get_monitor().verdict( 1u ) == bool3( false ) );
+  }
+}
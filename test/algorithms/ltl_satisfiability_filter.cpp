@@ -0,0 +1,133 @@
+#include <catch.hpp>
+#include <copycat/algorithms/ltl_evaluator.hpp>
+#include <copycat/algorithms/ltl_satisfiability_filter.hpp>
+#include <random>
+
+using namespace copycat;
+
+TEST_CASE( "Decide satisfiability with obligations", "[ltl_satisfiability_filter]" )
+{
+  ltl_formula_store ltl;
+  auto const a = ltl.create_variable();
+  auto const b = ltl.create_variable();
+
+  ltl_satisfiability_filter filter( ltl );
+
+  /* satisfiable */
+  CHECK( filter.is_satisfiable( ltl.create_until( a, b ) ) == bool3( true ) );
+  CHECK( filter.is_satisfiable( ltl.create_and( ltl.create_globally( a ), ltl.create_eventually( b ) ) ) == bool3( true ) );
+  CHECK( filter.is_satisfiable( ltl.get_constant( true ) ) == bool3( true ) );
+
+  /* unsatisfiable */
+  CHECK( filter.is_satisfiable( ltl.get_constant( false ) ) == bool3( false ) );
+  CHECK( filter.is_satisfiable( ltl.create_and( a, !a ) ) == bool3( false ) );
+  CHECK( filter.is_satisfiable( ltl.create_and( ltl.create_next( a ), ltl.create_next( !a ) ) ) == bool3( false ) );
+  CHECK( filter.is_satisfiable( ltl.create_and( ltl.create_globally( a ), !a ) ) == bool3( false ) );
+  CHECK( filter.is_satisfiable( ltl.create_and( a, ltl.create_releases( b, !a ) ) ) == bool3( false ) );
+
+  /* satisfiable, but not by a constant trace */
+  CHECK( filter.is_satisfiable( ltl.create_and( a, ltl.create_next( !a ) ) ).is_inconclusive() );
+
+  /* unsatisfiable, but not at fixed positions */
+  CHECK( filter.is_satisfiable( ltl.create_and( ltl.create_globally( a ), ltl.create_eventually( ltl.create_and( !a, b ) ) ) ).is_inconclusive() );
+
+  /* validity */
+  CHECK( filter.is_valid( ltl.create_or( a, !a ) ) == bool3( true ) );
+  CHECK( filter.is_valid( ltl.create_or( ltl.create_eventually( a ), !a ) ) == bool3( true ) );
+  CHECK( filter.is_valid( ltl.create_or( ltl.create_eventually( a ), b ) ) == bool3( false ) );
+  CHECK( filter.is_trivial( ltl.create_or( ltl.create_next( b ), !ltl.create_next( b ) ) ) );
+  CHECK( !filter.is_trivial( ltl.create_until( a, b ) ) );
+
+  auto const queries = filter.statistics().num_queries;
+  CHECK( filter.is_satisfiable( ltl.create_and( a, !a ) ) == bool3( false ) );
+  CHECK( filter.statistics().num_queries == queries + 1u );
+  CHECK( filter.statistics().num_cache_hits > 0u );
+  CHECK( filter.statistics().hit_rate() > 0.5 );
+}
+
+TEST_CASE( "Satisfiability verdicts agree with traces", "[ltl_satisfiability_filter]" )
+{
+  ltl_formula_store ltl;
+  std::vector<ltl_formula_store::ltl_formula> formulas = { ltl.create_variable(), ltl.create_variable() };
+
+  /* random formulas over two variables */
+  std::default_random_engine engine( 11 );
+  for ( auto i = 0u; i < 300u; ++i )
+  {
+    auto pick = [&](){
+      auto const f = formulas[std::uniform_int_distribution<std::size_t>( 0u, formulas.size() - 1u )( engine )];
+      return std::bernoulli_distribution( 0.5 )( engine ) ? !f : f;
+    };
+    auto const x = pick();
+    auto const y = pick();
+    switch ( std::uniform_int_distribution<uint32_t>( 0u, 5u )( engine ) )
+    {
+    case 0u: formulas.emplace_back( ltl.create_and( x, y ) ); break;
+    case 1u: formulas.emplace_back( ltl.create_or( x, y ) ); break;
+    case 2u: formulas.emplace_back( ltl.create_next( x ) ); break;
+    case 3u: formulas.emplace_back( ltl.create_eventually( x ) ); break;
+    case 4u: formulas.emplace_back( ltl.create_until( x, y ) ); break;
+    case 5u: formulas.emplace_back( ltl.create_releases( x, y ) ); break;
+    }
+  }
+
+  /* random lasso traces */
+  std::vector<trace> traces;
+  for ( auto k = 0u; k < 50u; ++k )
+  {
+    trace t;
+    auto const prefix_length = std::uniform_int_distribution<uint32_t>( 0u, 3u )( engine );
+    auto const suffix_length = std::uniform_int_distribution<uint32_t>( 1u, 3u )( engine );
+    for ( auto i = 0u; i < prefix_length + suffix_length; ++i )
+    {
+      std::vector<int> props;
+      for ( auto p = 1; p <= 2; ++p )
+        if ( std::bernoulli_distribution( 0.5 )( engine ) )
+          props.emplace_back( p );
+
+      if ( i < prefix_length )
+        t.emplace_prefix( props );
+      else
+        t.emplace_suffix( props );
+    }
+    traces.emplace_back( t );
+  }
+
+  ltl_satisfiability_filter filter( ltl );
+  ltl_lasso_evaluator eval( ltl );
+  for ( const auto& f : formulas )
+  {
+    auto const sat = filter.is_satisfiable( f );
+    auto const valid = filter.is_valid( f );
+    for ( const auto& t : traces )
+    {
+      if ( sat.is_false() )
+        CHECK( !eval.evaluate_formula( f, t, 0u ) );
+      if ( valid.is_true() )
+        CHECK( eval.evaluate_formula( f, t, 0u ) );
+    }
+  }
+  CHECK( filter.statistics().num_satisfiable > 0u );
+}
+
+TEST_CASE( "Satisfiability verdicts refer to infinite traces", "[ltl_satisfiability_filter]" )
+{
+  ltl_formula_store ltl;
+  auto const a = ltl.create_variable();
+
+  /* {1} */
+  trace t;
+  t.emplace_prefix( { 1 } );
+
+  ltl_satisfiability_filter filter( ltl );
+  ltl_lasso_evaluator eval( ltl );
+
+  /* valid on infinite traces, but false at the last position of a finite trace */
+  auto const f = ltl.create_or( ltl.create_next( a ), ltl.create_next( !a ) );
+  CHECK( filter.is_valid( f ) == bool3( true ) );
+  CHECK( !eval.evaluate_formula( f, t, 0u ) );
+
+  /* unsatisfiable on infinite traces, but true at the last position of a finite trace */
+  CHECK( filter.is_satisfiable( !f ) == bool3( false ) );
+  CHECK( eval.evaluate_formula( !f, t, 0u ) );
+}
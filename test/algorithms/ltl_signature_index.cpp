@@ -0,0 +1,64 @@
+#include <catch.hpp>
+#include <copycat/algorithms/ltl_signature_index.hpp>
+
+using namespace copycat;
+
+TEST_CASE( "Index LTL formulas by trace signature", "[ltl_signature_index]" )
+{
+  ltl_synthesis_spec spec;
+
+  /* ( {1} {} {2} )^omega */
+  trace t0;
+  t0.emplace_suffix( { 1 } );
+  t0.emplace_suffix( {} );
+  t0.emplace_suffix( { 2 } );
+  spec.good_traces.emplace_back( t0 );
+
+  /* {2} {1,2} ( {1} )^omega */
+  trace t1;
+  t1.emplace_prefix( { 2 } );
+  t1.emplace_prefix( { 1, 2 } );
+  t1.emplace_suffix( { 1 } );
+  spec.bad_traces.emplace_back( t1 );
+
+  ltl_formula_store ltl;
+  auto const a = ltl.create_variable();
+  auto const b = ltl.create_variable();
+
+  ltl_signature_index index( ltl, spec );
+  auto const& layout = index.layout();
+
+  /* F a */
+  auto const fa = ltl.create_eventually( a );
+  auto const [sig_fa, rep_fa] = index.lookup( fa, 2u );
+  CHECK( sig_fa == layout.compute( operator_opcode::eventually_, layout.proposition( 1 ) ) );
+  CHECK( rep_fa == fa );
+
+  /* F F a is equivalent to F a */
+  auto const [sig_ffa, rep_ffa] = index.lookup( ltl.create_eventually( fa ), 3u );
+  CHECK( sig_ffa == sig_fa );
+  CHECK( rep_ffa == fa );
+
+  CHECK( index.find( sig_fa )->size == 2u );
+
+  /* a R b = !( !a U !b ) */
+  auto const r = ltl.create_releases( a, b );
+  auto const u = !ltl.create_until( !a, !b );
+  CHECK( index.signature( r ) == index.signature( u ) );
+  CHECK( index.signature( !r ) == layout.compute( operator_opcode::not_, index.signature( r ) ) );
+
+  /* a smaller representative replaces a larger one */
+  auto const x = ltl.create_and( a, ltl.create_next( a ) );
+  auto const sig_x = index.signature( x );
+  CHECK( index.insert( sig_x, x, 10u ) );
+  CHECK( !index.insert( sig_x, ltl.create_or( x, x ), 10u ) );
+  CHECK( index.insert( sig_x, x, 3u ) );
+  CHECK( index.find( sig_x )->size == 3u );
+
+  CHECK( index.size() == 2u );
+  CHECK( !index.find( layout.constant( false ) ) );
+
+  index.clear();
+  CHECK( index.size() == 0u );
+  CHECK( index.signature( fa ) == sig_fa );
+}
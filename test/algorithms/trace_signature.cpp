@@ -0,0 +1,73 @@
+#include <catch.hpp>
+#include <copycat/algorithms/ltl_chain_evaluator.hpp>
+#include <copycat/algorithms/trace_signature.hpp>
+#include <random>
+
+using namespace copycat;
+
+TEST_CASE( "Compare trace signatures with chain evaluator", "[trace_signature]" )
+{
+  std::default_random_engine engine( 11 );
+
+  /* traces of different lengths such that signatures span several words */
+  ltl_synthesis_spec spec;
+  for ( auto k = 0u; k < 12u; ++k )
+  {
+    trace t;
+    auto const prefix_length = std::uniform_int_distribution<uint32_t>( 0u, 6u )( engine );
+    auto const suffix_length = std::uniform_int_distribution<uint32_t>( prefix_length == 0u ? 1u : 0u, 6u )( engine );
+    for ( auto i = 0u; i < prefix_length + suffix_length; ++i )
+    {
+      std::vector<int> props;
+      for ( auto p = 1; p <= 2; ++p )
+        if ( std::bernoulli_distribution( 0.5 )( engine ) )
+          props.emplace_back( p );
+
+      if ( i < prefix_length )
+        t.emplace_prefix( props );
+      else
+        t.emplace_suffix( props );
+    }
+    ( k % 2u == 0u ? spec.good_traces : spec.bad_traces ).emplace_back( t );
+  }
+
+  trace_signature_layout const layout( spec );
+  CHECK( layout.num_propositions() == 2u );
+
+  std::vector<std::pair<operator_opcode, std::string>> const ops = {
+    { operator_opcode::not_, "~" }, { operator_opcode::and_, "&" }, { operator_opcode::or_, "|" },
+    { operator_opcode::implies_, "->" }, { operator_opcode::next_, "X" }, { operator_opcode::eventually_, "F" },
+    { operator_opcode::globally_, "G" }, { operator_opcode::until_, "U" } };
+
+  for ( const auto& op : ops )
+  {
+    /* op( x0, x1 ) */
+    chain<std::string, std::vector<int>> c;
+    auto const x0 = c.add_step( "x0", {} );
+    auto const x1 = c.add_step( "x1", {} );
+    if ( operator_opcode_arity( op.first ) == 1u )
+      c.add_step( op.second, { x0 } );
+    else
+      c.add_step( op.second, { x0, x1 } );
+
+    auto const sig = layout.compute( op.first, layout.proposition( 1 ), layout.proposition( 2 ) );
+
+    ltl_chain_evaluator const eval( c );
+    auto k = 0u;
+    for ( const auto& traces : { spec.good_traces, spec.bad_traces } )
+    {
+      for ( const auto& t : traces )
+      {
+        auto const& s = layout.segments()[k++];
+        eval.evaluate( t );
+        auto const tv = eval.truth_vector( c.length() );
+        for ( auto i = 0u; i < t.length(); ++i )
+          CHECK( sig.get( s.offset + i ) == tv[i] );
+      }
+    }
+  }
+
+  /* true holds on all traces */
+  CHECK( !layout.separates( layout.constant( true ) ) );
+  CHECK( layout.constant( true ) == layout.compute( operator_opcode::not_, layout.constant( false ) ) );
+}
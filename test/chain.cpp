@@ -1,6 +1,7 @@
 #include <catch.hpp>
 #include <copycat/chain/chain.hpp>
 #include <copycat/chain/print.hpp>
+#include <copycat/algorithms/exact_ltl_traits.hpp>
 #include <kitty/dynamic_truth_table.hpp>
 #include <kitty/constructors.hpp>
 #include <kitty/print.hpp>
@@ -228,3 +229,70 @@ TEST_CASE( "LTL chain", "[chain]" )
          "x1 -- x2;\n"
          "}\n" );
 }
+
+TEST_CASE( "Reuse chain storage", "[chain]" )
+{
+  chain<std::string, std::vector<int>> c( 2u );
+  c.reserve( 4u, 8u );
+
+  auto const s0 = c.add_step( "G", { 2 } );
+  c.add_step( "U", { 1, s0 } );
+  CHECK( c.num_steps() == 2u );
+  CHECK( c.okay() );
+
+  auto const fanins = c.fanins_at( 4 );
+  REQUIRE( fanins.size() == 2u );
+  CHECK( fanins[0u] == 1 );
+  CHECK( fanins[1u] == 3 );
+  CHECK( c.step_at( 4 ) == std::vector<int>{ 1, 3 } );
+
+  /* clear keeps the inputs and drops all steps */
+  c.clear();
+  CHECK( c.num_inputs() == 2u );
+  CHECK( c.num_steps() == 0u );
+
+  std::array<int, 2u> children{ { 1, 2 } };
+  auto const t0 = c.add_step( "&", children.begin(), children.end() );
+  auto const t1 = c.add_step( "X", children.begin() + 1, children.end() );
+  c.add_step( "|", { t0, -t1 } );
+  CHECK( c.okay() );
+
+  c.set_step( t0, "~", { 1 } );
+  CHECK( c.okay() );
+
+  std::stringstream os;
+  write_chain( c, os );
+  CHECK( os.str() ==
+         "3 := ~( 1 )\n"
+         "4 := X( 2 )\n"
+         "5 := |( 3,-4 )\n" );
+}
+
+namespace copycat::detail
+{
+  template<>
+  std::string label_to_string( operator_opcode const& label )
+  {
+    return operator_opcode_to_string( label );
+  }
+}
+
+TEST_CASE( "LTL chain with opcode labels", "[chain]" )
+{
+  chain<operator_opcode, std::array<int, 2u>> c( 2u );
+  auto const s0 = c.add_step( operator_opcode::globally_, { 2 } );
+  c.add_step( operator_opcode::until_, { 1, s0 } );
+  CHECK( c.okay() );
+
+  uint32_t num_fanins = 0u;
+  c.foreach_step( [&]( chain<operator_opcode, std::array<int, 2u>>::step_view const& step ){
+      num_fanins += step.size();
+    });
+  CHECK( num_fanins == 3u );
+
+  std::stringstream os;
+  write_chain( c, os );
+  CHECK( os.str() ==
+         "3 := G( 2 )\n"
+         "4 := U( 1,3 )\n" );
+}
@@ -70,3 +70,57 @@ TEST_CASE( "ternary_dag", "[dag]" )
   to_dot( d, std::cout );
 }
 
+
+TEST_CASE( "binary_dag grows beyond the small buffer", "[dag]" )
+{
+  binary_dag d( 2 );
+  CHECK( d.capacity() == binary_dag::small_size );
+
+  auto const num_vertices = 4 * binary_dag::small_size + 3;
+  for ( int i = 0; i < num_vertices; ++i )
+    CHECK( d.add_vertex( i, i + 1 ) == i );
+
+  CHECK( d.num_vertices() == num_vertices );
+  CHECK( d.capacity() >= num_vertices );
+  for ( int i = 0; i < num_vertices; ++i )
+    CHECK( d.vertex_at( i ) == std::make_pair( i, i + 1 ) );
+}
+
+TEST_CASE( "binary_dag copy and move", "[dag]" )
+{
+  for ( auto const num_vertices : { 3, 2 * binary_dag::small_size } )
+  {
+    binary_dag d( 3 );
+    for ( int i = 0; i < num_vertices; ++i )
+      d.add_vertex( { i % 3, i + 2 } );
+
+    binary_dag copy( d );
+    CHECK( copy == d );
+
+    copy.set_vertex( 0, 1, 2 );
+    CHECK( copy != d );
+
+    copy = d;
+    CHECK( copy == d );
+
+    binary_dag moved( std::move( copy ) );
+    CHECK( moved == d );
+
+    binary_dag assigned( 1 );
+    assigned.add_vertex( 0, 0 );
+    assigned = std::move( moved );
+    CHECK( assigned == d );
+    CHECK( assigned.num_vertices() == num_vertices );
+  }
+}
+
+TEST_CASE( "ternary_dag add_vertex", "[dag]" )
+{
+  ternary_dag d( 3 );
+  CHECK( d.add_vertex( std::vector{ 0, 1, 2 } ) == 0 );
+  CHECK( d.add_vertex( std::vector{ 3, 1, 2 } ) == 1 );
+  CHECK( d.vertex_at( 1 ) == ternary_dag::vertex{ { 3, 1, 2 } } );
+
+  ternary_dag copy( d );
+  CHECK( copy == d );
+}
@@ -0,0 +1,136 @@
+#include <catch.hpp>
+#include <copycat/generators/trace_generator.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <random>
+
+using namespace copycat;
+
+namespace
+{
+
+mockturtle::aig_network make_toggle()
+{
+  using namespace mockturtle;
+  aig_network aig;
+
+  /* register toggles if enabled */
+  auto const en = aig.create_pi();
+  auto const l_out = aig.create_ro();
+  aig.create_po( l_out );
+  aig.create_ri( aig.create_xor( l_out, en ) );
+  return aig;
+}
+
+} /* namespace */
+
+TEST_CASE( "Record finite trace from simulation", "[trace_generator]" )
+{
+  auto const aig = make_toggle();
+
+  std::vector<std::vector<bool>> const stimuli = { {true}, {false}, {true}, {true} };
+  stimuli_simulator sim( aig, stimuli );
+
+  trace tr;
+  trace_generator gen( aig, tr );
+  simulate( aig, sim, stimuli.size(), gen );
+
+  /* 1 = en, 2 = next state, 3 = current state, 4 = output */
+  CHECK( gen.num_signals() == 4u );
+  CHECK( tr.is_finite() );
+  CHECK( tr.length() == 4u );
+  CHECK( tr.at( 0u ) == std::vector<int>{ 1, 2 } );
+  CHECK( tr.at( 1u ) == std::vector<int>{ 2, 3, 4 } );
+  CHECK( tr.at( 2u ) == std::vector<int>{ 1, 3, 4 } );
+  CHECK( tr.at( 3u ) == std::vector<int>{ 1, 2 } );
+}
+
+TEST_CASE( "Generate LTL synthesis spec from simulation", "[trace_generator]" )
+{
+  auto const aig = make_toggle();
+
+  ltl_synthesis_spec spec;
+  ltl_synthesis_spec_generator gen( aig, spec );
+
+  std::vector<std::vector<bool>> const stimuli = { {false}, {true}, {false}, {false} };
+  CHECK( gen.add_good_stimuli( stimuli, /* lasso start */2u ) );
+
+  std::default_random_engine engine( 0 );
+  CHECK( gen.add_bad_stimuli( mutate_stimuli( stimuli, engine, 2u ) ) );
+
+  CHECK( spec.num_propositions == 4u );
+  CHECK( spec.operators.size() == 8u );
+  REQUIRE( spec.good_traces.size() == 1u );
+  REQUIRE( spec.bad_traces.size() == 1u );
+
+  auto const& good = spec.good_traces[0u];
+  CHECK( good.prefix_length() == 2u );
+  CHECK( good.suffix_length() == 2u );
+  CHECK( good.at( 1u ) == std::vector<int>{ 1, 2 } );
+  CHECK( good.at( 2u ) == std::vector<int>{ 2, 3, 4 } );
+
+  CHECK( spec.bad_traces[0u].is_finite() );
+  CHECK( spec.bad_traces[0u].length() == 4u );
+}
+
+TEST_CASE( "Reject lassos that are not runs of the network", "[trace_generator]" )
+{
+  auto const aig = make_toggle();
+
+  ltl_synthesis_spec spec;
+  ltl_synthesis_spec_generator gen( aig, spec );
+
+  /* the register toggles in the last time frame, i.e., the state after the loop differs */
+  CHECK( !gen.add_good_stimuli( { {false}, {false}, {true} }, /* lasso start */1u ) );
+  CHECK( spec.good_traces.empty() );
+
+  /* the register toggles twice in the loop */
+  CHECK( gen.add_good_stimuli( { {false}, {true}, {true} }, /* lasso start */1u ) );
+  CHECK( spec.good_traces.size() == 1u );
+
+  /* finite traces are always runs */
+  CHECK( gen.add_good_stimuli( { {false}, {false}, {true} } ) );
+  CHECK( spec.good_traces.size() == 2u );
+}
+
+TEST_CASE( "Reject bad traces that are identical to good traces", "[trace_generator]" )
+{
+  auto const aig = make_toggle();
+
+  ltl_synthesis_spec spec;
+  ltl_synthesis_spec_generator gen( aig, spec );
+
+  std::vector<std::vector<bool>> const stimuli = { {true}, {false}, {true} };
+  CHECK( gen.add_good_stimuli( stimuli ) );
+  CHECK( !gen.add_bad_stimuli( stimuli ) );
+  CHECK( spec.bad_traces.empty() );
+
+  /* good traces that are identical to bad traces are rejected as well */
+  CHECK( gen.add_bad_stimuli( { {true}, {false}, {true}, {true} }, /* lasso start */2u ) );
+  CHECK( !gen.add_good_stimuli( { {true}, {false}, {true}, {true} }, /* lasso start */2u ) );
+  CHECK( spec.bad_traces.size() == 1u );
+  CHECK( spec.good_traces.size() == 1u );
+}
+
+TEST_CASE( "Mutated stimuli differ from the original", "[trace_generator]" )
+{
+  std::vector<std::vector<bool>> const stimuli = { {false, true}, {true, true}, {false, false} };
+
+  std::default_random_engine engine( 0 );
+  for ( auto num_flips = 1u; num_flips <= 8u; ++num_flips )
+  {
+    for ( auto k = 0u; k < 100u; ++k )
+    {
+      auto const mutated = mutate_stimuli( stimuli, engine, num_flips );
+      REQUIRE( mutated.size() == stimuli.size() );
+
+      /* exactly min( num_flips, 6 ) values are negated */
+      auto num_differences = 0u;
+      for ( auto i = 0u; i < stimuli.size(); ++i )
+        for ( auto j = 0u; j < stimuli[i].size(); ++j )
+          num_differences += mutated[i][j] != stimuli[i][j] ? 1u : 0u;
+      CHECK( num_differences == std::min( num_flips, 6u ) );
+    }
+  }
+
+  CHECK( mutate_stimuli( stimuli, engine, 0u ) == stimuli );
+}
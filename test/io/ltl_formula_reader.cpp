@@ -0,0 +1,124 @@
+#include <catch.hpp>
+#include <copycat/io/ltl_formula_reader.hpp>
+#include <fmt/format.h>
+#include <sstream>
+
+using namespace copycat;
+
+namespace
+{
+
+std::vector<ltl_formula_store::ltl_formula> formulas_of( ltl_formula_store const& ltl )
+{
+  std::vector<ltl_formula_store::ltl_formula> fs;
+  ltl.foreach_formula( [&]( const auto& f ){
+      fs.emplace_back( f );
+      return true;
+    });
+  return fs;
+}
+
+} /* namespace */
+
+TEST_CASE( "Read LTL formulas into store in a single pass", "[ltl_formula_reader]" )
+{
+  std::string const formulas =
+    "a\n"
+    "!a U b\n"
+    "( a ) U b\n"
+    "X(a -> b) * F G c\n"
+    "a + b + c\n"
+    "G( req -> F ack ) /* comment */\n"
+    "! ( a R b ) -> X X c\n";
+
+  /* reference: AST-based reader */
+  ltl_formula_store expected;
+  std::map<std::string, ltl_formula_store::ltl_formula> expected_names;
+  std::istringstream iss( formulas );
+  CHECK( read_ltl( iss, ltl_formula_reader( expected, expected_names ) ) == return_code::success );
+
+  ltl_formula_store ltl;
+  std::map<std::string, ltl_formula_store::ltl_formula> names;
+  CHECK( read_ltl_formulas( std::string_view( formulas ), ltl, names ) == return_code::success );
+
+  CHECK( ltl.num_formulas() == 7u );
+  CHECK( ltl.num_variables() == expected.num_variables() );
+  CHECK( ltl.num_nodes() == expected.num_nodes() );
+  CHECK( formulas_of( ltl ) == formulas_of( expected ) );
+  CHECK( names == expected_names );
+}
+
+TEST_CASE( "Grammar of single-pass LTL reader", "[ltl_formula_reader]" )
+{
+  ltl_formula_store ltl;
+  std::map<std::string, ltl_formula_store::ltl_formula> names;
+  names.emplace( "a", ltl.create_variable() );
+  names.emplace( "b", ltl.create_variable() );
+  auto const a = names["a"], b = names["b"];
+
+  CHECK( read_ltl_formulas( std::string_view( "~a & b\n\n   \n/* only a comment */\n\ta|b\r\n" ), ltl, names ) == return_code::success );
+  CHECK( names.size() == 2u );
+
+  auto const fs = formulas_of( ltl );
+  REQUIRE( fs.size() == 2u );
+
+  /* unary operators apply to the remainder of the formula */
+  CHECK( fs[0u] == !!ltl.create_or( !a, !b ) );
+  CHECK( fs[1u] == ltl.create_or( a, b ) );
+
+  CHECK( read_ltl_formulas( std::string_view( "a U" ), ltl, names ) == return_code::parse_error );
+  CHECK( read_ltl_formulas( std::string_view( "( a" ), ltl, names ) == return_code::parse_error );
+  CHECK( read_ltl_formulas( std::string_view( "a )" ), ltl, names ) == return_code::parse_error );
+  CHECK( read_ltl_formulas( std::string_view( "a b" ), ltl, names ) == return_code::parse_error );
+  CHECK( read_ltl_formulas( std::string_view( "a - b" ), ltl, names ) == return_code::parse_error );
+}
+
+TEST_CASE( "Read deeply nested LTL formula", "[ltl_formula_reader]" )
+{
+  std::string formula;
+  for ( auto i = 0u; i < 100000u; ++i )
+  {
+    formula += "X(a U ";
+  }
+  formula += "b";
+  formula += std::string( 100000u, ')' );
+
+  ltl_formula_store ltl;
+  std::map<std::string, ltl_formula_store::ltl_formula> names;
+  CHECK( read_ltl_formulas( std::string_view( formula ), ltl, names ) == return_code::success );
+  CHECK( ltl.num_formulas() == 1u );
+  CHECK( ltl.num_nodes() == 1u + 2u + 2u * 100000u );
+}
+
+TEST_CASE( "Read LTL formulas with multiple threads", "[ltl_formula_reader]" )
+{
+  std::string formulas;
+  for ( auto i = 0u; i < 500u; ++i )
+  {
+    formulas += fmt::format( "G( p{} -> F( q{} U X p{} ) ) + ( p{} R q{} )\n", i % 13u, i % 7u, i % 5u, i % 3u, i % 11u );
+  }
+
+  ltl_formula_store expected;
+  std::map<std::string, ltl_formula_store::ltl_formula> expected_names;
+  expected_names.emplace( "q0", expected.create_variable() );
+  REQUIRE( read_ltl_formulas( std::string_view( formulas ), expected, expected_names ) == return_code::success );
+
+  for ( auto const num_threads : { 1u, 3u, 8u } )
+  {
+    ltl_formula_store ltl;
+    std::map<std::string, ltl_formula_store::ltl_formula> names;
+    names.emplace( "q0", ltl.create_variable() );
+    REQUIRE( read_ltl_formulas_parallel( std::string_view( formulas ), ltl, names, num_threads ) == return_code::success );
+
+    CHECK( ltl.num_nodes() == expected.num_nodes() );
+    CHECK( formulas_of( ltl ) == formulas_of( expected ) );
+    CHECK( names == expected_names );
+  }
+
+  /* formulas before a parse error are kept */
+  formulas += "a U\nb\n";
+  ltl_formula_store ltl;
+  std::map<std::string, ltl_formula_store::ltl_formula> names;
+  CHECK( read_ltl_formulas_parallel( std::string_view( formulas ), ltl, names, 4u ) == return_code::parse_error );
+  CHECK( ltl.num_formulas() == 500u );
+}
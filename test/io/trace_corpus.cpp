@@ -0,0 +1,159 @@
+#include <catch.hpp>
+#include <copycat/io/trace_corpus.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace copycat;
+
+TEST_CASE( "Write and read binary trace corpus", "[trace_corpus]" )
+{
+  ltl_synthesis_spec spec;
+  spec.num_propositions = 3u;
+
+  trace t0;
+  t0.emplace_prefix( { 1, 3 } );
+  t0.emplace_suffix( { 2 } );
+  t0.emplace_suffix( {} );
+  spec.good_traces.emplace_back( t0 );
+
+  /* long finite trace spanning multiple words */
+  trace t1;
+  for ( auto k = 0; k < 100; ++k )
+  {
+    t1.emplace_prefix( k % 3 == 0 ? std::vector<int>{ 2 } : std::vector<int>{} );
+  }
+  spec.bad_traces.emplace_back( t1 );
+
+  std::string const filename = "copycat_test_corpus.bin";
+  REQUIRE( write_trace_corpus( filename, spec ) );
+
+  {
+    trace_corpus corpus( filename );
+    REQUIRE( corpus.good() );
+    CHECK( corpus.num_propositions() == 3u );
+    CHECK( corpus.num_good_traces() == 1u );
+    CHECK( corpus.num_bad_traces() == 1u );
+    CHECK( corpus.is_good( 0u ) );
+    CHECK( !corpus.is_good( 1u ) );
+
+    /* lazy access */
+    CHECK( corpus.length( 0u ) == 3u );
+    CHECK( corpus.prefix_length( 0u ) == 1u );
+    CHECK( corpus.has( 0u, 0u, 1u ) );
+    CHECK( !corpus.has( 0u, 0u, 2u ) );
+    CHECK( corpus.has( 0u, 1u, 2u ) );
+    CHECK( corpus.length( 1u ) == 100u );
+    CHECK( corpus.prefix_length( 1u ) == 100u );
+    CHECK( corpus.has( 1u, 99u, 2u ) );
+    CHECK( !corpus.has( 1u, 98u, 2u ) );
+
+    auto const r0 = corpus.get_good_trace( 0u );
+    CHECK( r0.prefix_length() == 1u );
+    CHECK( r0.suffix_length() == 2u );
+    CHECK( r0._data == t0._data );
+
+    auto const r1 = corpus.get_bad_trace( 0u );
+    CHECK( r1.is_finite() );
+    CHECK( r1._data == t1._data );
+
+    ltl_synthesis_spec loaded;
+    corpus.load( loaded );
+    CHECK( loaded.num_propositions == 3u );
+    CHECK( loaded.good_traces.size() == 1u );
+    CHECK( loaded.bad_traces.size() == 1u );
+  }
+  std::remove( filename.c_str() );
+}
+
+TEST_CASE( "Convert text traces into binary trace corpus", "[trace_corpus]" )
+{
+  std::string const trace_filename = "copycat_test_corpus.trace";
+  std::string const corpus_filename = "copycat_test_corpus.bin";
+  {
+    std::ofstream ofs( trace_filename );
+    ofs << "1,0;0,1::1\n0,0;1,1\n---\n0,1\n";
+  }
+
+  REQUIRE( convert_traces_to_corpus( trace_filename, corpus_filename ) );
+
+  ltl_synthesis_spec expected;
+  REQUIRE( read_ltl_synthesis_spec( trace_filename, expected ) );
+
+  {
+    trace_corpus corpus( corpus_filename );
+    REQUIRE( corpus.good() );
+    CHECK( corpus.num_propositions() == expected.num_propositions );
+    REQUIRE( corpus.num_good_traces() == 2u );
+    REQUIRE( corpus.num_bad_traces() == 1u );
+    for ( auto i = 0u; i < 2u; ++i )
+    {
+      CHECK( corpus.get_good_trace( i )._data == expected.good_traces[i]._data );
+      CHECK( corpus.get_good_trace( i ).prefix_length() == expected.good_traces[i].prefix_length() );
+    }
+    CHECK( corpus.get_bad_trace( 0u )._data == expected.bad_traces[0u]._data );
+  }
+
+  /* text files are rejected */
+  trace_corpus not_a_corpus( trace_filename );
+  CHECK( !not_a_corpus.good() );
+
+  std::remove( trace_filename.c_str() );
+  std::remove( corpus_filename.c_str() );
+}
+
+TEST_CASE( "Reject malformed binary trace corpora", "[trace_corpus]" )
+{
+  ltl_synthesis_spec spec;
+  spec.num_propositions = 2u;
+
+  trace t;
+  t.emplace_prefix( { 1 } );
+  t.emplace_suffix( { 2 } );
+  spec.good_traces.emplace_back( t );
+  spec.bad_traces.emplace_back( t );
+
+  std::string const filename = "copycat_test_corpus.bin";
+
+  /* propositions out of range */
+  {
+    auto invalid = spec;
+    invalid.bad_traces[0u].emplace_suffix( { 3 } );
+    std::ostringstream os;
+    CHECK( !write_trace_corpus( os, invalid ) );
+    CHECK( os.str().empty() );
+  }
+
+  /* corrupts the index entry of the first trace */
+  auto const corrupt = [&]( auto&& modify ){
+    std::ostringstream os;
+    REQUIRE( write_trace_corpus( os, spec ) );
+    auto data = os.str();
+
+    trace_corpus_entry e;
+    std::memcpy( &e, data.data() + sizeof( trace_corpus_header ), sizeof( e ) );
+    modify( e );
+    std::memcpy( &data[sizeof( trace_corpus_header )], &e, sizeof( e ) );
+
+    std::ofstream ofs( filename, std::ios::out | std::ios::binary );
+    ofs << data;
+  };
+
+  corrupt( []( trace_corpus_entry& ){} );
+  CHECK( trace_corpus( filename ).good() );
+
+  corrupt( []( trace_corpus_entry& e ){ e.offset = uint64_t( 1 ) << 40u; } );
+  CHECK( !trace_corpus( filename ).good() );
+
+  corrupt( []( trace_corpus_entry& e ){ e.offset = 0u; } );
+  CHECK( !trace_corpus( filename ).good() );
+
+  corrupt( []( trace_corpus_entry& e ){ e.length = 1000u; } );
+  CHECK( !trace_corpus( filename ).good() );
+
+  corrupt( []( trace_corpus_entry& e ){ e.prefix_length = 3u; } );
+  CHECK( !trace_corpus( filename ).good() );
+
+  std::remove( filename.c_str() );
+}
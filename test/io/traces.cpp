@@ -0,0 +1,142 @@
+#include <catch.hpp>
+#include <copycat/io/ltl_synthesis_spec_reader.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace copycat;
+
+namespace
+{
+
+std::string const spec_string =
+  "1,0;0,1::1\n"
+  "0,0,1;1\n"
+  "\n"
+  "---\n"
+  "1;1;0,1::0\n"
+  "---\n"
+  " X , U,G\n"
+  "---\n"
+  "  size:3 \n"
+  "---\n"
+  "\tX(x0)\n";
+
+void check_spec( ltl_synthesis_spec const& spec )
+{
+  CHECK( spec.num_propositions == 3u );
+
+  REQUIRE( spec.good_traces.size() == 3u );
+  CHECK( spec.good_traces[0u].prefix_length() == 1u );
+  CHECK( spec.good_traces[0u].suffix_length() == 1u );
+  CHECK( spec.good_traces[0u].at( 0u ) == std::vector<int>{ 1 } );
+  CHECK( spec.good_traces[0u].at( 1u ) == std::vector<int>{ 2 } );
+
+  CHECK( spec.good_traces[1u].prefix_length() == 0u );
+  CHECK( spec.good_traces[1u].suffix_length() == 2u );
+  CHECK( spec.good_traces[1u].at( 0u ) == std::vector<int>{ 3 } );
+  CHECK( spec.good_traces[1u].at( 1u ) == std::vector<int>{ 1 } );
+
+  /* an empty line is a trace with a single empty time step */
+  CHECK( spec.good_traces[2u].length() == 1u );
+  CHECK( spec.good_traces[2u].at( 0u ).empty() );
+
+  REQUIRE( spec.bad_traces.size() == 1u );
+  CHECK( spec.bad_traces[0u].prefix_length() == 0u );
+  CHECK( spec.bad_traces[0u].suffix_length() == 3u );
+  CHECK( spec.bad_traces[0u].at( 2u ) == std::vector<int>{ 2 } );
+
+  CHECK( spec.operators == std::vector<operator_opcode>{ operator_opcode::next_, operator_opcode::until_, operator_opcode::globally_ } );
+  CHECK( spec.parameters == std::vector<std::string>{ "size:3" } );
+  CHECK( spec.formulas == std::vector<std::string>{ "X(x0)" } );
+}
+
+} /* namespace */
+
+TEST_CASE( "Read LTL synthesis spec from stream", "[traces]" )
+{
+  std::istringstream iss( spec_string );
+
+  ltl_synthesis_spec spec;
+  CHECK( read_ltl_synthesis_spec( iss, spec ) );
+  check_spec( spec );
+}
+
+TEST_CASE( "Read LTL synthesis spec from file", "[traces]" )
+{
+  std::string const filename = "copycat_test_traces.trace";
+  {
+    std::ofstream ofs( filename );
+    ofs << spec_string;
+  }
+
+  ltl_synthesis_spec spec;
+  CHECK( read_ltl_synthesis_spec( filename, spec ) );
+  check_spec( spec );
+  std::remove( filename.c_str() );
+
+  ltl_synthesis_spec missing;
+  CHECK( !read_ltl_synthesis_spec( filename, missing ) );
+}
+
+TEST_CASE( "Tokenize trace lines in place", "[traces]" )
+{
+  uint32_t num_propositions = 0u;
+  detail::trace_line_parser parser;
+
+  parser.parse( "0,1,1;1,0,0;0,0,0::2", num_propositions );
+  CHECK( num_propositions == 3u );
+  CHECK( parser.prefix() == std::vector<std::vector<int>>{ { 2, 3 }, { 1 } } );
+  CHECK( parser.suffix() == std::vector<std::vector<int>>{ {} } );
+
+  /* fields that are not exactly `1` are false */
+  parser.parse( "1 ,11, 1,1", num_propositions );
+  CHECK( num_propositions == 4u );
+  CHECK( parser.prefix().empty() );
+  CHECK( parser.suffix() == std::vector<std::vector<int>>{ { 4 } } );
+}
+
+TEST_CASE( "Read LTL synthesis spec with multiple threads", "[traces]" )
+{
+  std::string const filename = "copycat_test_traces_parallel.trace";
+  {
+    std::ofstream ofs( filename );
+    for ( auto i = 0u; i < 200u; ++i )
+    {
+      for ( auto j = 0u; j <= i % 7u; ++j )
+      {
+        ofs << ( j > 0u ? ";" : "" ) << ( ( i + j ) % 2u ) << ',' << ( ( i * j ) % 3u == 1u ) << ',' << ( i % 11u == j );
+      }
+      ofs << "::" << ( i % 3u ) % ( i % 7u + 1u ) << '\n';
+      if ( i == 120u )
+        ofs << "---\n";
+    }
+    ofs << "---\n&,|\n---\nsize:3\n";
+  }
+
+  ltl_synthesis_spec expected;
+  REQUIRE( read_ltl_synthesis_spec( filename, expected ) );
+
+  for ( auto const num_threads : { 1u, 3u, 8u } )
+  {
+    ltl_synthesis_spec spec;
+    REQUIRE( read_ltl_synthesis_spec_parallel( filename, spec, num_threads ) );
+
+    CHECK( spec.num_propositions == expected.num_propositions );
+    CHECK( spec.operators == expected.operators );
+    CHECK( spec.parameters == expected.parameters );
+    REQUIRE( spec.good_traces.size() == expected.good_traces.size() );
+    REQUIRE( spec.bad_traces.size() == expected.bad_traces.size() );
+    for ( auto i = 0u; i < spec.good_traces.size(); ++i )
+    {
+      CHECK( spec.good_traces[i]._prefix_length == expected.good_traces[i]._prefix_length );
+      CHECK( spec.good_traces[i]._data == expected.good_traces[i]._data );
+    }
+    for ( auto i = 0u; i < spec.bad_traces.size(); ++i )
+    {
+      CHECK( spec.bad_traces[i]._prefix_length == expected.bad_traces[i]._prefix_length );
+      CHECK( spec.bad_traces[i]._data == expected.bad_traces[i]._data );
+    }
+  }
+  std::remove( filename.c_str() );
+}
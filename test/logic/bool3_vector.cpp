@@ -0,0 +1,67 @@
+#include <catch.hpp>
+#include <copycat/logic/bool3_vector.hpp>
+#include <random>
+#include <vector>
+
+using namespace copycat;
+
+TEST_CASE( "bool3_vector agrees with bool3", "[bool3_vector]" )
+{
+  std::vector<bool3> const values{ false, inconclusive3, true };
+
+  /* all pairs of values, repeated to cover full words and a tail */
+  std::size_t const n = 9u * 31u;
+  bool3_vector a( n ), b( n );
+  for ( auto i = 0u; i < n; ++i )
+  {
+    a.set( i, values[( i / 3u ) % 3u] );
+    b.set( i, values[i % 3u] );
+  }
+
+  auto const neg = !a;
+  auto const conj = a & b;
+  auto const disj = a | b;
+  auto const sc_conj = a && b;
+  auto const sc_disj = a || b;
+  for ( auto i = 0u; i < n; ++i )
+  {
+    CHECK( a[i] == values[( i / 3u ) % 3u] );
+    CHECK( neg[i] == !a[i] );
+    CHECK( conj[i] == ( a[i] & b[i] ) );
+    CHECK( disj[i] == ( a[i] | b[i] ) );
+    CHECK( sc_conj[i] == ( a[i] && b[i] ) );
+    CHECK( sc_disj[i] == ( a[i] || b[i] ) );
+  }
+
+  CHECK( bool3_vector( 3u, inconclusive3 ).to_string() == "???" );
+  CHECK( ( !!a ) == a );
+}
+
+TEST_CASE( "bool3_vector until agrees with the scalar recurrence", "[bool3_vector]" )
+{
+  std::vector<bool3> const values{ false, inconclusive3, true };
+  std::mt19937 rng( 0u );
+
+  for ( auto const n : { 1u, 63u, 64u, 65u, 128u, 200u } )
+  {
+    for ( auto const& last : values )
+    {
+      /* mostly true left-hand sides, such that chains cross word boundaries */
+      bool3_vector a( n ), b( n );
+      for ( auto i = 0u; i < n; ++i )
+      {
+        a.set( i, rng() % 8u == 0u ? values[rng() % 2u] : bool3( true ) );
+        b.set( i, rng() % 16u == 0u ? values[rng() % 3u] : bool3( false ) );
+      }
+
+      auto const v = bool3_vector::until( a, b, last );
+      bool3 next = last;
+      for ( auto i = n; i-- > 0u; )
+      {
+        next = b[i] | ( a[i] & next );
+        CHECK( v[i] == next );
+      }
+      CHECK( v.shift_down( last )[n - 1u] == last );
+    }
+  }
+}
@@ -0,0 +1,66 @@
+#include <catch.hpp>
+#include <copycat/logic/bool5_vector.hpp>
+#include <random>
+#include <vector>
+
+using namespace copycat;
+
+TEST_CASE( "bool5_vector agrees with bool5", "[bool5_vector]" )
+{
+  std::vector<bool5> const values{ false, presumably_false, inconclusive5, presumably_true, true };
+
+  std::size_t const n = 25u * 13u;
+  bool5_vector a( n ), b( n );
+  for ( auto i = 0u; i < n; ++i )
+  {
+    a.set( i, values[( i / 5u ) % 5u] );
+    b.set( i, values[i % 5u] );
+  }
+
+  auto const neg = !a;
+  auto const conj = a & b;
+  auto const disj = a | b;
+  auto const sc_conj = a && b;
+  auto const sc_disj = a || b;
+  for ( auto i = 0u; i < n; ++i )
+  {
+    CHECK( a[i] == values[( i / 5u ) % 5u] );
+    CHECK( neg[i] == !a[i] );
+    CHECK( conj[i] == ( a[i] & b[i] ) );
+    CHECK( disj[i] == ( a[i] | b[i] ) );
+    CHECK( sc_conj[i] == ( a[i] && b[i] ) );
+    CHECK( sc_disj[i] == ( a[i] || b[i] ) );
+  }
+
+  CHECK( bool5_vector( 5u, presumably_true ).to_string() == "hhhhh" );
+  CHECK( ( bool5_vector( 70u, true ) & bool5_vector( 70u, presumably_false ) ) == bool5_vector( 70u, presumably_false ) );
+  CHECK( ( !!a ) == a );
+}
+
+TEST_CASE( "bool5_vector until agrees with the scalar recurrence", "[bool5_vector]" )
+{
+  std::vector<bool5> const values{ false, presumably_false, inconclusive5, presumably_true, true };
+  std::mt19937 rng( 0u );
+
+  for ( auto const n : { 1u, 63u, 64u, 65u, 128u, 200u } )
+  {
+    for ( auto const& last : values )
+    {
+      /* mostly true left-hand sides, such that chains cross word boundaries */
+      bool5_vector a( n ), b( n );
+      for ( auto i = 0u; i < n; ++i )
+      {
+        a.set( i, rng() % 8u == 0u ? values[rng() % 4u] : bool5( true ) );
+        b.set( i, rng() % 16u == 0u ? values[rng() % 5u] : bool5( false ) );
+      }
+
+      auto const v = bool5_vector::until( a, b, last );
+      bool5 next = last;
+      for ( auto i = n; i-- > 0u; )
+      {
+        next = b[i] | ( a[i] & next );
+        CHECK( v[i] == next );
+      }
+    }
+  }
+}
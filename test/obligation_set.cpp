@@ -123,3 +123,34 @@ TEST_CASE( "Compute obligation set 2", "[obligation_set]" )
     CHECK( compute_obligations( ltl, i ) == olg_i );
   }
 }
+
+TEST_CASE( "Compute obligations of shared conjunctions of disjunctions", "[obligation_set]" )
+{
+  ltl_formula_store ltl;
+  std::vector<ltl_formula_store::ltl_formula> vars;
+  for ( auto i = 0u; i < 8u; ++i )
+    vars.emplace_back( ltl.create_variable() );
+
+  /* ( x0 | x1 ) & ( x2 | x3 ) & ... has 2^4 obligations */
+  auto f = ltl.get_constant( true );
+  for ( auto i = 0u; i < 8u; i += 2u )
+    f = ltl.create_and( f, ltl.create_or( vars[i], vars[i + 1u] ) );
+
+  obligation_cache cache;
+  auto const& olg_f = compute_obligations( ltl, f, cache );
+  CHECK( olg_f.size() == 16u );
+
+  /* the obligations of the shared subformula are reused */
+  auto const num_cached = cache.size();
+  auto const g = ltl.create_or( f, ltl.create_next( f ) );
+  CHECK( compute_obligations( ltl, g, cache ) == olg_f );
+  CHECK( cache.size() == num_cached + 2u );
+  CHECK( compute_obligations( ltl, g ) == olg_f );
+
+  /* insertion keeps the set sorted and free of duplicates */
+  obligation_set olg( { vars[3u], vars[1u], vars[3u] } );
+  olg.add_formula( vars[2u] );
+  olg.add_formula( vars[1u] );
+  CHECK( olg.size() == 3u );
+  CHECK( olg == obligation_set( { vars[1u], vars[2u], vars[3u] } ) );
+}
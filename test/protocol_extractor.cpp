@@ -0,0 +1,152 @@
+#include <catch.hpp>
+#include <copycat/algorithms/sequential_simulation.hpp>
+#include <copycat/protocol_extractor.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace copycat;
+
+TEST_CASE( "Build and compact protocol graph", "[protocol_extractor]" )
+{
+  protocol_graph g;
+  auto const root = g.get_root();
+  CHECK( root == 0u );
+
+  auto const a = g.add_node( "00", "1" );
+  auto const b = g.add_node( "01", "1" );
+  CHECK( g.add_node( std::string( "00" ), std::string( "1" ) ) == a );
+  CHECK( g.get_root() == root );
+  CHECK( g.size() == 3u );
+  CHECK( g.input( b ) == "01" );
+  CHECK( g.output( b ) == "1" );
+
+  /* symbols are shared between nodes */
+  CHECK( g.node( a ).output == g.node( b ).output );
+  CHECK( g.symbol_pool().size() == 4u );
+
+  g.add_edge( root, a );
+  g.add_edge( a, b );
+  g.add_edge( b, a );
+  g.add_edge( a, b );
+  CHECK( !g.is_compact() );
+
+  g.compact();
+  CHECK( g.is_compact() );
+  CHECK( g.num_edges() == 3u );
+
+  std::vector<protocol_graph::index_t> children, parents;
+  g.foreach_child( a, [&]( auto n ){ children.emplace_back( n ); } );
+  g.foreach_parent( a, [&]( auto n ){ parents.emplace_back( n ); } );
+  CHECK( children == std::vector<protocol_graph::index_t>{ b } );
+  CHECK( parents == std::vector<protocol_graph::index_t>{ root, b } );
+
+  /* edges added after compaction are merged by the next compaction */
+  auto const c = g.add_node( "11", "0" );
+  g.add_edge( b, c );
+  g.compact();
+  CHECK( g.num_edges() == 4u );
+  children.clear();
+  g.foreach_child( b, [&]( auto n ){ children.emplace_back( n ); } );
+  CHECK( children == std::vector<protocol_graph::index_t>{ a, c } );
+
+  /* quotes and backslashes in symbols are escaped in DOT labels */
+  g.add_edge( c, g.add_node( "\"x\"", "a\\b" ) );
+  std::stringstream dot;
+  g.write_dot( dot );
+  CHECK( dot.str().find( "[label=\"\\\"x\\\"/a\\\\b\"]" ) != std::string::npos );
+}
+
+TEST_CASE( "Protocol graph with many nodes", "[protocol_extractor]" )
+{
+  protocol_graph g;
+  auto prev = g.get_root();
+  for ( auto i = 0u; i < 20000u; ++i )
+  {
+    auto const curr = g.add_node( std::to_string( i % 5000u ), std::to_string( i % 7u ) );
+    g.add_edge( prev, curr );
+    prev = curr;
+  }
+  g.compact();
+
+  /* ( i mod 5000, i mod 7 ) takes 20000 distinct values */
+  CHECK( g.size() == 20001u );
+  CHECK( g.num_edges() == 20000u );
+}
+
+TEST_CASE( "Merge equivalent protocol states", "[protocol_extractor]" )
+{
+  protocol_graph g;
+  protocol_extractor ex( g );
+
+  /* a and c are followed by the same behavior */
+  ex.add_observation( "a", "0" );
+  ex.add_observation( "b", "1" );
+  ex.reset();
+  ex.add_observation( "c", "0" );
+  ex.add_observation( "b", "1" );
+  ex.reset();
+  ex.add_observation( "a", "0" );
+  CHECK( ex.observations() == 5u );
+  CHECK( g.size() == 4u );
+
+  auto const p = refine_partition( g );
+  CHECK( p.num_blocks == 3u );
+  CHECK( p.block_of[1u] == p.block_of[3u] );
+  CHECK( p.block_of[1u] != p.block_of[2u] );
+
+  std::stringstream dot;
+  write_dot( g, p, dot );
+  CHECK( dot.str() == "digraph protocol {\n"
+                      "  s0 [label=\"root\"];\n"
+                      "  s1 [label=\"0\"];\n"
+                      "  s2 [label=\"1\"];\n"
+                      "  s0 -> s1 [label=\"a\"];\n"
+                      "  s0 -> s1 [label=\"c\"];\n"
+                      "  s1 -> s2 [label=\"b\"];\n"
+                      "}\n" );
+
+  auto const json = protocol_to_json( g, p );
+  CHECK( json["initial"] == 0u );
+  CHECK( json["states"].size() == 3u );
+  CHECK( json["transitions"].size() == 3u );
+  CHECK( json["transitions"][2u]["input"] == "b" );
+}
+
+TEST_CASE( "Extract protocol from simulation", "[protocol_extractor]" )
+{
+  using namespace mockturtle;
+
+  /* register toggles if enabled; output is the register */
+  aig_network aig;
+  auto const en = aig.create_pi();
+  auto const l_out = aig.create_ro();
+  aig.create_po( l_out );
+  aig.create_ri( aig.create_xor( l_out, en ) );
+
+  std::default_random_engine engine( 1 );
+  auto coin = [&](){ return std::bernoulli_distribution( 0.5 )( engine ); };
+  random_simulator<aig_network, decltype( coin )> sim( aig, coin );
+
+  protocol_graph g;
+  protocol_extractor ex( g );
+  simulate( aig, sim, 10000u, ex );
+
+  /* four observations plus the root, edges do not grow with the run */
+  CHECK( ex.observations() == 10000u );
+  CHECK( g.size() == 5u );
+  g.compact();
+  CHECK( g.num_edges() <= 1u + 4u * 2u );
+
+  /* the next output is determined by the current input and output */
+  g.foreach_edge( [&]( auto source, auto target ){
+      if ( source == 0u )
+        return;
+      bool const next = ( g.input( source ) == "1" ) != ( g.output( source ) == "1" );
+      CHECK( ( g.output( target ) == "1" ) == next );
+    } );
+
+  auto const p = refine_partition( g );
+  CHECK( p.num_blocks == 5u );
+}
@@ -0,0 +1,60 @@
+#include <catch.hpp>
+#include <copycat/utils/json_lines_log.hpp>
+#include <cstdio>
+#include <fstream>
+
+using namespace copycat;
+
+TEST_CASE( "Write and resume JSON Lines log", "[json_lines_log]" )
+{
+  std::string const filename = "test_json_lines_log.jsonl";
+
+  {
+    json_lines_log log( filename );
+    REQUIRE( log.good() );
+    log.append( { { "benchmark", "a.trace" }, { "time", 1.5 } } );
+    log.append( { { "benchmark", "b.trace" }, { "time", 2.5 }, { "status", "timeout" } } );
+    CHECK( log.contains( "a.trace" ) );
+    CHECK( log.num_records() == 2u );
+  }
+
+  /* simulate a crash in the middle of a record */
+  {
+    std::ofstream os( filename, std::ios::app );
+    os << "{\"benchmark\":\"c.tr";
+  }
+
+  {
+    json_lines_log_parameters ps;
+    ps.resume = true;
+    json_lines_log log( filename, ps );
+    CHECK( log.num_records() == 2u );
+    CHECK( log.contains( "a.trace" ) );
+    CHECK( log.contains( "b.trace" ) );
+    CHECK( !log.contains( "c.trace" ) );
+    CHECK( log.status( "a.trace" ) == std::string() );
+    CHECK( log.status( "b.trace" ) == std::string( "timeout" ) );
+    CHECK( !log.status( "c.trace" ) );
+    log.append( { { "benchmark", "c.trace" } } );
+
+    /* the last record of a key determines its status */
+    log.append( { { "benchmark", "b.trace" }, { "status", "success" } } );
+    CHECK( log.status( "b.trace" ) == std::string( "success" ) );
+  }
+
+  std::vector<std::string> benchmarks;
+  CHECK( read_json_lines( filename, [&]( nlohmann::json const& record ){
+        benchmarks.emplace_back( record["benchmark"].get<std::string>() );
+        return true;
+      } ) );
+  CHECK( benchmarks == std::vector<std::string>{ "a.trace", "b.trace", "c.trace", "b.trace" } );
+
+  /* without resume, the log is overwritten */
+  {
+    json_lines_log log( filename );
+    CHECK( !log.contains( "a.trace" ) );
+  }
+  CHECK( read_json_lines( filename, []( nlohmann::json const& ){ return false; } ) );
+
+  std::remove( filename.c_str() );
+}
@@ -0,0 +1,99 @@
+#include <catch.hpp>
+#include <copycat/utils/profiler.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace copycat;
+
+TEST_CASE( "Nested scopes and counters", "[profiler]" )
+{
+  profiler prof;
+  auto const num_clauses = prof.counter( "#clauses" );
+  CHECK( prof.counter( "#variables" ) != num_clauses );
+  CHECK( prof.counter( "#clauses" ) == num_clauses );
+  for ( auto i = 0u; i < 3u; ++i )
+  {
+    scoped_timer t( &prof, "encode" );
+    {
+      scoped_timer t2( &prof, "variables" );
+      prof.count( "#variables", 10 );
+      t2.next( "clauses" );
+      prof.count( num_clauses, 2 );
+      prof.count( "#clauses" );
+    }
+  }
+  {
+    scoped_timer t( &prof, "solve" );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+  }
+
+  auto const json = prof.to_json();
+  CHECK( json["threads"] == 1u );
+  CHECK( json["time"].get<double>() >= 0.002 );
+
+  auto const& encode = json["children"]["encode"];
+  CHECK( encode["calls"] == 3u );
+  CHECK( encode["children"]["variables"]["calls"] == 3u );
+  CHECK( encode["children"]["variables"]["counters"]["#variables"] == 30 );
+  CHECK( encode["children"]["clauses"]["counters"]["#clauses"] == 9 );
+  CHECK( encode["children"]["clauses"]["counters"].count( "#variables" ) == 0u );
+  CHECK( json["children"]["solve"]["time"].get<double>() >= 0.002 );
+  CHECK( json["children"]["solve"].count( "children" ) == 0u );
+
+  std::stringstream ss;
+  prof.write_folded( ss, "spec" );
+  CHECK( ss.str().find( "spec;solve " ) != std::string::npos );
+
+  prof.clear();
+  CHECK( prof.num_threads() == 0u );
+  CHECK( prof.counter( "#clauses" ) == num_clauses );
+  CHECK( prof.to_json().count( "children" ) == 0u );
+}
+
+TEST_CASE( "Merge scopes of threads", "[profiler]" )
+{
+  profiler prof;
+  std::vector<std::thread> threads;
+  for ( auto i = 0u; i < 4u; ++i )
+  {
+    threads.emplace_back( [&](){
+        for ( auto j = 0u; j < 100u; ++j )
+        {
+          scoped_timer t( &prof, "work" );
+          prof.count( "#items" );
+        }
+      } );
+  }
+  for ( auto& t : threads )
+    t.join();
+
+  auto const json = prof.to_json();
+  CHECK( json["threads"] == 4u );
+  CHECK( json["children"]["work"]["calls"] == 400u );
+  CHECK( json["children"]["work"]["counters"]["#items"] == 400 );
+}
+
+TEST_CASE( "Escape frames of folded stacks", "[profiler]" )
+{
+  profiler prof;
+  {
+    scoped_timer t( &prof, "a;b c" );
+    {
+      scoped_timer t2( &prof, "d;e\tf" );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+  }
+
+  std::stringstream ss;
+  prof.write_folded( ss, "dir/my file;1.trace" );
+  CHECK( ss.str().find( "dir/my_file_1.trace;a_b_c;d_e_f " ) != std::string::npos );
+  CHECK( ss.str().find( '\t' ) == std::string::npos );
+}
+
+TEST_CASE( "Disabled profiler", "[profiler]" )
+{
+  scoped_timer t( nullptr, "encode" );
+  t.next( "solve" );
+}
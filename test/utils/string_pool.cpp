@@ -0,0 +1,31 @@
+#include <catch.hpp>
+#include <copycat/utils/string_pool.hpp>
+#include <string>
+
+using namespace copycat;
+
+TEST_CASE( "Intern strings", "[string_pool]" )
+{
+  string_pool pool( 4u );
+  auto const a = pool.intern( "alpha" );
+  auto const b = pool.intern( "beta" );
+  auto const e = pool.intern( "" );
+  CHECK( a == 0u );
+  CHECK( b == 1u );
+  CHECK( pool.intern( std::string( "alpha" ) ) == a );
+  CHECK( pool[b] == "beta" );
+  CHECK( pool[e] == "" );
+  CHECK( pool.find( "beta" ) == b );
+  CHECK( !pool.find( "gamma" ) );
+
+  /* grows beyond the initial capacity */
+  for ( auto i = 0u; i < 1000u; ++i )
+    CHECK( pool.intern( std::to_string( i ) ) == i + 3u );
+  for ( auto i = 0u; i < 1000u; ++i )
+    CHECK( pool[i + 3u] == std::to_string( i ) );
+  CHECK( pool.size() == 1003u );
+
+  pool.clear();
+  CHECK( pool.size() == 0u );
+  CHECK( pool.intern( "beta" ) == 0u );
+}
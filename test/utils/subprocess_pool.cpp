@@ -0,0 +1,72 @@
+#include <catch.hpp>
+#include <copycat/utils/subprocess_pool.hpp>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace copycat;
+
+TEST_CASE( "Report subprocess results in job order", "[subprocess_pool]" )
+{
+  subprocess_pool_parameters ps;
+  ps.num_workers = 3u;
+  ps.progress = false;
+
+  std::vector<job_result> results;
+  subprocess_pool pool( ps );
+  pool.run( 6u,
+            []( uint32_t index ){
+              /* later jobs finish first */
+              std::this_thread::sleep_for( std::chrono::milliseconds( 20 * ( 6 - index ) ) );
+              return std::to_string( index * index );
+            },
+            [&]( job_result const& result ){ results.emplace_back( result ); } );
+
+  REQUIRE( results.size() == 6u );
+  for ( auto i = 0u; i < 6u; ++i )
+  {
+    CHECK( results[i].index == i );
+    CHECK( results[i].status == job_status::success );
+    CHECK( results[i].output == std::to_string( i * i ) );
+  }
+}
+
+TEST_CASE( "Enforce subprocess time and memory limits", "[subprocess_pool]" )
+{
+  subprocess_pool_parameters ps;
+  ps.num_workers = 2u;
+  ps.timeout = 0.5;
+  ps.memory_limit = 512u * 1024u * 1024u;
+  ps.progress = false;
+
+  std::vector<job_result> results;
+  subprocess_pool pool( ps );
+  pool.run( 4u,
+            []( uint32_t index ) -> std::string {
+              switch ( index )
+              {
+              case 1u:
+                std::this_thread::sleep_for( std::chrono::seconds( 10 ) );
+                break;
+              case 2u:
+                {
+                  std::vector<char> v( std::size_t( 4u ) << 30u );
+                  return std::string( 1u, v.back() );
+                }
+              case 3u:
+                throw std::runtime_error( "job failed" );
+              default:
+                break;
+              }
+              return "ok";
+            },
+            [&]( job_result const& result ){ results.emplace_back( result ); } );
+
+  REQUIRE( results.size() == 4u );
+  CHECK( results[0].status == job_status::success );
+  CHECK( results[0].output == "ok" );
+  CHECK( results[1].status == job_status::timeout );
+  CHECK( results[1].time < 5.0 );
+  CHECK( results[2].status == job_status::memory_limit );
+  CHECK( results[3].status == job_status::failed );
+}